@@ -0,0 +1,10 @@
+#version 130
+
+in vec4 color;
+
+out vec4 frag_color;
+
+void main()
+{
+    frag_color = color;
+}
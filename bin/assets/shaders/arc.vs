@@ -0,0 +1,61 @@
+#version 130
+
+// Reconstructs the points of an arc given per instance, vertex k of an
+// instance is point k of the arc as generated by fill_arc moved to the center
+// of its ball. Every instance is drawn as a line strip of arc_segments + 1
+// vertices in window coordinates, where the helper nodes are seen through
+// their orthographic eye. evaluate_arc_vertex is the reference for this.
+
+const int arc_segments = 32;
+const int arc_bisects = 5;
+
+in vec2 arc_center;
+in vec3 arc_from;
+in vec3 arc_to;
+in float arc_radius;
+in vec3 arc_color;
+in float arc_opacity;
+
+out vec4 color;
+
+vec3 bisect(vec3 a, vec3 b)
+{
+    vec3 v = a + b;
+    float length2 = dot(v, v);
+    if (length2 < 1.0e-8) {
+        return vec3(0.0, 0.0, 1.0);
+    }
+    return v * (1.0 / sqrt(length2));
+}
+
+vec3 arc_point(int k)
+{
+    if (k >= arc_segments) {
+        return arc_to;
+    }
+
+    vec3 previous = arc_from;
+    vec3 current = arc_to;
+    for (int i = 0; i < arc_bisects; i++) {
+        current = bisect(previous, current);
+    }
+    if (k == 0) {
+        return previous;
+    }
+
+    // rerun the recurrence of fill_arc up to this vertex
+    float dot_two = dot(previous, current) * 2.0;
+    for (int i = 1; i < k; i++) {
+        vec3 next = current * dot_two - previous;
+        previous = current;
+        current = next;
+    }
+    return current;
+}
+
+void main()
+{
+    vec3 position = arc_point(gl_VertexID) * arc_radius;
+    gl_Position = vec4(arc_center + position.xy, 0.0, 1.0);
+    color = vec4(arc_color, arc_opacity);
+}
@@ -1,16 +1,67 @@
 #include "arcball.hpp"
 
+#include "profiler.hpp"
+
+namespace {
+
+ArcballInput translate_input(gst::Input const & input)
+{
+    const auto drag_button = gst::Button::LEFT;
+
+    ArcballInput core_input;
+    core_input.position = input.position();
+    core_input.down = input.down(drag_button);
+    core_input.clicked = input.clicked(drag_button);
+    core_input.released = input.released(drag_button);
+    core_input.increase_radius = input.pressed(gst::Key::PLUS);
+    core_input.decrease_radius = input.pressed(gst::Key::MINUS);
+    core_input.reset = input.pressed(gst::Key::R);
+    core_input.shift = input.down(gst::Key::LSHIFT);
+    core_input.ctrl = input.down(gst::Key::LCTRL);
+    return core_input;
+}
+
+ArcballCamera translate_eye(gst::CameraNode const & eye)
+{
+    ArcballCamera camera;
+    camera.orientation = eye.orientation;
+    return camera;
+}
+
+ArcballViewport translate_viewport(gst::Viewport const & viewport)
+{
+    ArcballViewport core_viewport;
+    core_viewport.x = viewport.get_x();
+    core_viewport.y = viewport.get_y();
+    core_viewport.width = viewport.get_width();
+    core_viewport.height = viewport.get_height();
+    return core_viewport;
+}
+
+}
+
+Arcball::Arcball()
+    : center(0.0f),
+      state_changed(false),
+      appended(false),
+      inertia_id(0),
+      was_dragging(false),
+      spun(false),
+      playback_id(0)
+{
+}
+
 Arcball::Arcball(std::shared_ptr<gst::Spatial> object)
     : object(object),
-      allow_constraints(false),
-      radius(0.75f),
-      dragging(false)
+      core(object->orientation),
+      center(0.0f),
+      state_changed(false),
+      appended(false),
+      inertia_id(0),
+      was_dragging(false),
+      spun(false),
+      playback_id(0)
 {
-    constraint.current = AxisSet::NONE;
-    constraint.nearest = 0;
-    orientation.reset = object->orientation;
-    orientation.start = object->orientation;
-    orientation.now = object->orientation;
 }
 
 void Arcball::update(
@@ -18,233 +69,297 @@ void Arcball::update(
     gst::CameraNode const & eye,
     gst::Viewport const & viewport)
 {
-    update_button(input);
-    update_key(input);
+    const ArcballInput core_input = translate_input(input);
+    update(&core_input, 1, translate_eye(eye), translate_viewport(viewport));
+}
 
-    drag.from = ball_coord(viewport, mouse_position_start);
-    drag.to = ball_coord(viewport, input.position());
+void Arcball::update(
+    ArcballEventQueue const & events,
+    gst::CameraNode const & eye,
+    gst::Viewport const & viewport)
+{
+    update(events.data(), events.size(), translate_eye(eye), translate_viewport(viewport));
+}
 
-    if (!dragging) {
-        update_current_axis_set(input);
-        update_constraint_axes(eye);
-        constraint.nearest = nearest_constraint(drag.to);
+// the arcball is solved through the view the input is routed to, the other
+// views follow the orientation shown afterwards, which spin and playback may
+// have moved past the core. Switching views only hands the center of the
+// new view to the input thread as a command, the thread keeps running.
+void Arcball::update(gst::Input const & input, std::vector<ArcballView> const & views)
+{
+    const ArcballInput core_input = translate_input(input);
+
+    this->views.set_views(views, core.get_radius());
+    this->views.route(core_input, core.is_dragging());
+    const unsigned int active = this->views.get_active();
+    if (active == no_view) {
+        return;
+    }
+
+    auto const & view = this->views.get_view(active);
+    set_center(view.center);
+    update(&core_input, 1, view.camera, view.viewport);
+    this->views.follow(core, object->orientation, core_input);
+}
+
+void Arcball::update(
+    ArcballInput const * inputs,
+    unsigned int count,
+    ArcballCamera const & camera,
+    ArcballViewport const & viewport)
+{
+    PROFILE_SCOPE("Arcball::update");
+
+    // a caught object is handed back to the arcball before the inputs are
+    // applied, which is also the order they are recorded in
+    if (playback) {
+        catch_playback(inputs, count);
+    }
+    if (inertia) {
+        catch_spin(inputs, count);
     }
 
-    if (dragging) {
-        update_drag_arc(eye);
-        object->orientation = orientation.now;
+    if (recorder) {
+        for (unsigned int i = 0; i < count; i++) {
+            recorder->record(inputs[i], camera, viewport, center);
+        }
     }
 
-    update_result_arc();
+    if (thread) {
+        // the input thread solves the inputs on its own time, the newest
+        // state it has published is shown without waiting for it
+        for (unsigned int i = 0; i < count; i++) {
+            thread->submit(inputs[i], camera, viewport);
+        }
+        state_changed = thread->fetch(core);
+    } else {
+        core.update(inputs, count, camera, viewport);
+        state_changed = core.changed();
+    }
+
+    if (state_changed) {
+        object->orientation = core.get_orientation().now;
+    }
+
+    if (inertia) {
+        update_spin();
+    }
+    if (playback) {
+        update_playback();
+    }
+
+    // the orientation shown is written once spin and playback have moved
+    // the object, hovering and highlighting leave it as it was
+    if (trajectory && (!appended || object->orientation != appended_orientation)) {
+        trajectory->append(object->orientation);
+        appended_orientation = object->orientation;
+        appended = true;
+    }
 }
 
+// the input thread owns its own copy of the arcball, settings are handed
+// to it in order with the inputs and made on the copy shown here right away
 void Arcball::set_allow_constraints(bool allow_constraints)
 {
-    this->allow_constraints = allow_constraints;
+    core.set_allow_constraints(allow_constraints);
+    if (thread) {
+        thread->set_allow_constraints(allow_constraints);
+    }
 }
 
-void Arcball::update_button(gst::Input const & input)
+void Arcball::set_center(glm::vec2 center)
 {
-    const auto drag_button = gst::Button::LEFT;
-
-    dragging = input.down(drag_button);
+    if (center == this->center) {
+        return;
+    }
+    this->center = center;
+    core.set_center(center);
+    if (thread) {
+        thread->set_center(center);
+    }
+}
 
-    if (input.clicked(drag_button)) {
-        // begin drag
-        mouse_position_start = input.position();
-    } else if (input.released(drag_button)) {
-        // end drag
-        orientation.start = orientation.now;
+void Arcball::set_threaded(bool threaded)
+{
+    if (threaded && !thread) {
+        thread.reset(new ArcballThread(core));
+    } else if (!threaded && thread) {
+        // continue from the state after every submitted update
+        thread->stop();
+        if (thread->fetch(core)) {
+            state_changed = true;
+            object->orientation = core.get_orientation().now;
+        }
+        thread.reset();
     }
 }
 
-void Arcball::update_key(gst::Input const & input)
+void Arcball::set_inertia(std::shared_ptr<ArcballInertia> inertia, unsigned int id)
 {
-    if (input.pressed(gst::Key::PLUS)) {
-        radius = glm::clamp(radius + 0.25f, 0.25f, 1.0f);
-    } else if (input.pressed(gst::Key::MINUS)) {
-        radius = glm::clamp(radius - 0.25f, 0.25f, 1.0f);
+    if (this->inertia) {
+        this->inertia->stop(inertia_id);
     }
+    this->inertia = inertia;
+    inertia_id = id;
+    spin_tracker.clear();
+    was_dragging = false;
+    spun = false;
+}
 
-    if (input.pressed(gst::Key::R)) {
-        orientation.start = orientation.reset;
-        orientation.now = orientation.reset;
-        object->orientation = orientation.reset;
+void Arcball::set_playback(std::shared_ptr<ArcballPlayback> playback, unsigned int id)
+{
+    if (this->playback) {
+        this->playback->stop(playback_id);
     }
+    this->playback = playback;
+    playback_id = id;
 }
 
-void Arcball::update_current_axis_set(gst::Input const & input)
+void Arcball::set_recorder(std::shared_ptr<ArcballRecorder> recorder)
 {
-    const bool shift = input.down(gst::Key::LSHIFT);
-    const bool ctrl = input.down(gst::Key::LCTRL);
+    this->recorder = recorder;
+}
 
-    if (allow_constraints && ctrl && shift) {
-        constraint.current = AxisSet::WORLD;
-    } else if (allow_constraints && ctrl) {
-        constraint.current = AxisSet::BODY;
-    } else if (allow_constraints && shift) {
-        constraint.current = AxisSet::CAMERA;
-    } else {
-        constraint.current = AxisSet::NONE;
-    }
-}
-
-void Arcball::update_constraint_axes(gst::CameraNode const & eye)
-{
-    constraint.available.clear();
-
-    // the axes that should not rotate on camera axes is multiplied by the
-    // inverse/conjugate of the camera orientation to cancel out the camera
-    // orientation when dragging
-    glm::quat inv = glm::conjugate(eye.orientation);
-
-    switch (constraint.current) {
-    case AxisSet::BODY:
-        constraint.available = {
-            inv * object->orientation * X_UNIT,
-            inv * object->orientation * Y_UNIT,
-            inv * object->orientation * Z_UNIT
-        };
-        break;
-    case AxisSet::CAMERA:
-        constraint.available = {
-            X_UNIT,
-            Y_UNIT,
-            Z_UNIT
-        };
-        break;
-    case AxisSet::WORLD:
-        constraint.available = {
-            inv * X_UNIT,
-            inv * Y_UNIT,
-            inv * Z_UNIT
-        };
-        break;
-    case AxisSet::NONE:
-        break;
-    }
-}
-
-void Arcball::update_drag_arc(gst::CameraNode const & eye)
-{
-    if (constraint.current != AxisSet::NONE) {
-        drag.from = constrain_to(drag.from, constraint.available[constraint.nearest]);
-        drag.to = constrain_to(drag.to, constraint.available[constraint.nearest]);
-    }
-
-    // from the two clicked points on the ball we construct a quaternion
-    // that represents the rotation which rotates the ball from the
-    // initial point to the end point, the quaternion vector (or rotation
-    // axis) is brought into eye space
-    float w = glm::dot(drag.from, drag.to);
-    glm::vec3 v = eye.orientation * glm::cross(drag.from, drag.to);
-    glm::quat orientation_drag(w, v);
-
-    // product of two quaternions give the combination of the rotations
-    // they represent
-    orientation.now = glm::normalize(orientation_drag * orientation.start);
-}
-
-// convert the initial orienation to two points on the ball, this is the
-// shortest arc for obtaining the current orientation from its starting
-// orientation and is called the result arc
-void Arcball::update_result_arc()
-{
-    const glm::quat q = orientation.start;
-
-    // pick an initial point that is perpendicular to the quaternion vector
-    float s = sqrt(q.x * q.x + q.y * q.y);
-    if (s == 0.0f) {
-        result.from.x = 0.0f;
-        result.from.y = 1.0f;
-        result.from.z = 0.0f;
-    } else {
-        result.from.x = -q.y / s;
-        result.from.y = q.x / s;
-        result.from.z = 0.0f;
-    }
+void Arcball::set_trajectory(std::shared_ptr<TrajectoryWriter> trajectory)
+{
+    this->trajectory = trajectory;
+    appended = false;
+}
 
-    result.to.x = q.w * result.from.x - q.z * result.from.y;
-    result.to.y = q.w * result.from.y + q.z * result.from.x;
-    result.to.z = q.x * result.from.y - q.y * result.from.x;
+bool Arcball::changed() const
+{
+    return state_changed;
+}
 
-    // negate initial ball point for a shorter arc
-    if (q.w < 0.0f) {
-        result.from.x = -result.from.x;
-        result.from.y = -result.from.y;
-        result.from.z = 0.0f;
+bool Arcball::changed(unsigned int view) const
+{
+    if (views.size() == 0 || view == views.get_active()) {
+        return state_changed;
     }
+    return views.get_core(view).changed();
 }
 
-// return coordinate on the ball from mouse position
-glm::vec3 Arcball::ball_coord(gst::Viewport const & viewport, glm::ivec2 mouse_position)
+// a click or reset catches a spinning object where it is, or where it came
+// to rest since the last update, the arcball then continues from there
+void Arcball::catch_spin(ArcballInput const * inputs, unsigned int count)
 {
-    glm::vec3 window_mouse_position = window_coord(viewport, mouse_position);
-
-    // TODO: center should be at the object position and in window coordinates
-    glm::vec3 center = glm::vec3(0.0f);
-    glm::vec3 point = (window_mouse_position - center) / radius;
+    if (!spun) {
+        return;
+    }
 
-    float r = glm::length2(point);
-    if (r > 1.0f) {
-        // set to nearest point on ball
-        point *= (1.0f / sqrt(r));
-    } else {
-        // point on ball
-        point.z = sqrt(1.0f - r);
+    bool caught = false;
+    for (unsigned int i = 0; i < count; i++) {
+        caught = caught || inputs[i].clicked || inputs[i].reset;
+    }
+    if (!caught) {
+        return;
     }
 
-    return point;
+    const auto orientation = inertia->is_spinning(inertia_id) ?
+                             inertia->get_orientation(inertia_id) :
+                             object->orientation;
+    inertia->stop(inertia_id);
+    spun = false;
+    take_over(orientation);
+}
+
+// the drag is tracked on the clock of the inertia, when released the object
+// is handed over to the inertia with the angular velocity of the drag. The
+// arcball follows the spinning object every step, so hovering shows the body
+// axes where the object is and the arcball is never behind it.
+void Arcball::update_spin()
+{
+    const float time = inertia->get_time();
+    const bool dragging = core.is_dragging();
+
+    if (dragging && !was_dragging) {
+        spin_tracker.clear();
+    }
+    if (dragging && state_changed) {
+        spin_tracker.add(time, core.get_orientation().now);
+    }
+    if (!dragging && was_dragging) {
+        spin_tracker.add(time, core.get_orientation().now);
+        inertia->spin(inertia_id, core.get_orientation().now, spin_tracker.get_velocity(time));
+        spun = inertia->is_spinning(inertia_id);
+    }
+    was_dragging = dragging;
+
+    if (inertia->is_spinning(inertia_id)) {
+        object->orientation = inertia->get_orientation(inertia_id);
+        take_over(object->orientation);
+        state_changed = true;
+    } else if (spun) {
+        // the object came to rest where it was last shown, which the arcball
+        // already holds
+        spun = false;
+    }
 }
 
-// return window coordinate from mouse position
-glm::vec3 Arcball::window_coord(gst::Viewport const & viewport, glm::ivec2 mouse_position)
+// a click or reset catches a playing object where it is, like a spinning one
+void Arcball::catch_playback(ArcballInput const * inputs, unsigned int count)
 {
-    return glm::vec3(
-        2.0f * (mouse_position.x - viewport.get_x()) / viewport.get_width() - 1.0f,
-        -(2.0f * (mouse_position.y - viewport.get_y()) / viewport.get_height() - 1.0f),
-        0.0f
-    );
+    if (!playback->is_playing(playback_id)) {
+        return;
+    }
+
+    bool caught = false;
+    for (unsigned int i = 0; i < count; i++) {
+        caught = caught || inputs[i].clicked || inputs[i].reset;
+    }
+    if (!caught) {
+        return;
+    }
+
+    const auto orientation = playback->get_orientation(playback_id);
+    playback->stop(playback_id);
+    take_over(orientation);
 }
 
-// return specified ball point constrained to specified axis by projecting the
-// ball point onto a perpendicular plane relative to the constraint axis, the
-// ball point is also flipped to the front when necessary
-glm::vec3 Arcball::constrain_to(glm::vec3 point, glm::vec3 axis)
+// a playing object follows its track rather than the arcball or the inertia,
+// the arcball takes over where a track that does not loop ends
+void Arcball::update_playback()
 {
-    glm::vec3 point_on_plane;
-    glm::vec3 proj = point - (axis * glm::dot(axis, point));
+    if (!playback->is_playing(playback_id)) {
+        return;
+    }
 
-    float length = glm::length(proj);
-    if (length > 0.0f) {
-        float s = 1.0f / length;
-        if (proj.z < 0.0f) {
-            s = -s;
-        }
-        point_on_plane = proj * s;
-    } else if (axis.z == 1.0f) {
-        point_on_plane = glm::vec3(1.0f, 0.0f, 0.0f);
-    } else {
-        point_on_plane = glm::normalize(glm::vec3(-axis.y, axis.x, 0.0f));
+    const auto orientation = playback->get_orientation(playback_id);
+    if (inertia) {
+        inertia->stop(inertia_id);
+        spun = false;
+    }
+    if (playback->has_ended(playback_id)) {
+        playback->stop(playback_id);
+        take_over(orientation);
     }
 
-    return point_on_plane;
+    object->orientation = orientation;
+    state_changed = true;
 }
 
-// return index for nearest arc relative to specified point
-int Arcball::nearest_constraint(glm::vec3 ball_point)
+// continue the arcball from specified orientation
+void Arcball::take_over(glm::quat orientation)
 {
-    float max = -std::numeric_limits<float>::infinity();
-    int nearest = 0;
+    core.set_orientation(orientation);
+    if (thread) {
+        thread->set_orientation(orientation);
+    }
 
-    for (unsigned int i = 0; i < constraint.available.size(); i++) {
-        glm::vec3 point_on_plane = constrain_to(ball_point, constraint.available[i]);
-        float dot = glm::dot(point_on_plane, ball_point);
-        if (dot > max) {
-            max = dot;
-            nearest = i;
-        }
+    if (recorder) {
+        recorder->record_orientation(orientation);
     }
+}
 
-    return nearest;
+ArcballCore const & Arcball::get_core() const
+{
+    return core;
+}
+
+ArcballCore const & Arcball::get_core(unsigned int view) const
+{
+    if (views.size() == 0 || view == views.get_active()) {
+        return core;
+    }
+    return views.get_core(view);
 }
@@ -1,41 +1,24 @@
 #ifndef ARCBALL_HPP_INCLUDED
 #define ARCBALL_HPP_INCLUDED
 
-#include "gust.hpp"
-
-class ArcballHelper;
-
-enum class AxisSet {
-    NONE,
-    CAMERA,
-    BODY,
-    WORLD
-};
-
-struct Arc {
-    glm::vec3 from;
-    glm::vec3 to;
-};
-
-struct Constraint {
-    AxisSet current;
-    std::vector<glm::vec3> available;
-    unsigned int nearest;
-};
+#include "arcballcore.hpp"
+#include "arcballevents.hpp"
+#include "arcballinertia.hpp"
+#include "arcballplayback.hpp"
+#include "arcballrecord.hpp"
+#include "arcballthread.hpp"
+#include "arcballviews.hpp"
+#include "trajectorycodec.hpp"
 
-struct Orientation {
-    glm::quat reset;
-    glm::quat start;
-    glm::quat now;
-};
+#include "gust.hpp"
 
 // The responsibility of this class is to manipulate a spatial object with a
-// virtual arcball.
+// virtual arcball. The arcball itself is computed by a headless arcball core,
+// this class only translates input, eye and viewport from gust.
 class Arcball {
-    friend ArcballHelper;
 public:
     // Construct empty arcball.
-    Arcball() = default;
+    Arcball();
     // Construct arcball with a object to be manipulated.
     Arcball(std::shared_ptr<gst::Spatial> object);
     // Update arcball from specified input, eye and viewport.
@@ -43,33 +26,95 @@ public:
         gst::Input const & input,
         gst::CameraNode const & eye,
         gst::Viewport const & viewport);
+    // Update arcball from every input queued from raw events since the queue
+    // was last cleared, with specified eye and viewport.
+    void update(
+        ArcballEventQueue const & events,
+        gst::CameraNode const & eye,
+        gst::Viewport const & viewport);
+    // Update arcball from specified input, seen through several views in
+    // window coordinates with y down like the mouse position. The input goes
+    // to the view under the cursor, or the view a drag started in until it
+    // is released, the arcball is solved through that view and the other
+    // views follow it. The center of each view replaces the one set with
+    // set_center.
+    void update(gst::Input const & input, std::vector<ArcballView> const & views);
     // Set enable/disable if object can be locked and manipulated on a
     // specific axis.
     void set_allow_constraints(bool allow_constraints);
+    // Set center of the ball in window coordinates, usually the projected
+    // position of the object.
+    void set_center(glm::vec2 center);
+    // Set enable/disable solving the arcball on a dedicated input thread.
+    // Updates then only hand the input over to the thread and pick up the
+    // newest arcball it has published without waiting, which may lag behind
+    // the input. Settings are handed over to the thread the same way.
+    void set_threaded(bool threaded);
+    // Set inertia shared by many arcballs and the id of this arcball in it,
+    // the object then keeps spinning when released until it is clicked, reset
+    // or comes to rest. The inertia must be advanced before every update.
+    // Null disables inertia.
+    void set_inertia(std::shared_ptr<ArcballInertia> inertia, unsigned int id);
+    // Set playback shared by many arcballs and the id of this arcball in it.
+    // While the arcball is playing the object follows its track, a click or
+    // reset catches it where it is and a track that does not loop hands it
+    // over where it ends, the arcball then continues from there. The playback
+    // must be advanced before every update. Null disables playback.
+    void set_playback(std::shared_ptr<ArcballPlayback> playback, unsigned int id);
+    // Set recorder which every update is written to, and every orientation
+    // inertia or playback hands the arcball, or null to stop recording.
+    void set_recorder(std::shared_ptr<ArcballRecorder> recorder);
+    // Set trajectory writer which every orientation shown is appended to
+    // when it differs from the one appended before, including those of a
+    // spin or playback, or null to stop writing.
+    void set_trajectory(std::shared_ptr<TrajectoryWriter> trajectory);
+    // Return true if the last update changed the arcball.
+    bool changed() const;
+    // Return true if the last update changed the arcball seen through view
+    // at specified index.
+    bool changed(unsigned int view) const;
+    // Return headless arcball core.
+    ArcballCore const & get_core() const;
+    // Return headless arcball core seen through view at specified index, the
+    // arcball core itself for the view input went to.
+    ArcballCore const & get_core(unsigned int view) const;
 private:
-    void update_button(gst::Input const & input);
-    void update_key(gst::Input const & input);
-    void update_current_axis_set(gst::Input const & input);
-    void update_constraint_axes(gst::CameraNode const & eye);
-    void update_drag_arc(gst::CameraNode const & eye);
-    void update_result_arc();
-
-    glm::vec3 ball_coord(gst::Viewport const & viewport, glm::ivec2 mouse_position);
-    glm::vec3 window_coord(gst::Viewport const & viewport, glm::ivec2 mouse_position);
-    glm::vec3 constrain_to(glm::vec3 point, glm::vec3 axis);
-    int nearest_constraint(glm::vec3 ball_point);
+    void update(
+        ArcballInput const * inputs,
+        unsigned int count,
+        ArcballCamera const & camera,
+        ArcballViewport const & viewport);
+    void catch_spin(ArcballInput const * inputs, unsigned int count);
+    void update_spin();
+    void catch_playback(ArcballInput const * inputs, unsigned int count);
+    void update_playback();
+    void take_over(glm::quat orientation);
 
     std::shared_ptr<gst::Spatial> object;
+    ArcballCore core;
+    // center last set, the arcball core may not have caught up with it when
+    // it is solved on the input thread
+    glm::vec2 center;
+    bool state_changed;
+    std::shared_ptr<ArcballRecorder> recorder;
+    std::shared_ptr<TrajectoryWriter> trajectory;
+    // orientation last appended to the trajectory, if any
+    glm::quat appended_orientation;
+    bool appended;
+    std::unique_ptr<ArcballThread> thread;
+
+    std::shared_ptr<ArcballInertia> inertia;
+    unsigned int inertia_id;
+    SpinTracker spin_tracker;
+    bool was_dragging;
+    // true if the object has been spinning since it was last released, the
+    // arcball core then follows the object every step
+    bool spun;
 
-    bool allow_constraints;
-    float radius;
-    bool dragging;
-    glm::ivec2 mouse_position_start;
+    std::shared_ptr<ArcballPlayback> playback;
+    unsigned int playback_id;
 
-    Arc drag;
-    Arc result;
-    Orientation orientation;
-    Constraint constraint;
+    ArcballViews views;
 };
 
 #endif
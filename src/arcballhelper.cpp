@@ -1,6 +1,23 @@
 #include "arcballhelper.hpp"
 
 #include "assets.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// the largest number of positions any helper node can hold, a half arc is two
+// arcs and a circle may end up with an extra position from rounding, every
+// storage uses the same capacity so they can be swapped without allocating
+const unsigned int capacity = std::max(2 * (arc_segments + 1), circle_segments + 1);
+
+bool operator==(Arc const & a, Arc const & b)
+{
+    return a.from == b.from && a.to == b.to;
+}
+
+}
 
 ArcballHelper ArcballHelper::create(gst::ProgramPool & programs)
 {
@@ -32,7 +49,7 @@ ArcballHelper ArcballHelper::create(gst::ProgramPool & programs)
     drag_node->get_mesh().set_draw_mode(gst::DrawMode::LINE_STRIP);
 
     ConstraintNodes constraint_nodes;
-    for (int i = 0; i < 3; i++) {
+    for (unsigned int i = 0; i < constraint_nodes.size(); i++) {
         constraint_nodes[i] = create_model_node();
         constraint_nodes[i]->get_mesh().set_draw_mode(gst::DrawMode::LINE_STRIP);
         constraint_nodes[i]->get_pass().set_blend_mode(gst::BlendMode::INTERPOLATIVE);
@@ -48,260 +65,474 @@ ArcballHelper::ArcballHelper(
     std::shared_ptr<gst::ModelNode> result_node,
     ConstraintNodes constraint_nodes)
     : eye(eye),
-      drag_node(drag_node),
-      rim_node(rim_node),
-      result_node(result_node),
-      constraint_nodes(constraint_nodes),
+      helpers(eye),
+      scene_changed(true),
       show_drag(true),
       show_constraints(true),
       show_result(true),
       show_rim(true),
-      override_rim(false)
+      drag_stale(true),
+      rim_stale(true),
+      result_stale(true),
+      constraints_stale(true),
+      stats(),
+      circle_radius(-1.0f),
+      generated(false),
+      center(0.0f),
+      last_center(0.0f)
 {
+    drag.node = drag_node;
+    rim.node = rim_node;
+    result.node = result_node;
+    for (unsigned int i = 0; i < constraints.size(); i++) {
+        constraints[i].node = constraint_nodes[i];
+    }
+
+    for (auto node : { &drag, &rim, &result }) {
+        node->positions.reserve(capacity);
+        node->generated.reserve(capacity);
+        node->pending = false;
+    }
+    for (auto & node : constraints) {
+        node.positions.reserve(capacity);
+        node.generated.reserve(capacity);
+        node.pending = false;
+    }
+    circle.reserve(capacity);
 }
 
 void ArcballHelper::update(Arcball const & arcball)
 {
-    update_drag(arcball);
-    update_constraints(arcball);
-    update_result(arcball);
-    update_rim(arcball);
+    update(arcball.get_core());
+}
+
+void ArcballHelper::update(ArcballCore const & arcball)
+{
+    PROFILE_SCOPE("ArcballHelper::update");
+
+    generate(arcball);
+    upload();
+}
+
+void ArcballHelper::generate(ArcballCore const & arcball)
+{
+    PROFILE_SCOPE("ArcballHelper::generate");
+
+    stats = HelperStats();
+
+    // packing the instances costs less than telling if they changed
+    if (arc_renderer) {
+        instances.clear();
+        add_instances(arcball, instances);
+        return;
+    }
+
+    mark_stale(arcball);
+
+    if (show_drag && drag_stale) {
+        generate_drag(arcball);
+        drag_stale = false;
+    }
+    if (show_constraints && constraints_stale) {
+        generate_constraints(arcball);
+        constraints_stale = false;
+    }
+    if (show_result && result_stale) {
+        generate_result(arcball);
+        result_stale = false;
+    }
+    if (show_rim && rim_stale) {
+        generate_rim(arcball);
+        rim_stale = false;
+    }
+
+    center = arcball.get_center();
+}
+
+void ArcballHelper::upload()
+{
+    PROFILE_SCOPE("ArcballHelper::upload");
+
+    if (arc_renderer) {
+        update_scene();
+        return;
+    }
+
+    upload(drag);
+    upload(rim);
+    upload(result);
+    for (auto & node : constraints) {
+        // only the constraint axes change how they are drawn
+        if (node.pending && node.styled) {
+            node.node->get_mesh().set_draw_mode(node.draw_mode);
+            node.node->get_material().get_uniform("opacity") = node.opacity;
+        }
+        upload(node);
+    }
+
+    update_center();
+    update_scene();
+}
+
+void ArcballHelper::update_scene()
+{
+    // the scene is only rebuilt when the visibility of a node has changed or
+    // a node has become empty or non-empty
+    if (!scene_changed) {
+        return;
+    }
+    scene_changed = false;
 
     helpers = gst::Scene(eye);
 
-    if (show_drag) {
-        helpers.add(drag_node);
+    if (arc_renderer) {
+        helpers.update();
+        return;
     }
 
-    if (show_rim) {
-        helpers.add(rim_node);
+    if (show_drag && !drag.positions.empty()) {
+        helpers.add(drag.node);
     }
 
-    if (show_result) {
-        helpers.add(result_node);
+    if (show_rim && !rim.positions.empty()) {
+        helpers.add(rim.node);
+    }
+
+    if (show_result && !result.positions.empty()) {
+        helpers.add(result.node);
     }
 
     if (show_constraints) {
-        for (auto node : constraint_nodes) {
-            helpers.add(node);
+        for (auto const & node : constraints) {
+            if (!node.positions.empty()) {
+                helpers.add(node.node);
+            }
         }
     }
 
     helpers.update();
 }
 
+// the helpers are generated around the origin and moved to the center of the
+// ball, so moving the object does not regenerate them
+void ArcballHelper::update_center()
+{
+    if (center == last_center) {
+        return;
+    }
+    last_center = center;
+
+    const glm::vec3 position(center, 0.0f);
+    drag.node->position = position;
+    rim.node->position = position;
+    result.node->position = position;
+    for (auto & node : constraints) {
+        node.node->position = position;
+    }
+    // the transforms are recomputed with the scene
+    scene_changed = true;
+}
+
 void ArcballHelper::set_show_drag(bool show_drag)
 {
+    scene_changed = scene_changed || this->show_drag != show_drag;
     this->show_drag = show_drag;
 }
 
 void ArcballHelper::set_show_constraints(bool show_constraints)
 {
+    scene_changed = scene_changed || this->show_constraints != show_constraints;
+    // the rim is drawn in place of a constraint axis seen head on
+    rim_stale = rim_stale || this->show_constraints != show_constraints;
     this->show_constraints = show_constraints;
 }
 
 void ArcballHelper::set_show_result(bool show_result)
 {
+    scene_changed = scene_changed || this->show_result != show_result;
     this->show_result = show_result;
 }
 
 void ArcballHelper::set_show_rim(bool show_rim)
 {
+    scene_changed = scene_changed || this->show_rim != show_rim;
     this->show_rim = show_rim;
 }
 
-gst::Scene ArcballHelper::get_helpers() const
+// the nodes are generated again when drawn as nodes, they were left as they
+// were while the helpers were instances
+void ArcballHelper::set_arc_renderer(std::shared_ptr<ArcInstanceRenderer> arc_renderer)
 {
-    return helpers;
+    this->arc_renderer = arc_renderer;
+    scene_changed = true;
+    generated = false;
+    drag_stale = true;
+    rim_stale = true;
+    result_stale = true;
+    constraints_stale = true;
 }
 
-void ArcballHelper::update_drag(Arcball const & arcball)
+// the instances of every helper are uploaded right before they are drawn,
+// so the helpers of several views can share an arc renderer
+void ArcballHelper::draw_instances()
 {
-    std::vector<glm::vec3> positions;
+    if (!arc_renderer || instances.size() == 0) {
+        return;
+    }
+    PROFILE_SCOPE("ArcballHelper::draw_instances");
+    arc_renderer->upload(instances);
+    arc_renderer->draw();
+}
 
-    if (arcball.dragging) {
-        auto color = glm::vec3(1.0f, 1.0f, 0.0f);
-        // set appropiate drag arc color depending on the constraint axis
-        if (arcball.constraint.current != AxisSet::NONE) {
-            color = axis_index_color(arcball.constraint.nearest);
+// the instances follow the same rules as the helper nodes, except that the
+// focus axis of a drag is drawn as a line instead of points
+void ArcballHelper::add_instances(ArcballCore const & arcball, ArcInstanceBatch & batch) const
+{
+    auto const & constraint = arcball.get_constraint();
+    const float radius = arcball.get_radius();
+    const glm::vec2 center = arcball.get_center();
+    const bool constrained = arcball.get_allow_constraints() && constraint.current != AxisSet::NONE;
+
+    if (show_constraints && constrained) {
+        for (unsigned int i = 0; i < constraint.available.size(); i++) {
+            if (arcball.is_dragging() && i != constraint.nearest) {
+                continue;
+            }
+            const auto axis = constraint.available[i];
+            const float opacity = constraint.nearest == i ? 1.0f : 0.4f;
+            if (axis.z == 1.0f) {
+                batch.add_circle(radius, center, axis_index_color(i), opacity);
+            } else {
+                batch.add_half_arc(axis, radius, center, axis_index_color(i), opacity);
+            }
         }
-        auto & material = drag_node->get_material();
-        material.get_uniform("diffuse") = color;
+    }
+
+    if (show_rim && !rim_overridden(arcball)) {
+        batch.add_circle(radius, center, glm::vec3(0.3f, 0.3f, 0.3f), 0.4f);
+    }
+
+    if (show_result) {
+        batch.add_arc(arcball.get_result().from, arcball.get_result().to, radius, center, glm::vec3(1.0f, 0.5f, 0.0f), 1.0f);
+    }
 
-        fill_arc(arcball, positions, arcball.drag.from, arcball.drag.to);
+    if (show_drag && arcball.is_dragging()) {
+        auto color = glm::vec3(1.0f, 1.0f, 0.0f);
+        if (constraint.current != AxisSet::NONE) {
+            color = axis_index_color(constraint.nearest);
+        }
+        batch.add_arc(arcball.get_drag().from, arcball.get_drag().to, radius, center, color, 1.0f);
     }
+}
+
+gst::Scene & ArcballHelper::get_helpers()
+{
+    return helpers;
+}
 
-    auto & mesh = drag_node->get_mesh();
-    mesh.set_positions(positions);
+HelperStats const & ArcballHelper::get_stats() const
+{
+    return stats;
 }
 
-void ArcballHelper::update_rim(Arcball const & arcball)
+void ArcballHelper::generate_drag(ArcballCore const & arcball)
 {
-    std::vector<glm::vec3> positions;
+    drag.generated.clear();
+    drag.styled = arcball.is_dragging();
+
+    if (arcball.is_dragging()) {
+        auto color = glm::vec3(1.0f, 1.0f, 0.0f);
+        // set appropiate drag arc color depending on the constraint axis
+        if (arcball.get_constraint().current != AxisSet::NONE) {
+            color = axis_index_color(arcball.get_constraint().nearest);
+        }
+        drag.color = color;
 
-    if (!override_rim) {
-        auto & material = rim_node->get_material();
-        material.get_uniform("diffuse") = glm::vec3(0.3f, 0.3f, 0.3f);
-        fill_circle(arcball, positions);
+        fill_arc(arcball.get_radius(), drag.generated, arcball.get_drag().from, arcball.get_drag().to);
     }
 
-    auto & mesh = rim_node->get_mesh();
-    mesh.set_positions(positions);
+    finish(drag);
 }
 
-void ArcballHelper::update_constraints(Arcball const & arcball)
+void ArcballHelper::generate_rim(ArcballCore const & arcball)
 {
-    for (auto node : constraint_nodes) {
-        node->get_mesh().set_positions({});
-    }
+    rim.generated.clear();
+    rim.styled = !rim_overridden(arcball);
 
-    if (!arcball.allow_constraints) {
-        return;
+    if (rim.styled) {
+        rim.color = glm::vec3(0.3f, 0.3f, 0.3f);
+        generate_circle(arcball.get_radius(), rim.generated);
     }
 
-    override_rim = false;
-    if (arcball.dragging) {
-        // show only focus axis
-        if (arcball.constraint.current != AxisSet::NONE) {
-            fill_constraint(arcball, arcball.constraint.nearest);
-            // we use points to "fill" the axis with the drag arc line
-            auto & mesh = constraint_nodes[arcball.constraint.nearest]->get_mesh();
-            mesh.set_draw_mode(gst::DrawMode::POINTS);
-        }
-    } else {
-        // show all available axes and highlight the nearest axis
-        if (arcball.constraint.current != AxisSet::NONE) {
-            for (unsigned int i = 0; i < arcball.constraint.available.size(); i++) {
-                fill_constraint(arcball, i);
+    finish(rim);
+}
+
+void ArcballHelper::generate_constraints(ArcballCore const & arcball)
+{
+    auto const & constraint = arcball.get_constraint();
+    const bool constrained = arcball.get_allow_constraints() && constraint.current != AxisSet::NONE;
+
+    for (unsigned int i = 0; i < constraints.size(); i++) {
+        auto & node = constraints[i];
+        node.generated.clear();
+        node.styled = false;
+
+        if (constrained && arcball.is_dragging()) {
+            // show only focus axis
+            if (i == constraint.nearest) {
+                generate_constraint(arcball, i);
+                // we use points to "fill" the axis with the drag arc line
+                node.draw_mode = gst::DrawMode::POINTS;
+            }
+        } else if (constrained) {
+            // show all available axes and highlight the nearest axis
+            if (i < constraint.available.size()) {
+                generate_constraint(arcball, i);
             }
         }
+
+        finish(node);
     }
 }
 
-void ArcballHelper::update_result(Arcball const & arcball)
+void ArcballHelper::generate_result(ArcballCore const & arcball)
 {
-    std::vector<glm::vec3> positions;
-    fill_arc(arcball, positions, arcball.result.from, arcball.result.to);
+    result.generated.clear();
+    result_cache.fill_arc(arcball.get_radius(), result.generated, arcball.get_result().from, arcball.get_result().to);
 
-    auto & material = result_node->get_material();
-    material.get_uniform("diffuse") = glm::vec3(1.0f, 0.5f, 0.0f);
+    result.styled = true;
+    result.color = glm::vec3(1.0f, 0.5f, 0.0f);
 
-    auto & mesh = result_node->get_mesh();
-    mesh.set_positions(positions);
+    finish(result);
 }
 
-void ArcballHelper::fill_constraint(Arcball const & arcball, unsigned int index)
+// generate positions and look of the constraint axis at specified index
+void ArcballHelper::generate_constraint(ArcballCore const & arcball, unsigned int index)
 {
-    std::vector<glm::vec3> positions;
-    auto & mesh = constraint_nodes[index]->get_mesh();
-    auto & material = constraint_nodes[index]->get_material();
+    auto & node = constraints[index];
+    node.styled = true;
+    node.draw_mode = gst::DrawMode::LINE_STRIP;
+    node.color = axis_index_color(index);
+    node.opacity = arcball.get_constraint().nearest == index ? 1.0f : 0.4f;
 
-    mesh.set_draw_mode(gst::DrawMode::LINE_STRIP);
-    material.get_uniform("diffuse") = axis_index_color(index);
-    material.get_uniform("opacity") = arcball.constraint.nearest == index ? 1.0f : 0.4f;
-
-    auto axis = arcball.constraint.available[index];
+    auto axis = arcball.get_constraint().available[index];
     if (axis.z == 1.0f) {
         // we are looking down through the z-axis
-        mesh.set_draw_mode(gst::DrawMode::LINE_LOOP);
-        fill_circle(arcball, positions);
-        // we signal to not draw our rim to avoid color conflicts when drawing
-        override_rim = true;
+        node.draw_mode = gst::DrawMode::LINE_LOOP;
+        generate_circle(arcball.get_radius(), node.generated);
     } else {
-        fill_half_arc(arcball, positions, axis);
+        constraint_caches[index].fill_half_arc(arcball.get_radius(), node.generated, axis);
     }
-
-    mesh.set_positions(positions);
 }
 
-void ArcballHelper::fill_circle(Arcball const & arcball, std::vector<glm::vec3> & positions)
+// append circle with specified radius to positions, it is only generated
+// again when the radius changes
+void ArcballHelper::generate_circle(float radius, std::vector<glm::vec3> & positions)
 {
-    const auto segments = 64;
-    const auto radius = arcball.radius;
-    const auto PI_2 = PI * 2.0f;
-    const auto segment = PI_2 / segments;
-
-    for (auto i = 0.0f; i < PI_2; i += segment) {
-        glm::vec3 position(cos(i), sin(i), 0.0f);
-        positions.push_back(position * radius);
+    if (radius != circle_radius) {
+        circle.clear();
+        fill_circle(radius, circle);
+        circle_radius = radius;
     }
+    positions.insert(positions.end(), circle.begin(), circle.end());
 }
 
-void ArcballHelper::fill_arc(
-    Arcball const & arcball,
-    std::vector<glm::vec3> & positions,
-    glm::vec3 from,
-    glm::vec3 to)
+// mark generated geometry of specified node to be uploaded
+void ArcballHelper::finish(HelperNode & node)
 {
-    const auto arc_bisects = 5;
-    const auto arc_segments = 32;
-
-    std::array<glm::vec3, arc_segments + 1> points;
-    points[0] = from;
-    points[1] = to;
-    points[arc_segments] = to;
+    node.pending = true;
+    if (!node.generated.empty()) {
+        stats.generated_nodes++;
+        stats.generated_positions += node.generated.size();
+    }
+}
 
-    // we have our first and last point, we bisect the arc to find the second
-    // point
-    for (int i = 0; i < arc_bisects; i++) {
-        points[1] = bisect(points[0], points[1]);
+// upload positions generated for specified node unless they are equal to the
+// positions uploaded last or empty, an empty node is left out of the scene
+// instead, the storage is swapped so no allocation is made
+void ArcballHelper::upload(HelperNode & node)
+{
+    if (!node.pending) {
+        return;
     }
+    node.pending = false;
 
-    const auto radius = arcball.radius;
-    auto push = [&positions, radius](glm::vec3 point) {
-        positions.push_back(point * radius);
-    };
+    if (node.styled) {
+        node.node->get_material().get_uniform("diffuse") = node.color;
+    }
 
-    push(points[0]);
-    push(points[1]);
+    if (node.generated == node.positions) {
+        return;
+    }
+    scene_changed = scene_changed || node.generated.empty() != node.positions.empty();
+    node.positions.swap(node.generated);
 
-    // using our first two points, we use dynamic programming to build up the
-    // remaining points of the arc
-    const float dot_two = glm::dot(points[0], points[1]) * 2.0f;
-    for (int i = 2; i < arc_segments; i++) {
-        points[i] = (points[i - 1] * dot_two) - points[i - 2];
-        push(points[i]);
+    if (!node.positions.empty()) {
+        node.node->get_mesh().set_positions(node.positions);
+        stats.uploaded_nodes++;
+        stats.uploaded_positions += node.positions.size();
     }
-    push(points[arc_segments]);
 }
 
-void ArcballHelper::fill_half_arc(
-    Arcball const & arcball,
-    std::vector<glm::vec3> & positions,
-    glm::vec3 axis)
+// return true if a constraint axis is seen head on and drawn as a circle in
+// place of the rim, to avoid color conflicts
+bool ArcballHelper::rim_overridden(ArcballCore const & arcball) const
 {
-    // create a perpendicular vector that is a "mirror" over another axis
-    glm::vec3 mirror_point;
-    if (axis.z != 1.0f) {
-        mirror_point.x = axis.y;
-        mirror_point.y = -axis.x;
-        mirror_point = glm::normalize(mirror_point);
-    } else {
-        mirror_point.x = 0.0f;
-        mirror_point.y = 1.0f;
+    auto const & constraint = arcball.get_constraint();
+    const bool constrained = arcball.get_allow_constraints() && constraint.current != AxisSet::NONE;
+    if (!show_constraints || !constrained) {
+        return false;
     }
 
-    auto mid_point = glm::cross(mirror_point, axis);
-
-    // "combine" the two half arcs into one arc
-    fill_arc(arcball, positions, mirror_point, mid_point);
-    fill_arc(arcball, positions, mid_point, -mirror_point);
+    for (unsigned int i = 0; i < constraint.available.size(); i++) {
+        const bool shown = !arcball.is_dragging() || i == constraint.nearest;
+        if (shown && constraint.available[i].z == 1.0f) {
+            return true;
+        }
+    }
+    return false;
 }
 
-glm::vec3 ArcballHelper::bisect(glm::vec3 a, glm::vec3 b)
+// mark the nodes whose geometry depends on arcball state that has changed
+// since the last call as stale, a node only depends on the state it is drawn
+// from so hovering without constraints leaves every node as it is
+void ArcballHelper::mark_stale(ArcballCore const & arcball)
 {
-    const float epsilon = 1.0e-8f;
-    auto v = a + b;
-    float length2 = glm::length2(v);
-    if (length2 < epsilon) {
-        v = glm::vec3(0.0f, 0.0f, 1.0f);
-    } else {
-        v *= (1.0 / sqrt(length2));
-    }
-    return v;
+    auto const & constraint = arcball.get_constraint();
+    const bool dragging = arcball.is_dragging();
+    const bool overridden = rim_overridden(arcball);
+
+    const bool same_ball = generated && last_radius == arcball.get_radius();
+    const bool same_focus = last_axis_set == constraint.current && last_nearest == constraint.nearest;
+    const bool same_drag = same_ball &&
+                           last_dragging == dragging &&
+                           (!dragging || (same_focus && last_drag == arcball.get_drag()));
+    const bool same_constraints = same_ball &&
+                                  same_focus &&
+                                  last_dragging == dragging &&
+                                  last_allow_constraints == arcball.get_allow_constraints() &&
+                                  last_axes == constraint.available;
+    const bool same_result = same_ball && last_result == arcball.get_result();
+    const bool same_rim = same_ball && last_rim_overridden == overridden;
+
+    drag_stale = drag_stale || !same_drag;
+    constraints_stale = constraints_stale || !same_constraints;
+    result_stale = result_stale || !same_result;
+    rim_stale = rim_stale || !same_rim;
+
+    generated = true;
+    last_dragging = dragging;
+    last_allow_constraints = arcball.get_allow_constraints();
+    last_radius = arcball.get_radius();
+    last_axis_set = constraint.current;
+    last_nearest = constraint.nearest;
+    last_axes = constraint.available;
+    last_drag = arcball.get_drag();
+    last_result = arcball.get_result();
+    last_rim_overridden = overridden;
 }
 
-glm::vec3 ArcballHelper::axis_index_color(unsigned int index)
+glm::vec3 ArcballHelper::axis_index_color(unsigned int index) const
 {
     switch (index) {
     case 0:
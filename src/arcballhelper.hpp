@@ -2,13 +2,30 @@
 #define ARCBALLHELPER_HPP_INCLUDED
 
 #include "arcball.hpp"
+#include "arccache.hpp"
+#include "arcinstancerenderer.hpp"
 
 #include "gust.hpp"
 
-typedef std::array<std::shared_ptr<gst::ModelNode>, 3> ConstraintNodes;
+typedef std::array<std::shared_ptr<gst::ModelNode>, max_constraint_axes> ConstraintNodes;
+
+// Geometry produced by the last update of a arcball helper, nodes that were
+// generated empty are not counted.
+struct HelperStats {
+    unsigned int generated_nodes;
+    unsigned int generated_positions;
+    unsigned int uploaded_nodes;
+    unsigned int uploaded_positions;
+};
 
 // The responsibility of this class is to show graphical helpers for a
-// arcball.
+// arcball. Geometry is generated on demand, only for visible nodes and only
+// when the arcball state feeding it has changed, and empty nodes are left
+// out of the scene instead of being uploaded. Generating touches nothing but
+// the helper itself, so the helpers of several views can be generated on
+// separate threads and then uploaded on the rendering thread. The helpers
+// can also be drawn as arc instances in a single instanced draw instead of
+// the nodes of the helper scene.
 class ArcballHelper {
 public:
     // Construct arcball helper with default implementation.
@@ -28,6 +45,14 @@ public:
         ConstraintNodes constraint_nodes);
     // Update helpers to reflect current arcball state.
     void update(Arcball const & arcball);
+    // Update helpers to reflect state of specified arcball core.
+    void update(ArcballCore const & arcball);
+    // Generate geometry for the current state of specified arcball core
+    // without touching the scene, it is shown by the next upload.
+    void generate(ArcballCore const & arcball);
+    // Upload geometry generated since the last upload and rebuild the scene
+    // if needed, this must be done on the rendering thread.
+    void upload();
     // Set visibility of drag arc.
     void set_show_drag(bool show_drag);
     // Set visibility of constraint axes.
@@ -36,41 +61,97 @@ public:
     void set_show_result(bool show_result);
     // Set visibility of rim.
     void set_show_rim(bool show_rim);
+    // Set renderer which draws the helpers as arc instances, the helper
+    // scene is then left empty. Null draws the helpers as nodes again.
+    void set_arc_renderer(std::shared_ptr<ArcInstanceRenderer> arc_renderer);
+    // Draw the helpers generated last as arc instances if there is an arc
+    // renderer, this must be done on the rendering thread.
+    void draw_instances();
+    // Add the visible helpers of specified arcball core as arc instances to
+    // specified batch, so the helpers of many arcballs can be drawn with the
+    // arc shaders in a single instanced draw.
+    void add_instances(ArcballCore const & arcball, ArcInstanceBatch & batch) const;
     // Return constructed scene from last update.
-    gst::Scene get_helpers() const;
+    gst::Scene & get_helpers();
+    // Return geometry produced by the last update.
+    HelperStats const & get_stats() const;
 private:
-    void update_drag(Arcball const & arcball);
-    void update_rim(Arcball const & arcball);
-    void update_constraints(Arcball const & arcball);
-    void update_result(Arcball const & arcball);
+    // a helper node, the positions last uploaded to it, and the positions
+    // and look generated for it since
+    struct HelperNode {
+        std::shared_ptr<gst::ModelNode> node;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> generated;
+        bool pending;
+        bool styled;
+        gst::DrawMode draw_mode;
+        glm::vec3 color;
+        float opacity;
+    };
 
-    void fill_constraint(Arcball const & arcball, unsigned int index);
-    void fill_circle(Arcball const & arcball, std::vector<glm::vec3> & positions);
-    void fill_arc(
-        Arcball const & arcball,
-        std::vector<glm::vec3> & positions,
-        glm::vec3 from,
-        glm::vec3 to);
-    void fill_half_arc(
-        Arcball const & arcball,
-        std::vector<glm::vec3> & positions,
-        glm::vec3 axis);
-    glm::vec3 bisect(glm::vec3 a, glm::vec3 b);
-    glm::vec3 axis_index_color(unsigned int index);
+    void generate_drag(ArcballCore const & arcball);
+    void generate_rim(ArcballCore const & arcball);
+    void generate_constraints(ArcballCore const & arcball);
+    void generate_result(ArcballCore const & arcball);
+    void generate_constraint(ArcballCore const & arcball, unsigned int index);
+    void generate_circle(float radius, std::vector<glm::vec3> & positions);
+    void finish(HelperNode & node);
+
+    void upload(HelperNode & node);
+    void update_scene();
+    void update_center();
+    bool rim_overridden(ArcballCore const & arcball) const;
+    void mark_stale(ArcballCore const & arcball);
+    glm::vec3 axis_index_color(unsigned int index) const;
 
     std::shared_ptr<gst::CameraNode> eye;
     gst::Scene helpers;
+    bool scene_changed;
+
+    // instances generated last when drawn by an arc renderer
+    std::shared_ptr<ArcInstanceRenderer> arc_renderer;
+    ArcInstanceBatch instances;
 
-    std::shared_ptr<gst::ModelNode> drag_node;
-    std::shared_ptr<gst::ModelNode> rim_node;
-    std::shared_ptr<gst::ModelNode> result_node;
-    ConstraintNodes constraint_nodes;
+    HelperNode drag;
+    HelperNode rim;
+    HelperNode result;
+    std::array<HelperNode, max_constraint_axes> constraints;
 
     bool show_drag;
     bool show_constraints;
     bool show_result;
     bool show_rim;
-    bool override_rim;
+
+    // nodes whose geometry is behind the arcball state, hidden nodes are
+    // only brought up to date once they are shown
+    bool drag_stale;
+    bool rim_stale;
+    bool result_stale;
+    bool constraints_stale;
+    HelperStats stats;
+
+    // unit arcs last generated for the result and each constraint axis,
+    // which rarely change between updates
+    ArcCache result_cache;
+    std::array<ArcCache, max_constraint_axes> constraint_caches;
+    // circle last generated and its radius, the rim and a constraint axis
+    // seen head on share it
+    std::vector<glm::vec3> circle;
+    float circle_radius;
+
+    // arcball state the helpers were last generated from
+    bool generated;
+    glm::vec2 center;
+    glm::vec2 last_center;
+    bool last_dragging;
+    bool last_allow_constraints;
+    float last_radius;
+    AxisSet last_axis_set;
+    unsigned int last_nearest;
+    ConstraintAxes last_axes;
+    Arc last_drag;
+    Arc last_result;
+    bool last_rim_overridden;
 };
 
 #endif
@@ -0,0 +1,210 @@
+#include "arcinstancerenderer.hpp"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// attribute locations bound before linking, one per member of an instance
+enum Attribute {
+    CENTER,
+    FROM,
+    TO,
+    RADIUS,
+    COLOR,
+    OPACITY
+};
+
+// return content of file at specified path, or an empty string if it could
+// not be read
+std::string read_file(std::string const & path)
+{
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// return compiled shader of specified type from source at specified path, or
+// zero if it could not be compiled
+GLuint compile_shader(GLenum type, std::string const & path)
+{
+    const std::string source = read_file(path);
+    if (source.empty()) {
+        std::cerr << "unable to read shader " << path << std::endl;
+        return 0;
+    }
+
+    const GLuint shader = glCreateShader(type);
+    char const * text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "unable to compile shader " << path << ": " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// set specified attribute to be read once per instance from the member at
+// specified offset of the packed instances
+void set_attribute(Attribute attribute, GLint size, std::size_t offset)
+{
+    glEnableVertexAttribArray(attribute);
+    glVertexAttribPointer(
+        attribute,
+        size,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(ArcInstance),
+        reinterpret_cast<void const *>(offset));
+    glVertexAttribDivisor(attribute, 1);
+}
+
+}
+
+ArcInstanceRenderer::ArcInstanceRenderer()
+    : program(0),
+      vertex_array(0),
+      buffer(0),
+      count(0),
+      capacity(0)
+{
+}
+
+ArcInstanceRenderer::~ArcInstanceRenderer()
+{
+    destroy();
+}
+
+bool ArcInstanceRenderer::create(std::string const & vs_path, std::string const & fs_path)
+{
+    destroy();
+
+    if (!GLEW_VERSION_3_3 && !GLEW_ARB_instanced_arrays) {
+        std::cerr << "instanced drawing is not supported" << std::endl;
+        return false;
+    }
+
+    const GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vs_path);
+    const GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fs_path);
+    if (vertex_shader == 0 || fragment_shader == 0) {
+        glDeleteShader(vertex_shader);
+        glDeleteShader(fragment_shader);
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glBindAttribLocation(program, CENTER, "arc_center");
+    glBindAttribLocation(program, FROM, "arc_from");
+    glBindAttribLocation(program, TO, "arc_to");
+    glBindAttribLocation(program, RADIUS, "arc_radius");
+    glBindAttribLocation(program, COLOR, "arc_color");
+    glBindAttribLocation(program, OPACITY, "arc_opacity");
+    glBindFragDataLocation(program, 0, "frag_color");
+    glLinkProgram(program);
+    // the shaders are freed with the program
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        std::cerr << "unable to link arc shaders: " << log << std::endl;
+        destroy();
+        return false;
+    }
+
+    glGenVertexArrays(1, &vertex_array);
+    glGenBuffers(1, &buffer);
+    glBindVertexArray(vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    set_attribute(CENTER, 2, offsetof(ArcInstance, center));
+    set_attribute(FROM, 3, offsetof(ArcInstance, from));
+    set_attribute(TO, 3, offsetof(ArcInstance, to));
+    set_attribute(RADIUS, 1, offsetof(ArcInstance, radius));
+    set_attribute(COLOR, 3, offsetof(ArcInstance, color));
+    set_attribute(OPACITY, 1, offsetof(ArcInstance, opacity));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+// the buffer only grows, a batch that fits is written into it in place
+void ArcInstanceRenderer::upload(ArcInstanceBatch const & batch)
+{
+    count = batch.size();
+    if (buffer == 0 || count == 0) {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (count > capacity) {
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(ArcInstance), batch.data(), GL_STREAM_DRAW);
+        capacity = count;
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(ArcInstance), batch.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// the helpers are drawn over the scene and blended like the helper nodes,
+// the state changed here is restored for the renderer
+void ArcInstanceRenderer::draw()
+{
+    if (program == 0 || count == 0) {
+        return;
+    }
+
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    const GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+
+    glUseProgram(program);
+    glBindVertexArray(vertex_array);
+    glDrawArraysInstanced(GL_LINE_STRIP, 0, arc_instance_vertices, count);
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    if (!blend) {
+        glDisable(GL_BLEND);
+    }
+    if (depth_test) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+void ArcInstanceRenderer::destroy()
+{
+    if (buffer != 0) {
+        glDeleteBuffers(1, &buffer);
+    }
+    if (vertex_array != 0) {
+        glDeleteVertexArrays(1, &vertex_array);
+    }
+    if (program != 0) {
+        glDeleteProgram(program);
+    }
+    program = 0;
+    vertex_array = 0;
+    buffer = 0;
+    count = 0;
+    capacity = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef ARCINSTANCERENDERER_HPP_INCLUDED
+#define ARCINSTANCERENDERER_HPP_INCLUDED
+
+#include "arcinstances.hpp"
+
+#include <string>
+
+// The responsibility of this class is to draw a batch of arc instances with
+// the arc shaders in a single instanced draw. The renderer has no instanced
+// draw, so the program and buffers are driven through OpenGL directly on the
+// rendering thread, with the context the renderer uses.
+class ArcInstanceRenderer {
+public:
+    // Construct renderer without any OpenGL objects.
+    ArcInstanceRenderer();
+    // Delete OpenGL objects.
+    ~ArcInstanceRenderer();
+    ArcInstanceRenderer(ArcInstanceRenderer const &) = delete;
+    ArcInstanceRenderer & operator=(ArcInstanceRenderer const &) = delete;
+    // Compile arc shaders from specified paths and create buffers. Return
+    // false if instanced drawing is not supported or the shaders could not
+    // be compiled and linked.
+    bool create(std::string const & vs_path, std::string const & fs_path);
+    // Upload instances of specified batch, they are drawn by every draw
+    // until the next upload.
+    void upload(ArcInstanceBatch const & batch);
+    // Draw uploaded instances over the current viewport.
+    void draw();
+private:
+    void destroy();
+
+    unsigned int program;
+    unsigned int vertex_array;
+    unsigned int buffer;
+    // instances uploaded, and instances the buffer has room for
+    unsigned int count;
+    unsigned int capacity;
+};
+
+#endif
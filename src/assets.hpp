@@ -3,9 +3,12 @@
 
 #define BASIC_VS      "assets/shaders/basic.vs"
 #define BASIC_FS      "assets/shaders/basic.fs"
+#define ARC_VS        "assets/shaders/arc.vs"
+#define ARC_FS        "assets/shaders/arc.fs"
 #define BLINNPHONG_VS "assets/shaders/blinnphong.vs"
 #define BLINNPHONG_FS "assets/shaders/blinnphong.fs"
 
-#define SUZANNE_OBJ "assets/models/suzanne.obj"
+#define SUZANNE_OBJ  "assets/models/suzanne.obj"
+#define SUZANNE_MESH "assets/models/suzanne.mesh"
 
 #endif
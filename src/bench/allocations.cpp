@@ -0,0 +1,43 @@
+#include "allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// replace the global allocation functions to count allocations, every other
+// form of operator new is implemented in terms of these
+namespace {
+
+std::atomic<unsigned long> count(0);
+
+}
+
+unsigned long allocation_count()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+void * operator new(std::size_t size)
+{
+    count.fetch_add(1, std::memory_order_relaxed);
+    void * p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void * p) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,8 @@
+#ifndef ALLOCATIONS_HPP_INCLUDED
+#define ALLOCATIONS_HPP_INCLUDED
+
+// Return number of heap allocations made through operator new since program
+// start.
+unsigned long allocation_count();
+
+#endif
@@ -0,0 +1,58 @@
+#include "benchmark.hpp"
+
+#include <iomanip>
+
+namespace {
+
+volatile float sink;
+
+std::string escape(std::string const & value)
+{
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+}
+
+void Benchmark::add_context(std::string const & key, std::string const & value)
+{
+    context.push_back(std::make_pair(key, value));
+}
+
+void Benchmark::write_json(std::ostream & out) const
+{
+    out << "{\n  \"context\": {";
+    for (unsigned int i = 0; i < context.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    \"" << escape(context[i].first) << "\": \"" << escape(context[i].second) << "\"";
+    }
+    out << "\n  },\n  \"benchmarks\": [";
+    for (unsigned int i = 0; i < results.size(); i++) {
+        auto const & result = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {"
+            << "\"name\": \"" << escape(result.name) << "\", "
+            << "\"iterations\": " << result.iterations << ", "
+            << std::fixed << std::setprecision(3)
+            << "\"ns_per_op\": " << result.ns_per_op << ", "
+            << "\"allocations_per_op\": " << result.allocations_per_op
+            << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+std::vector<BenchmarkResult> const & Benchmark::get_results() const
+{
+    return results;
+}
+
+void consume(float value)
+{
+    sink = value;
+}
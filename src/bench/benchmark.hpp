@@ -0,0 +1,68 @@
+#ifndef BENCHMARK_HPP_INCLUDED
+#define BENCHMARK_HPP_INCLUDED
+
+#include "allocations.hpp"
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BenchmarkResult {
+    std::string name;
+    unsigned long iterations;
+    double ns_per_op;
+    double allocations_per_op;
+};
+
+// The responsibility of this class is to measure time and heap allocations
+// per operation and report them as machine-readable JSON.
+class Benchmark {
+public:
+    // Run operation specified number of iterations, after a short warm up,
+    // and record the result under specified name. The operation is called
+    // with the iteration index.
+    template <typename Operation>
+    void run(std::string const & name, unsigned long iterations, Operation operation);
+    // Add a key and value describing the environment of the results.
+    void add_context(std::string const & key, std::string const & value);
+    // Write all results as JSON to specified stream.
+    void write_json(std::ostream & out) const;
+    // Return all results.
+    std::vector<BenchmarkResult> const & get_results() const;
+private:
+    std::vector<std::pair<std::string, std::string>> context;
+    std::vector<BenchmarkResult> results;
+};
+
+// Keep specified value alive so the computation producing it is not
+// optimized away.
+void consume(float value);
+
+template <typename Operation>
+void Benchmark::run(std::string const & name, unsigned long iterations, Operation operation)
+{
+    typedef std::chrono::steady_clock clock;
+
+    for (unsigned long i = 0; i < iterations / 10; i++) {
+        operation(i);
+    }
+
+    const unsigned long allocations = allocation_count();
+    const auto begin = clock::now();
+    for (unsigned long i = 0; i < iterations; i++) {
+        operation(i);
+    }
+    const auto end = clock::now();
+    const unsigned long allocated = allocation_count() - allocations;
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+    result.allocations_per_op = static_cast<double>(allocated) / iterations;
+    results.push_back(result);
+}
+
+#endif
@@ -0,0 +1,628 @@
+#include "checks.hpp"
+
+#include "arcballbatch.hpp"
+#include "arcballcore.hpp"
+#include "arcballgeometry.hpp"
+#include "arcballkernels.hpp"
+#include "arcballmath.hpp"
+#include "arcinstances.hpp"
+#include "objloader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const unsigned int samples = 5000;
+const unsigned int kernel_samples = 1 << 16;
+
+// largest distance in units in the last place between a kernel result and
+// arcballmath, as documented in arcballkernels
+const std::uint32_t kernel_ulp_tolerance = 2;
+// largest angle in radians between the slerp kernel and a double precision
+// slerp, a few ULP of the trigonometric approximations
+const double slerp_tolerance = 1.0e-6;
+// arcballs in the batch compared against arcball cores, not a multiple of any
+// kernel width so the scalar tails are compared too
+const unsigned int batch_arcballs = 61;
+const unsigned int batch_drags = 200;
+// largest difference of an orientation component between the batch and an
+// arcball core, the kernel tolerance grows as orientations are chained over
+// the drags
+const float batch_tolerance = 1.0e-5f;
+
+// return random point on the unit ball
+glm::vec3 random_unit(std::mt19937 & random)
+{
+    std::normal_distribution<float> normal;
+    glm::vec3 v;
+    do {
+        v = glm::vec3(normal(random), normal(random), normal(random));
+    } while (glm::dot(v, v) < 1.0e-6f);
+    return glm::normalize(v);
+}
+
+// return largest distance between points at the same index
+float max_distance(std::vector<glm::vec3> const & a, std::vector<glm::vec3> const & b)
+{
+    float distance = 0.0f;
+    for (unsigned int i = 0; i < a.size(); i++) {
+        distance = std::max(distance, glm::length(a[i] - b[i]));
+    }
+    return distance;
+}
+
+// move points generated around the origin to specified center, as the arc
+// instances are
+void move_to_center(std::vector<glm::vec3> & points, glm::vec2 center)
+{
+    for (auto & point : points) {
+        point += glm::vec3(center, 0.0f);
+    }
+}
+
+// OBJ content and the number of triangles parsed from it, or -1 if it is
+// malformed
+struct ObjCase {
+    char const * content;
+    int triangles;
+};
+
+const ObjCase obj_cases[] = {
+    { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", 1 },
+    { "v 0 0 0 # origin\nv 1 0 0\nv 0 1 0\nf 1 2 3 # tri\n", 1 },
+    { "# a quad\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1 4//1#quad\n", 2 },
+    { "v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nf -3 -2 -1 # relative\r\n", 1 },
+    { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 # 3\n", -1 },
+    { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", -1 },
+    { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4294967297\n", -1 },
+    { "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3 tri\n", -1 },
+    { "v 0 0 # 0\n", -1 }
+};
+
+// return number of representable floats between two floats
+std::uint32_t ulp_distance(float a, float b)
+{
+    if (a == b) {
+        return 0;
+    }
+    // map the bit patterns to integers ordered like the floats
+    auto ordered = [](float value) {
+        std::int32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits < 0 ? static_cast<std::int64_t>(INT32_MIN) - bits : static_cast<std::int64_t>(bits);
+    };
+    const std::int64_t distance = ordered(a) - ordered(b);
+    return static_cast<std::uint32_t>(std::min<std::int64_t>(std::abs(distance), UINT32_MAX));
+}
+
+// arrays of one component each, as the kernels take them
+struct Lanes {
+    explicit Lanes(unsigned int size = kernel_samples)
+        : x(size), y(size), z(size), w(size)
+    {
+    }
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> w;
+
+    bool operator==(Lanes const & other) const
+    {
+        // compared as bits, so a NaN in both is equal
+        auto same = [](std::vector<float> const & a, std::vector<float> const & b) {
+            return std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+        };
+        return same(x, other.x) && same(y, other.y) && same(z, other.z) && same(w, other.w);
+    }
+};
+
+// outputs of every kernel of a kernel set on the same input
+struct KernelOutputs {
+    Lanes projected;
+    Lanes constrained;
+    Lanes composed;
+    Lanes spun;
+    Lanes spun_velocity;
+    Lanes slerped;
+};
+
+// inputs of every kernel
+struct KernelInputs {
+    float mouse_x;
+    float mouse_y;
+    std::vector<float> viewport_x;
+    std::vector<float> viewport_y;
+    std::vector<float> viewport_width;
+    std::vector<float> viewport_height;
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> radius;
+    Lanes points;
+    Lanes axes;
+    Lanes from;
+    Lanes to;
+    float eye[4];
+    Lanes start;
+    Lanes velocity;
+    Lanes target;
+    std::vector<float> t;
+};
+
+KernelInputs create_kernel_inputs(std::mt19937 & random)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> normal;
+
+    KernelInputs inputs;
+    inputs.mouse_x = 400.0f;
+    inputs.mouse_y = 300.0f;
+    inputs.viewport_x.resize(kernel_samples);
+    inputs.viewport_y.resize(kernel_samples);
+    inputs.viewport_width.resize(kernel_samples);
+    inputs.viewport_height.resize(kernel_samples);
+    inputs.center_x.resize(kernel_samples);
+    inputs.center_y.resize(kernel_samples);
+    inputs.radius.resize(kernel_samples);
+    inputs.t.resize(kernel_samples);
+
+    const glm::quat eye = glm::normalize(glm::quat(normal(random), normal(random), normal(random), normal(random)));
+    inputs.eye[0] = eye.w;
+    inputs.eye[1] = eye.x;
+    inputs.eye[2] = eye.y;
+    inputs.eye[3] = eye.z;
+
+    for (unsigned int i = 0; i < kernel_samples; i++) {
+        // viewports around the mouse, so it falls both on and off the ball
+        inputs.viewport_width[i] = std::floor(100.0f + 1000.0f * uniform(random));
+        inputs.viewport_height[i] = std::floor(100.0f + 1000.0f * uniform(random));
+        inputs.viewport_x[i] = std::floor(inputs.mouse_x - inputs.viewport_width[i] * uniform(random));
+        inputs.viewport_y[i] = std::floor(inputs.mouse_y - inputs.viewport_height[i] * uniform(random));
+        inputs.center_x[i] = uniform(random) - 0.5f;
+        inputs.center_y[i] = uniform(random) - 0.5f;
+        inputs.radius[i] = 0.25f + 0.75f * uniform(random);
+
+        const glm::vec3 point = random_unit(random);
+        const glm::vec3 axis = random_unit(random);
+        const glm::vec3 from = random_unit(random);
+        const glm::vec3 to = random_unit(random);
+        const glm::quat start = glm::normalize(glm::quat(normal(random), normal(random), normal(random), normal(random)));
+        inputs.points.x[i] = point.x;
+        inputs.points.y[i] = point.y;
+        inputs.points.z[i] = point.z;
+        inputs.axes.x[i] = axis.x;
+        inputs.axes.y[i] = axis.y;
+        inputs.axes.z[i] = axis.z;
+        inputs.from.x[i] = from.x;
+        inputs.from.y[i] = from.y;
+        inputs.from.z[i] = from.z;
+        inputs.to.x[i] = to.x;
+        inputs.to.y[i] = to.y;
+        inputs.to.z[i] = to.z;
+        inputs.start.w[i] = start.w;
+        inputs.start.x[i] = start.x;
+        inputs.start.y[i] = start.y;
+        inputs.start.z[i] = start.z;
+        inputs.velocity.x[i] = 4.0f * normal(random);
+        inputs.velocity.y[i] = 4.0f * normal(random);
+        inputs.velocity.z[i] = 4.0f * normal(random);
+
+        // a third of the pairs to slerp are close together, down to the
+        // pairs that are interpolated linearly
+        const float spread = i % 3 == 0 ? 1.0f : (i % 3 == 1 ? 0.03f : 0.003f);
+        const glm::quat target = glm::normalize(start + spread * glm::quat(normal(random), normal(random), normal(random), normal(random)));
+        inputs.target.w[i] = target.w;
+        inputs.target.x[i] = target.x;
+        inputs.target.y[i] = target.y;
+        inputs.target.z[i] = target.z;
+        inputs.t[i] = uniform(random);
+    }
+    return inputs;
+}
+
+KernelOutputs run_kernels(ArcballKernels const & kernels, KernelInputs const & inputs)
+{
+    KernelOutputs outputs;
+    kernels.project_to_ball(
+        kernel_samples,
+        inputs.mouse_x,
+        inputs.mouse_y,
+        inputs.viewport_x.data(),
+        inputs.viewport_y.data(),
+        inputs.viewport_width.data(),
+        inputs.viewport_height.data(),
+        inputs.center_x.data(),
+        inputs.center_y.data(),
+        inputs.radius.data(),
+        outputs.projected.x.data(),
+        outputs.projected.y.data(),
+        outputs.projected.z.data());
+    kernels.constrain_to(
+        kernel_samples,
+        inputs.points.x.data(),
+        inputs.points.y.data(),
+        inputs.points.z.data(),
+        inputs.axes.x.data(),
+        inputs.axes.y.data(),
+        inputs.axes.z.data(),
+        outputs.constrained.x.data(),
+        outputs.constrained.y.data(),
+        outputs.constrained.z.data());
+    kernels.drag_compose(
+        kernel_samples,
+        inputs.from.x.data(),
+        inputs.from.y.data(),
+        inputs.from.z.data(),
+        inputs.to.x.data(),
+        inputs.to.y.data(),
+        inputs.to.z.data(),
+        inputs.eye,
+        inputs.start.w.data(),
+        inputs.start.x.data(),
+        inputs.start.y.data(),
+        inputs.start.z.data(),
+        outputs.composed.w.data(),
+        outputs.composed.x.data(),
+        outputs.composed.y.data(),
+        outputs.composed.z.data());
+
+    outputs.spun = inputs.start;
+    outputs.spun_velocity = inputs.velocity;
+    kernels.spin(
+        kernel_samples,
+        1.0f / 120.0f,
+        0.975f,
+        outputs.spun_velocity.x.data(),
+        outputs.spun_velocity.y.data(),
+        outputs.spun_velocity.z.data(),
+        outputs.spun.w.data(),
+        outputs.spun.x.data(),
+        outputs.spun.y.data(),
+        outputs.spun.z.data());
+
+    kernels.slerp(
+        kernel_samples,
+        inputs.t.data(),
+        inputs.start.w.data(),
+        inputs.start.x.data(),
+        inputs.start.y.data(),
+        inputs.start.z.data(),
+        inputs.target.w.data(),
+        inputs.target.x.data(),
+        inputs.target.y.data(),
+        inputs.target.z.data(),
+        outputs.slerped.w.data(),
+        outputs.slerped.x.data(),
+        outputs.slerped.y.data(),
+        outputs.slerped.z.data());
+    return outputs;
+}
+
+// return largest ULP distance of the components of two vectors
+std::uint32_t max_ulp(glm::vec3 a, glm::vec3 b)
+{
+    return std::max(ulp_distance(a.x, b.x), std::max(ulp_distance(a.y, b.y), ulp_distance(a.z, b.z)));
+}
+
+// return angle in radians between a float and a double precision orientation,
+// from the distance between them since the dot product loses the small
+// angles to rounding
+double angle(glm::quat a, double const b[4])
+{
+    const double q[4] = { a.w, a.x, a.y, a.z };
+    const double sign = q[0] * b[0] + q[1] * b[1] + q[2] * b[2] + q[3] * b[3] < 0.0 ? -1.0 : 1.0;
+    double distance2 = 0.0;
+    for (int i = 0; i < 4; i++) {
+        const double d = q[i] - sign * b[i];
+        distance2 += d * d;
+    }
+    return 4.0 * std::asin(std::min(std::sqrt(distance2) / 2.0, 1.0));
+}
+
+// return slerp in double precision, the shorter way around
+void reference_slerp(glm::quat from, glm::quat to, double t, double result[4])
+{
+    double a[4] = { from.w, from.x, from.y, from.z };
+    double b[4] = { to.w, to.x, to.y, to.z };
+    double dot = 0.0;
+    for (int i = 0; i < 4; i++) {
+        dot += a[i] * b[i];
+    }
+    if (dot < 0.0) {
+        for (int i = 0; i < 4; i++) {
+            b[i] = -b[i];
+        }
+        dot = -dot;
+    }
+
+    const double theta = std::acos(std::min(dot, 1.0));
+    double wa = 1.0 - t;
+    double wb = t;
+    if (theta > 1.0e-12) {
+        wa = std::sin((1.0 - t) * theta) / std::sin(theta);
+        wb = std::sin(t * theta) / std::sin(theta);
+    }
+    double length2 = 0.0;
+    for (int i = 0; i < 4; i++) {
+        result[i] = wa * a[i] + wb * b[i];
+        length2 += result[i] * result[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        result[i] /= std::sqrt(length2);
+    }
+}
+
+}
+
+bool check_arc_instances(std::ostream & out)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> radius(0.25f, 1.0f);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+
+    std::vector<glm::vec3> expected;
+    std::vector<glm::vec3> evaluated;
+    ArcInstanceBatch batch;
+    float arc_error = 0.0f;
+    float half_arc_error = 0.0f;
+    bool sizes_match = true;
+
+    for (unsigned int i = 0; i < samples; i++) {
+        const float r = radius(random);
+        const glm::vec2 center(coordinate(random), coordinate(random));
+        const glm::vec3 from = random_unit(random);
+        const glm::vec3 to = random_unit(random);
+
+        expected.clear();
+        evaluated.clear();
+        batch.clear();
+        fill_arc(r, expected, from, to);
+        batch.add_arc(from, to, r, center, glm::vec3(1.0f), 1.0f);
+        evaluate_arc_instances(batch, evaluated);
+        move_to_center(expected, center);
+        sizes_match = sizes_match && expected.size() == evaluated.size();
+        if (expected.size() == evaluated.size()) {
+            arc_error = std::max(arc_error, max_distance(expected, evaluated));
+        }
+
+        const glm::vec3 axis = random_unit(random);
+        expected.clear();
+        evaluated.clear();
+        batch.clear();
+        fill_half_arc(r, expected, axis);
+        batch.add_half_arc(axis, r, center, glm::vec3(1.0f), 1.0f);
+        evaluate_arc_instances(batch, evaluated);
+        move_to_center(expected, center);
+        sizes_match = sizes_match && expected.size() == evaluated.size();
+        if (expected.size() == evaluated.size()) {
+            half_arc_error = std::max(half_arc_error, max_distance(expected, evaluated));
+        }
+    }
+
+    const bool passed = sizes_match &&
+                        arc_error <= arc_instance_tolerance &&
+                        half_arc_error <= arc_instance_tolerance;
+    out << (passed ? "passed" : "FAILED") << " arc_instances: " << samples
+        << " arcs and half arcs, max distance " << arc_error << " and " << half_arc_error
+        << ", tolerance " << arc_instance_tolerance
+        << (sizes_match ? "" : ", vertex counts differ") << std::endl;
+    return passed;
+}
+
+bool check_obj_parser(std::ostream & out)
+{
+    const unsigned int count = sizeof(obj_cases) / sizeof(obj_cases[0]);
+    unsigned int failures = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        ObjCase const & obj_case = obj_cases[i];
+        MeshData mesh;
+        char const * end = obj_case.content + std::strlen(obj_case.content);
+        const bool parsed = parse_obj(obj_case.content, end, mesh);
+        const int triangles = parsed ? static_cast<int>(mesh.indices.size() / 3) : -1;
+        if (triangles != obj_case.triangles) {
+            out << "obj_parser: content " << i << " expected " << obj_case.triangles
+                << " triangles but got " << triangles << std::endl;
+            failures++;
+        }
+    }
+
+    const bool passed = failures == 0;
+    out << (passed ? "passed" : "FAILED") << " obj_parser: " << count
+        << " contents, " << failures << " parsed wrong" << std::endl;
+    return passed;
+}
+
+bool check_batch(std::ostream & out)
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> normal;
+    auto random_orientation = [&]() {
+        return glm::normalize(glm::quat(normal(random), normal(random), normal(random), normal(random)));
+    };
+
+    // viewports overlapping the area the mouse moves in, half of the
+    // arcballs with custom axes, the rest falls back to the world axes
+    ArcballBatch batch;
+    std::vector<ArcballCore> cores;
+    std::vector<ArcballViewport> viewports;
+    batch.set_allow_constraints(true);
+    for (unsigned int i = 0; i < batch_arcballs; i++) {
+        ArcballViewport viewport;
+        viewport.x = static_cast<int>(400.0f * uniform(random));
+        viewport.y = static_cast<int>(300.0f * uniform(random));
+        viewport.width = static_cast<int>(200.0f + 600.0f * uniform(random));
+        viewport.height = static_cast<int>(200.0f + 600.0f * uniform(random));
+        const glm::vec2 center(uniform(random) - 0.5f, uniform(random) - 0.5f);
+        ConstraintAxes axes;
+        if (i % 2 == 0) {
+            const unsigned int count = 1 + i / 2 % max_constraint_axes;
+            for (unsigned int j = 0; j < count; j++) {
+                axes.push_back(random_unit(random));
+            }
+        }
+        const glm::quat orientation = random_orientation();
+
+        batch.add(orientation, viewport);
+        batch.set_center(i, center);
+        batch.set_custom_axes(i, axes);
+        cores.push_back(ArcballCore(orientation));
+        cores.back().set_allow_constraints(true);
+        cores.back().set_center(center);
+        cores.back().set_custom_axes(axes);
+        viewports.push_back(viewport);
+    }
+
+    float error = 0.0f;
+    unsigned int axis_set_mismatches = 0;
+    unsigned int nearest_mismatches = 0;
+    unsigned int updates = 0;
+    auto update = [&](ArcballInput const & input, ArcballCamera const & camera) {
+        batch.update(input, camera);
+        for (unsigned int i = 0; i < batch_arcballs; i++) {
+            cores[i].update(input, camera, viewports[i]);
+            const glm::quat a = batch.get_orientation(i);
+            const glm::quat b = cores[i].get_orientation().now;
+            error = std::max(error, std::max(
+                std::max(std::abs(a.w - b.w), std::abs(a.x - b.x)),
+                std::max(std::abs(a.y - b.y), std::abs(a.z - b.z))));
+            Constraint const & constraint = cores[i].get_constraint();
+            axis_set_mismatches += batch.get_axis_set(i) != constraint.current ? 1 : 0;
+            nearest_mismatches += batch.get_nearest(i) != constraint.nearest ? 1 : 0;
+        }
+        updates++;
+    };
+
+    // each drag hovers with random modifiers, then clicks, moves and
+    // releases, with a radius key or a reset now and then
+    ArcballInput input = ArcballInput();
+    for (unsigned int d = 0; d < batch_drags; d++) {
+        ArcballCamera camera;
+        camera.orientation = random_orientation();
+        input.shift = uniform(random) < 0.5f;
+        input.ctrl = uniform(random) < 0.5f;
+        for (unsigned int k = 0; k < 12; k++) {
+            input.position = glm::ivec2(800.0f * uniform(random), 600.0f * uniform(random));
+            input.clicked = k == 3;
+            input.released = k == 11;
+            input.down = k >= 3 && k < 11;
+            input.increase_radius = k == 0 && d % 7 == 1;
+            input.decrease_radius = k == 0 && d % 7 == 4;
+            input.reset = k == 0 && d % 50 == 49;
+            update(input, camera);
+        }
+    }
+
+    const bool passed = error <= batch_tolerance &&
+                        axis_set_mismatches == 0 &&
+                        nearest_mismatches == 0;
+    out << (passed ? "passed" : "FAILED") << " batch: " << batch_arcballs
+        << " arcballs with centers and custom axes over " << updates
+        << " updates, max difference " << error
+        << ", tolerance " << batch_tolerance
+        << ", axis set mismatches " << axis_set_mismatches
+        << ", nearest mismatches " << nearest_mismatches << std::endl;
+    return passed;
+}
+
+bool check_kernels(std::ostream & out)
+{
+    std::mt19937 random(2);
+    const KernelInputs inputs = create_kernel_inputs(random);
+    const KernelOutputs scalar = run_kernels(scalar_kernels(), inputs);
+    const glm::quat eye(inputs.eye[0], inputs.eye[1], inputs.eye[2], inputs.eye[3]);
+
+    std::uint32_t projected_ulp = 0;
+    std::uint32_t constrained_ulp = 0;
+    std::uint32_t composed_ulp = 0;
+    double slerp_error = 0.0;
+    for (unsigned int i = 0; i < kernel_samples; i++) {
+        const glm::vec3 window = window_coord(
+            inputs.viewport_x[i],
+            inputs.viewport_y[i],
+            inputs.viewport_width[i],
+            inputs.viewport_height[i],
+            glm::ivec2(inputs.mouse_x, inputs.mouse_y));
+        const glm::vec2 center(inputs.center_x[i], inputs.center_y[i]);
+        const glm::vec3 projected = ball_coord(window, center, inputs.radius[i]);
+        projected_ulp = std::max(projected_ulp, max_ulp(projected, glm::vec3(
+            scalar.projected.x[i],
+            scalar.projected.y[i],
+            scalar.projected.z[i])));
+
+        const glm::vec3 constrained = constrain_to(
+            glm::vec3(inputs.points.x[i], inputs.points.y[i], inputs.points.z[i]),
+            glm::vec3(inputs.axes.x[i], inputs.axes.y[i], inputs.axes.z[i]));
+        constrained_ulp = std::max(constrained_ulp, max_ulp(constrained, glm::vec3(
+            scalar.constrained.x[i],
+            scalar.constrained.y[i],
+            scalar.constrained.z[i])));
+
+        const glm::quat start(inputs.start.w[i], inputs.start.x[i], inputs.start.y[i], inputs.start.z[i]);
+        const glm::quat composed = glm::normalize(drag_rotation(
+            glm::vec3(inputs.from.x[i], inputs.from.y[i], inputs.from.z[i]),
+            glm::vec3(inputs.to.x[i], inputs.to.y[i], inputs.to.z[i]),
+            eye) * start);
+        composed_ulp = std::max(composed_ulp, std::max(
+            ulp_distance(composed.w, scalar.composed.w[i]),
+            max_ulp(glm::vec3(composed.x, composed.y, composed.z), glm::vec3(
+                scalar.composed.x[i],
+                scalar.composed.y[i],
+                scalar.composed.z[i]))));
+
+        const glm::quat target(inputs.target.w[i], inputs.target.x[i], inputs.target.y[i], inputs.target.z[i]);
+        double slerped[4];
+        reference_slerp(start, target, inputs.t[i], slerped);
+        slerp_error = std::max(slerp_error, angle(glm::quat(
+            scalar.slerped.w[i],
+            scalar.slerped.x[i],
+            scalar.slerped.y[i],
+            scalar.slerped.z[i]), slerped));
+    }
+
+    bool passed = projected_ulp <= kernel_ulp_tolerance &&
+                  constrained_ulp <= kernel_ulp_tolerance &&
+                  composed_ulp <= kernel_ulp_tolerance &&
+                  slerp_error <= slerp_tolerance;
+    out << (passed ? "passed" : "FAILED") << " kernels/scalar: " << kernel_samples
+        << " samples, project_to_ball " << projected_ulp
+        << " ulp, constrain_to " << constrained_ulp
+        << " ulp, drag_compose " << composed_ulp
+        << " ulp, tolerance " << kernel_ulp_tolerance
+        << " ulp, slerp " << slerp_error
+        << " rad, tolerance " << slerp_tolerance << " rad" << std::endl;
+
+    ArcballKernels const * vectorized[] = { sse2_kernels(), avx2_kernels() };
+    for (auto kernels : vectorized) {
+        if (!kernels) {
+            continue;
+        }
+        const KernelOutputs outputs = run_kernels(*kernels, inputs);
+        std::string mismatches;
+        auto compare = [&mismatches](Lanes const & a, Lanes const & b, char const * name) {
+            if (!(a == b)) {
+                mismatches += std::string(" ") + name;
+            }
+        };
+        compare(outputs.projected, scalar.projected, "project_to_ball");
+        compare(outputs.constrained, scalar.constrained, "constrain_to");
+        compare(outputs.composed, scalar.composed, "drag_compose");
+        compare(outputs.spun, scalar.spun, "spin");
+        compare(outputs.spun_velocity, scalar.spun_velocity, "spin");
+        compare(outputs.slerped, scalar.slerped, "slerp");
+
+        out << (mismatches.empty() ? "passed" : "FAILED") << " kernels/" << kernels->name
+            << ": " << kernel_samples << " samples, "
+            << (mismatches.empty() ? "bit for bit equal to scalar" : "differs from scalar in" + mismatches)
+            << std::endl;
+        passed = passed && mismatches.empty();
+    }
+
+    return passed;
+}
@@ -0,0 +1,27 @@
+#ifndef CHECKS_HPP_INCLUDED
+#define CHECKS_HPP_INCLUDED
+
+#include <ostream>
+
+// Compare the points of random arcs and half arcs evaluated from arc
+// instances against fill_arc and fill_half_arc, every point must be within
+// arc_instance_tolerance. Report to specified stream and return true if all
+// points are.
+bool check_arc_instances(std::ostream & out);
+// Parse OBJ contents with comments, relative indices and malformed lines, each
+// must give the expected number of triangles or be rejected. Report to
+// specified stream and return true if all do.
+bool check_obj_parser(std::ostream & out);
+// Update a batch of arcballs with centers and custom axes and an arcball core
+// for each from the same random drags. Every orientation must be within
+// batch_tolerance of its arcball core, and the axis set and nearest axis must
+// be the same. Report to specified stream and return true if they are.
+bool check_batch(std::ostream & out);
+// Run every available kernel set on random input. The scalar kernels must be
+// within kernel_ulp_tolerance of arcballmath and the slerp kernel within
+// slerp_tolerance radians of a double precision slerp, every other kernel
+// set must match the scalar kernels bit for bit. Report to specified stream
+// and return true if all do.
+bool check_kernels(std::ostream & out);
+
+#endif
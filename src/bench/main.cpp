@@ -0,0 +1,613 @@
+#include "benchmark.hpp"
+#include "checks.hpp"
+
+#include "arcballbatch.hpp"
+#include "arcballcore.hpp"
+#include "arcballevents.hpp"
+#include "arcballgeometry.hpp"
+#include "arcballinertia.hpp"
+#include "arcballkernels.hpp"
+#include "arcballplayback.hpp"
+#include "arccache.hpp"
+#include "arcinstances.hpp"
+#include "arcballthread.hpp"
+#include "arcballviews.hpp"
+#include "ballprojector.hpp"
+#include "profiler.hpp"
+#include "balltree.hpp"
+#include "pngwriter.hpp"
+#include "softrasterizer.hpp"
+#include "trajectorycodec.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const unsigned long iterations = 200000;
+
+const int width = 800;
+const int height = 600;
+
+// return rotation of specified angle in degrees around specified axis
+glm::quat rotation(float degrees, glm::vec3 axis)
+{
+    const float half = degrees * 3.14159265f / 360.0f;
+    return glm::quat(std::cos(half), axis * std::sin(half));
+}
+
+// return camera looking at the origin from the same direction as the demo
+ArcballCamera create_camera()
+{
+    ArcballCamera camera;
+    camera.orientation = rotation(20.0f, glm::vec3(0.0f, 1.0f, 0.0f)) *
+                         rotation(-30.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+    return camera;
+}
+
+// return synthetic input stream of an operator hovering over the arcball
+// with specified modifiers held, then clicking and dragging along a curve
+// before releasing the button
+std::vector<ArcballInput> create_input_stream(bool shift, bool ctrl)
+{
+    const int hover_samples = 64;
+    const int drag_samples = 256;
+
+    std::vector<ArcballInput> stream;
+
+    auto sample = [&](float t, bool down, bool clicked, bool released) {
+        ArcballInput input = ArcballInput();
+        input.position = glm::ivec2(
+            width / 2 + static_cast<int>(width * 0.4f * std::sin(3.0f * t)),
+            height / 2 + static_cast<int>(height * 0.4f * std::sin(2.0f * t)));
+        input.down = down;
+        input.clicked = clicked;
+        input.released = released;
+        input.shift = shift;
+        input.ctrl = ctrl;
+        stream.push_back(input);
+    };
+
+    for (int i = 0; i < hover_samples; i++) {
+        sample(i * 0.01f, false, false, false);
+    }
+    sample(hover_samples * 0.01f, true, true, false);
+    for (int i = 1; i < drag_samples; i++) {
+        sample((hover_samples + i) * 0.01f, true, false, false);
+    }
+    sample((hover_samples + drag_samples) * 0.01f, false, false, true);
+
+    return stream;
+}
+
+void bench_update(Benchmark & benchmark, std::string const & mode, bool shift, bool ctrl)
+{
+    const auto stream = create_input_stream(shift, ctrl);
+    const auto camera = create_camera();
+    const ArcballViewport viewport = { 0, 0, width, height };
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+
+    benchmark.run("update/" + mode, iterations, [&](unsigned long i) {
+        core.update(stream[i % stream.size()], camera, viewport);
+        consume(core.get_orientation().now.w);
+    });
+}
+
+// the cost of each axis set alone, hovering evaluates the constraint axes and
+// the nearest axis on every update while dragging only constrains the arc
+void bench_hover_update(Benchmark & benchmark, std::string const & mode, bool shift, bool ctrl)
+{
+    auto stream = create_input_stream(shift, ctrl);
+    stream.resize(64);
+    const auto camera = create_camera();
+    const ArcballViewport viewport = { 0, 0, width, height };
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+
+    benchmark.run("hover/" + mode, iterations, [&](unsigned long i) {
+        core.update(stream[i % stream.size()], camera, viewport);
+        consume(core.get_constraint().nearest);
+    });
+}
+
+void bench_idle_update(Benchmark & benchmark)
+{
+    const auto stream = create_input_stream(false, false);
+    const auto camera = create_camera();
+    const ArcballViewport viewport = { 0, 0, width, height };
+
+    // hovering without moving the mouse
+    const auto input = stream.front();
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+
+    benchmark.run("update/idle", iterations, [&](unsigned long) {
+        core.update(input, camera, viewport);
+        consume(core.changed());
+    });
+}
+
+void bench_batch_update(Benchmark & benchmark, unsigned int count)
+{
+    const auto stream = create_input_stream(false, false);
+    const auto camera = create_camera();
+
+    ArcballBatch batch;
+    batch.reserve(count);
+    for (unsigned int i = 0; i < count; i++) {
+        const ArcballViewport viewport = { 0, 0, width, height };
+        batch.add(glm::quat(), viewport);
+    }
+
+    benchmark.run("batch_update/" + std::to_string(count), iterations / count + 1, [&](unsigned long i) {
+        batch.update(stream[i % stream.size()], camera);
+        consume(batch.get_orientation(0).w);
+    });
+}
+
+void bench_event_queue(Benchmark & benchmark)
+{
+    // a 8 kHz mouse with 60 frames per second
+    const unsigned int events_per_frame = 8000 / 60;
+
+    const auto stream = create_input_stream(false, false);
+    const auto camera = create_camera();
+    const ArcballViewport viewport = { 0, 0, width, height };
+
+    ArcballEventQueue events;
+
+    benchmark.run("event_queue/motion", iterations, [&](unsigned long i) {
+        events.motion(stream[i % stream.size()].position);
+        consume(events.size());
+    });
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+
+    events.clear();
+    events.button(true);
+
+    benchmark.run("event_queue/frame_" + std::to_string(events_per_frame), iterations / events_per_frame + 1, [&](unsigned long i) {
+        for (unsigned int j = 0; j < events_per_frame; j++) {
+            events.motion(stream[(i * events_per_frame + j) % stream.size()].position);
+        }
+        core.update(events.data(), events.size(), camera, viewport);
+        events.clear();
+        consume(core.get_orientation().now.w);
+    });
+}
+
+void bench_thread(Benchmark & benchmark)
+{
+    const auto stream = create_input_stream(false, false);
+    const auto camera = create_camera();
+    const ArcballViewport viewport = { 0, 0, width, height };
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+    ArcballThread thread(core);
+
+    // the cost paid by the render thread, submitting input and picking up
+    // the newest arcball without waiting for the input thread
+    benchmark.run("thread/submit_fetch", iterations, [&](unsigned long i) {
+        thread.submit(stream[i % stream.size()], camera, viewport);
+        thread.fetch(core);
+        consume(core.get_orientation().now.w);
+    });
+}
+
+void bench_inertia(Benchmark & benchmark, unsigned int count)
+{
+    ArcballInertia inertia(0.0f);
+    for (unsigned int i = 0; i < count; i++) {
+        inertia.spin(i, glm::quat(), glm::vec3(std::sin(i * 0.37f), std::cos(i * 0.23f), 1.0f));
+    }
+
+    // a frame of a 60 Hz display is two steps, without damping nothing
+    // comes to rest
+    benchmark.run("inertia/advance_" + std::to_string(count), iterations / count + 1, [&](unsigned long) {
+        inertia.advance(1.0f / 60.0f);
+        consume(inertia.get_orientation(0).w);
+    });
+}
+
+void bench_playback(Benchmark & benchmark, unsigned int count, Interpolation interpolation)
+{
+    // every arcball plays its own looping track of a second of keyframes,
+    // each at its own time
+    ArcballPlayback playback;
+    for (unsigned int i = 0; i < count; i++) {
+        auto track = std::make_shared<OrientationTrack>(interpolation);
+        for (unsigned int k = 0; k < 16; k++) {
+            const glm::vec3 axis = glm::normalize(glm::vec3(std::sin(i * 0.37f + k), std::cos(i * 0.23f), 1.0f));
+            const float half = k * 0.15f;
+            track->add(k / 15.0f, glm::quat(std::cos(half), axis * std::sin(half)));
+        }
+        playback.play(i, track, i * 0.001f, true);
+    }
+
+    char const * name = interpolation == Interpolation::SLERP ? "slerp" : "squad";
+    benchmark.run("playback/" + std::string(name) + "_" + std::to_string(count), iterations / count + 1, [&](unsigned long) {
+        playback.advance(1.0f / 60.0f);
+        consume(playback.get_orientation(0).w);
+    });
+}
+
+void bench_views(Benchmark & benchmark, unsigned int count)
+{
+    // the demo grid of views, each looking at the origin from another side,
+    // the drag passes through several of them and the others follow it
+    const auto stream = create_input_stream(true, true);
+    const unsigned int columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(count))));
+
+    std::vector<ArcballView> views(count);
+    for (unsigned int i = 0; i < count; i++) {
+        views[i].camera.orientation = rotation(20.0f + i * 360.0f / count, glm::vec3(0.0f, 1.0f, 0.0f)) *
+                                      rotation(-30.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+        views[i].viewport = { static_cast<int>(i % columns) * width / static_cast<int>(columns),
+                              static_cast<int>(i / columns) * height / static_cast<int>(columns),
+                              width / static_cast<int>(columns),
+                              height / static_cast<int>(columns) };
+        views[i].center = glm::vec2(0.0f);
+    }
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+    ArcballViews arcball_views;
+    arcball_views.set_views(views, core.get_radius());
+
+    benchmark.run("views/update_" + std::to_string(count), iterations / count + 1, [&](unsigned long i) {
+        auto const & input = stream[i % stream.size()];
+        arcball_views.route(input, core.is_dragging());
+        auto const & view = arcball_views.get_view(arcball_views.get_active());
+        core.update(input, view.camera, view.viewport);
+        arcball_views.follow(core, core.get_orientation().now, input);
+        consume(core.get_orientation().now.w);
+    });
+}
+
+void bench_profiler(Benchmark & benchmark)
+{
+    // the cost of a single timed scope when profiling is built in
+    benchmark.run("profile_scope", iterations, [&](unsigned long i) {
+        ProfileScope scope("bench");
+        consume(i);
+    });
+}
+
+void bench_nearest_constraint(Benchmark & benchmark)
+{
+    const auto camera = create_camera();
+    const glm::quat inv = glm::conjugate(camera.orientation);
+    const glm::vec3 axes[3] = {
+        inv * glm::vec3(1.0f, 0.0f, 0.0f),
+        inv * glm::vec3(0.0f, 1.0f, 0.0f),
+        inv * glm::vec3(0.0f, 0.0f, 1.0f)
+    };
+
+    std::vector<glm::vec3> points;
+    for (int i = 0; i < 1024; i++) {
+        points.push_back(ball_coord(glm::vec3(std::sin(i * 0.37f), std::cos(i * 0.23f), 0.0f), 0.75f));
+    }
+
+    benchmark.run("nearest_constraint", iterations, [&](unsigned long i) {
+        consume(nearest_constraint(points[i % points.size()], axes, 3));
+    });
+}
+
+void bench_geometry(Benchmark & benchmark)
+{
+    std::vector<glm::vec3> positions;
+    positions.reserve(256);
+
+    benchmark.run("fill_circle", iterations, [&](unsigned long) {
+        positions.clear();
+        fill_circle(0.75f, positions);
+        consume(positions.back().x);
+    });
+
+    benchmark.run("fill_arc", iterations, [&](unsigned long i) {
+        const float t = (i % 1024) * 0.001f;
+        positions.clear();
+        fill_arc(0.75f, positions, glm::vec3(0.0f, 0.0f, 1.0f), glm::normalize(glm::vec3(t, 0.5f, 0.5f)));
+        consume(positions.back().x);
+    });
+
+    benchmark.run("fill_half_arc", iterations, [&](unsigned long i) {
+        const float t = (i % 1024) * 0.001f;
+        positions.clear();
+        fill_half_arc(0.75f, positions, glm::normalize(glm::vec3(1.0f, t, 0.25f)));
+        consume(positions.back().x);
+    });
+
+    // the same axis every update as when the constraint axes are unchanged
+    ArcCache cache;
+    const glm::vec3 axis = glm::normalize(glm::vec3(1.0f, 0.5f, 0.25f));
+    benchmark.run("fill_half_arc/cached", iterations, [&](unsigned long) {
+        positions.clear();
+        cache.fill_half_arc(0.75f, positions, axis);
+        consume(positions.back().x);
+    });
+
+    // packing the parameters of the same half arc for the arc shader
+    ArcInstanceBatch batch;
+    batch.reserve(2);
+    benchmark.run("add_half_arc/instanced", iterations, [&](unsigned long i) {
+        const float t = (i % 1024) * 0.001f;
+        batch.clear();
+        batch.add_half_arc(glm::normalize(glm::vec3(1.0f, t, 0.25f)), 0.75f, glm::vec2(0.0f), glm::vec3(1.0f), 1.0f);
+        consume(batch.data()->from.x);
+    });
+}
+
+void bench_ball_pick(Benchmark & benchmark, unsigned int count)
+{
+    // objects scattered in front of an eye looking down the negative z-axis
+    std::vector<glm::vec3> positions;
+    std::vector<float> radii;
+    for (unsigned int i = 0; i < count; i++) {
+        positions.push_back(glm::vec3(
+            20.0f * std::sin(i * 0.37f),
+            15.0f * std::cos(i * 0.23f),
+            -30.0f - 20.0f * std::sin(i * 0.11f)));
+        radii.push_back(0.01f + 0.02f * (i % 7) / 7.0f);
+    }
+
+    glm::mat4 projection(0.0f);
+    projection[0][0] = 1.0f;
+    projection[1][1] = 1.0f;
+    projection[2][2] = -1.0f;
+    projection[2][3] = -1.0f;
+    projection[3][2] = -0.2f;
+
+    // return view of an eye strafing sideways
+    auto view = [](unsigned long i) {
+        glm::mat4 matrix(1.0f);
+        matrix[3][0] = 0.01f * (i % 64);
+        return matrix;
+    };
+
+    BallProjector projector;
+    projector.set_eye(view(0), projection);
+
+    std::vector<BallDisc> discs;
+    discs.reserve(count);
+    const std::string suffix = "/" + std::to_string(count);
+    const unsigned long rebuild_iterations = iterations / count + 4;
+
+    benchmark.run("ball_project" + suffix, rebuild_iterations, [&](unsigned long) {
+        projector.project(positions.data(), radii.data(), count, discs);
+        consume(discs.back().center.x);
+    });
+
+    const auto stream = create_input_stream(false, false);
+    const ArcballViewport viewport = { 0, 0, width, height };
+    std::vector<glm::vec2> clicks;
+    for (auto const & input : stream) {
+        const auto window = window_coord(viewport.x, viewport.y, viewport.width, viewport.height, input.position);
+        clicks.push_back(glm::vec2(window.x, window.y));
+    }
+
+    BallTree tree;
+    benchmark.run("ball_tree_build" + suffix, rebuild_iterations, [&](unsigned long) {
+        tree.build(discs);
+        consume(tree.pick(clicks.front()));
+    });
+
+    // the eye moves every frame so the discs move and the tree is refitted
+    const unsigned int builds = tree.get_builds();
+    benchmark.run("ball_tree_update" + suffix, rebuild_iterations, [&](unsigned long i) {
+        projector.set_eye(view(i + 1), projection);
+        projector.project(positions.data(), radii.data(), count, discs);
+        tree.update(discs);
+        consume(tree.pick(clicks.front()));
+    });
+    benchmark.add_context("ball_tree_rebuilds" + suffix, std::to_string(tree.get_builds() - builds));
+
+    benchmark.run("ball_tree_pick" + suffix, iterations, [&](unsigned long i) {
+        consume(tree.pick(clicks[i % clicks.size()]));
+    });
+
+    // the reference the ball tree replaces
+    benchmark.run("ball_linear_pick" + suffix, rebuild_iterations, [&](unsigned long i) {
+        const glm::vec2 click = clicks[i % clicks.size()];
+        int picked = -1;
+        for (unsigned int j = 0; j < count; j++) {
+            const glm::vec2 offset = click - discs[j].center;
+            const bool inside = glm::dot(offset, offset) <= discs[j].radius * discs[j].radius;
+            if (inside && discs[j].depth > 0.0f && (picked < 0 || discs[j].depth < discs[picked].depth)) {
+                picked = j;
+            }
+        }
+        consume(picked);
+    });
+}
+
+// return sphere of specified radius with about as many triangles as the
+// suzanne model
+MeshData create_sphere(float radius)
+{
+    const unsigned int rings = 64;
+    const unsigned int segments = 124;
+
+    MeshData mesh;
+    for (unsigned int ring = 0; ring <= rings; ring++) {
+        const float theta = 3.14159265f * ring / rings;
+        for (unsigned int segment = 0; segment <= segments; segment++) {
+            const float phi = 2.0f * 3.14159265f * segment / segments;
+            const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi));
+            mesh.positions.push_back(normal * radius);
+            mesh.normals.push_back(normal);
+        }
+    }
+    for (unsigned int ring = 0; ring < rings; ring++) {
+        for (unsigned int segment = 0; segment < segments; segment++) {
+            const unsigned int a = ring * (segments + 1) + segment;
+            const unsigned int b = a + segments + 1;
+            const unsigned int corners[6] = { a, b, a + 1, a + 1, b, b + 1 };
+            mesh.indices.insert(mesh.indices.end(), corners, corners + 6);
+        }
+    }
+    return mesh;
+}
+
+void bench_rasterizer(Benchmark & benchmark, unsigned int threads)
+{
+    const unsigned long frames = 50;
+    const MeshData mesh = create_sphere(1.2f);
+
+    glm::mat4 model_view(1.0f);
+    model_view[3][2] = -4.2f;
+    glm::mat4 projection(0.0f);
+    projection[0][0] = 1.81f;
+    projection[1][1] = 2.41f;
+    projection[2][2] = -1.0f;
+    projection[2][3] = -1.0f;
+    projection[3][2] = -0.2f;
+
+    RasterMaterial material = { glm::vec3(1.2f), glm::vec3(0.8f), glm::vec3(1.0f), glm::vec3(0.0f), 21.0f };
+    RasterLight light = { glm::vec3(1.8f, 1.2f, -3.2f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f), 1.0f, 0.5f, 0.03f };
+    std::vector<RasterLight> lights(2, light);
+    lights[1].position = glm::vec3(-2.0f, 1.2f, -2.2f);
+    lights[1].diffuse = glm::vec3(1.0f, 0.0f, 0.0f);
+
+    std::vector<glm::vec3> rim;
+    fill_circle(0.75f, rim);
+
+    SoftRasterizer rasterizer(width, height, threads);
+    std::vector<unsigned char> rgb;
+    const std::string suffix = "/threads_" + std::to_string(rasterizer.get_threads());
+
+    benchmark.run("raster_frame" + suffix, frames, [&](unsigned long) {
+        rasterizer.clear(glm::vec3(0.0f));
+        rasterizer.draw_mesh(mesh, model_view, projection, material, lights);
+        rasterizer.draw_lines(rim, glm::mat4(1.0f), true, glm::vec3(0.3f), 0.4f);
+        rasterizer.read_pixels(rgb);
+        consume(rgb[rgb.size() / 2]);
+    });
+
+    if (threads == 1) {
+        std::vector<unsigned char> png;
+        benchmark.run("png_encode", frames / 5, [&](unsigned long) {
+            encode_png(width, height, rgb, png);
+            consume(png.size());
+        });
+    }
+}
+
+}
+
+// the orientations of a session dragging with every axis set in turn, the
+// reciprocal of the time per orientation is the number of samples per second
+void bench_trajectory(Benchmark & benchmark)
+{
+    const auto camera = create_camera();
+    const ArcballViewport viewport = { 0, 0, width, height };
+
+    ArcballCore core;
+    core.set_allow_constraints(true);
+
+    std::vector<glm::quat> orientations;
+    for (int pass = 0; orientations.size() < iterations; pass++) {
+        for (auto const & input : create_input_stream(pass & 1, pass & 2)) {
+            core.update(input, camera, viewport);
+            if (core.changed()) {
+                orientations.push_back(core.get_orientation().now);
+            }
+        }
+    }
+
+    TrajectoryEncoder encoder;
+    std::vector<char> content;
+    benchmark.run("trajectory/encode", orientations.size(), [&](unsigned long i) {
+        if (i == 0) {
+            content.clear();
+            encoder.begin(content);
+        }
+        encoder.append(orientations[i], content);
+        if (i + 1 == orientations.size()) {
+            encoder.end(content);
+        }
+    });
+
+    TrajectoryReader reader;
+    reader.open(content.data(), content.data() + content.size());
+    benchmark.run("trajectory/decode", orientations.size(), [&](unsigned long i) {
+        glm::quat orientation;
+        if (i == 0) {
+            reader.seek(0);
+        }
+        reader.read(&orientation, 1);
+        consume(orientation.w);
+    });
+
+    benchmark.run("trajectory/seek", iterations / 10, [&](unsigned long i) {
+        glm::quat orientation;
+        reader.seek(i * 7919 % orientations.size());
+        reader.read(&orientation, 1);
+        consume(orientation.w);
+    });
+}
+
+// Run all benchmarks and write the results as JSON to the file given as the
+// first argument, or to standard output if there is none. When started with
+// --check the accuracy checks are run instead, the exit status is nonzero if
+// any of them fails.
+int main(int argc, char * argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "--check") == 0) {
+        bool passed = true;
+        passed = check_arc_instances(std::cout) && passed;
+        passed = check_kernels(std::cout) && passed;
+        passed = check_batch(std::cout) && passed;
+        passed = check_obj_parser(std::cout) && passed;
+        return passed ? 0 : 1;
+    }
+
+    Benchmark benchmark;
+    benchmark.add_context("kernels", arcball_kernels().name);
+
+    bench_update(benchmark, "none", false, false);
+    bench_update(benchmark, "camera", true, false);
+    bench_update(benchmark, "body", false, true);
+    bench_update(benchmark, "world", true, true);
+    bench_hover_update(benchmark, "none", false, false);
+    bench_hover_update(benchmark, "camera", true, false);
+    bench_hover_update(benchmark, "body", false, true);
+    bench_hover_update(benchmark, "world", true, true);
+    bench_idle_update(benchmark);
+    bench_batch_update(benchmark, 1024);
+    bench_event_queue(benchmark);
+    bench_thread(benchmark);
+    bench_inertia(benchmark, 10000);
+    bench_playback(benchmark, 4096, Interpolation::SLERP);
+    bench_playback(benchmark, 4096, Interpolation::SQUAD);
+    bench_views(benchmark, 16);
+    bench_profiler(benchmark);
+    bench_nearest_constraint(benchmark);
+    bench_geometry(benchmark);
+    bench_ball_pick(benchmark, 10000);
+    bench_ball_pick(benchmark, 100000);
+    bench_rasterizer(benchmark, 1);
+    bench_rasterizer(benchmark, 0);
+    bench_trajectory(benchmark);
+
+    if (argc > 1) {
+        std::ofstream out(argv[1]);
+        if (!out) {
+            std::cerr << "unable to open " << argv[1] << std::endl;
+            return 1;
+        }
+        benchmark.write_json(out);
+    } else {
+        benchmark.write_json(std::cout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,481 @@
+#include "arcballbatch.hpp"
+
+#include <algorithm>
+
+ArcballBatch::ArcballBatch()
+    : kernels(&arcball_kernels()),
+      allow_constraints(false),
+      dragging(false),
+      axis_set(AxisSet::NONE),
+      custom_count(0)
+{
+}
+
+unsigned int ArcballBatch::add(glm::quat orientation, ArcballViewport const & viewport)
+{
+    const glm::quat q = orientation;
+
+    viewport_x.push_back(viewport.x);
+    viewport_y.push_back(viewport.y);
+    viewport_width.push_back(viewport.width);
+    viewport_height.push_back(viewport.height);
+    center_x.push_back(0.0f);
+    center_y.push_back(0.0f);
+    radius.push_back(0.75f);
+
+    from_x.push_back(0.0f);
+    from_y.push_back(0.0f);
+    from_z.push_back(0.0f);
+    to_x.push_back(0.0f);
+    to_y.push_back(0.0f);
+    to_z.push_back(0.0f);
+
+    reset_w.push_back(q.w);
+    reset_x.push_back(q.x);
+    reset_y.push_back(q.y);
+    reset_z.push_back(q.z);
+    start_w.push_back(q.w);
+    start_x.push_back(q.x);
+    start_y.push_back(q.y);
+    start_z.push_back(q.z);
+    now_w.push_back(q.w);
+    now_x.push_back(q.x);
+    now_y.push_back(q.y);
+    now_z.push_back(q.z);
+
+    for (int j = 0; j < 3; j++) {
+        axis_x[j].push_back(0.0f);
+        axis_y[j].push_back(0.0f);
+        axis_z[j].push_back(0.0f);
+    }
+    custom_axes.push_back(ConstraintAxes());
+    custom_available.push_back(ConstraintAxes());
+    nearest.push_back(0);
+    selected_x.push_back(0.0f);
+    selected_y.push_back(0.0f);
+    selected_z.push_back(0.0f);
+
+    return size() - 1;
+}
+
+void ArcballBatch::clear()
+{
+    viewport_x.clear();
+    viewport_y.clear();
+    viewport_width.clear();
+    viewport_height.clear();
+    center_x.clear();
+    center_y.clear();
+    radius.clear();
+    from_x.clear();
+    from_y.clear();
+    from_z.clear();
+    to_x.clear();
+    to_y.clear();
+    to_z.clear();
+    reset_w.clear();
+    reset_x.clear();
+    reset_y.clear();
+    reset_z.clear();
+    start_w.clear();
+    start_x.clear();
+    start_y.clear();
+    start_z.clear();
+    now_w.clear();
+    now_x.clear();
+    now_y.clear();
+    now_z.clear();
+    for (int j = 0; j < 3; j++) {
+        axis_x[j].clear();
+        axis_y[j].clear();
+        axis_z[j].clear();
+    }
+    custom_axes.clear();
+    custom_available.clear();
+    custom_count = 0;
+    nearest.clear();
+    selected_x.clear();
+    selected_y.clear();
+    selected_z.clear();
+}
+
+void ArcballBatch::reserve(unsigned int capacity)
+{
+    viewport_x.reserve(capacity);
+    viewport_y.reserve(capacity);
+    viewport_width.reserve(capacity);
+    viewport_height.reserve(capacity);
+    center_x.reserve(capacity);
+    center_y.reserve(capacity);
+    radius.reserve(capacity);
+    from_x.reserve(capacity);
+    from_y.reserve(capacity);
+    from_z.reserve(capacity);
+    to_x.reserve(capacity);
+    to_y.reserve(capacity);
+    to_z.reserve(capacity);
+    reset_w.reserve(capacity);
+    reset_x.reserve(capacity);
+    reset_y.reserve(capacity);
+    reset_z.reserve(capacity);
+    start_w.reserve(capacity);
+    start_x.reserve(capacity);
+    start_y.reserve(capacity);
+    start_z.reserve(capacity);
+    now_w.reserve(capacity);
+    now_x.reserve(capacity);
+    now_y.reserve(capacity);
+    now_z.reserve(capacity);
+    for (int j = 0; j < 3; j++) {
+        axis_x[j].reserve(capacity);
+        axis_y[j].reserve(capacity);
+        axis_z[j].reserve(capacity);
+    }
+    custom_axes.reserve(capacity);
+    custom_available.reserve(capacity);
+    nearest.reserve(capacity);
+    selected_x.reserve(capacity);
+    selected_y.reserve(capacity);
+    selected_z.reserve(capacity);
+}
+
+// the stages mirror Arcball::update but each stage runs over every arcball
+// before the next stage begins
+void ArcballBatch::update(ArcballInput const & input, ArcballCamera const & camera)
+{
+    update_button(input);
+    update_key(input);
+    update_ball_points(input);
+
+    if (!dragging) {
+        update_current_axis_set(input);
+        update_constraint_axes(camera);
+        update_nearest();
+    }
+
+    if (dragging) {
+        update_drag_arcs(camera);
+    }
+}
+
+void ArcballBatch::set_viewport(unsigned int index, ArcballViewport const & viewport)
+{
+    viewport_x[index] = viewport.x;
+    viewport_y[index] = viewport.y;
+    viewport_width[index] = viewport.width;
+    viewport_height[index] = viewport.height;
+}
+
+void ArcballBatch::set_center(unsigned int index, glm::vec2 center)
+{
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+}
+
+// normalized as in ArcballCore, constraining assumes unit axes
+bool ArcballBatch::set_custom_axes(unsigned int index, ConstraintAxes const & axes)
+{
+    ConstraintAxes normalized;
+    for (auto const & axis : axes) {
+        if (!(glm::dot(axis, axis) > 0.0f)) {
+            return false;
+        }
+        normalized.push_back(glm::normalize(axis));
+    }
+
+    custom_count -= custom_axes[index].empty() ? 0 : 1;
+    custom_count += normalized.empty() ? 0 : 1;
+    custom_axes[index] = normalized;
+    return true;
+}
+
+void ArcballBatch::set_allow_constraints(bool allow_constraints)
+{
+    this->allow_constraints = allow_constraints;
+}
+
+unsigned int ArcballBatch::size() const
+{
+    return now_w.size();
+}
+
+glm::quat ArcballBatch::get_orientation(unsigned int index) const
+{
+    return glm::quat(now_w[index], now_x[index], now_y[index], now_z[index]);
+}
+
+Arc ArcballBatch::get_drag(unsigned int index) const
+{
+    Arc drag;
+    drag.from = glm::vec3(from_x[index], from_y[index], from_z[index]);
+    drag.to = glm::vec3(to_x[index], to_y[index], to_z[index]);
+    return drag;
+}
+
+Arc ArcballBatch::get_result(unsigned int index) const
+{
+    // only needed for presentation so it is computed on demand
+    return result_arc(glm::quat(start_w[index], start_x[index], start_y[index], start_z[index]));
+}
+
+unsigned int ArcballBatch::get_nearest(unsigned int index) const
+{
+    return nearest[index];
+}
+
+AxisSet ArcballBatch::get_axis_set() const
+{
+    return axis_set;
+}
+
+AxisSet ArcballBatch::get_axis_set(unsigned int index) const
+{
+    if (axis_set == AxisSet::CUSTOM && !uses_custom_axes(index)) {
+        return AxisSet::WORLD;
+    }
+    return axis_set;
+}
+
+bool ArcballBatch::is_dragging() const
+{
+    return dragging;
+}
+
+void ArcballBatch::update_button(ArcballInput const & input)
+{
+    dragging = input.down;
+
+    if (input.clicked) {
+        // begin drag
+        mouse_position_start = input.position;
+    } else if (input.released) {
+        // end drag
+        start_w = now_w;
+        start_x = now_x;
+        start_y = now_y;
+        start_z = now_z;
+    }
+}
+
+void ArcballBatch::update_key(ArcballInput const & input)
+{
+    const unsigned int n = size();
+
+    float step = 0.0f;
+    if (input.increase_radius) {
+        step = 0.25f;
+    } else if (input.decrease_radius) {
+        step = -0.25f;
+    }
+
+    if (step != 0.0f) {
+        for (unsigned int i = 0; i < n; i++) {
+            radius[i] = glm::clamp(radius[i] + step, 0.25f, 1.0f);
+        }
+    }
+
+    if (input.reset) {
+        start_w = now_w = reset_w;
+        start_x = now_x = reset_x;
+        start_y = now_y = reset_y;
+        start_z = now_z = reset_z;
+    }
+}
+
+void ArcballBatch::update_current_axis_set(ArcballInput const & input)
+{
+    const bool shift = input.shift;
+    const bool ctrl = input.ctrl;
+
+    if (allow_constraints && ctrl && shift) {
+        axis_set = custom_count == 0 ? AxisSet::WORLD : AxisSet::CUSTOM;
+    } else if (allow_constraints && ctrl) {
+        axis_set = AxisSet::BODY;
+    } else if (allow_constraints && shift) {
+        axis_set = AxisSet::CAMERA;
+    } else {
+        axis_set = AxisSet::NONE;
+    }
+}
+
+void ArcballBatch::update_ball_points(ArcballInput const & input)
+{
+    const glm::ivec2 mouse_position = input.position;
+
+    kernels->project_to_ball(
+        size(),
+        mouse_position_start.x,
+        mouse_position_start.y,
+        viewport_x.data(),
+        viewport_y.data(),
+        viewport_width.data(),
+        viewport_height.data(),
+        center_x.data(),
+        center_y.data(),
+        radius.data(),
+        from_x.data(),
+        from_y.data(),
+        from_z.data());
+    kernels->project_to_ball(
+        size(),
+        mouse_position.x,
+        mouse_position.y,
+        viewport_x.data(),
+        viewport_y.data(),
+        viewport_width.data(),
+        viewport_height.data(),
+        center_x.data(),
+        center_y.data(),
+        radius.data(),
+        to_x.data(),
+        to_y.data(),
+        to_z.data());
+}
+
+void ArcballBatch::update_constraint_axes(ArcballCamera const & camera)
+{
+    const unsigned int n = size();
+    const glm::quat inv = glm::conjugate(camera.orientation);
+    const std::array<glm::vec3, 3> units = {{
+        glm::vec3(1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f)
+    }};
+
+    // the axes are the columns of the combined rotation as in ArcballCore
+    switch (axis_set) {
+    case AxisSet::BODY:
+        for (unsigned int i = 0; i < n; i++) {
+            const glm::mat3 rotation = glm::mat3_cast(inv * get_orientation(i));
+            for (int j = 0; j < 3; j++) {
+                axis_x[j][i] = rotation[j].x;
+                axis_y[j][i] = rotation[j].y;
+                axis_z[j][i] = rotation[j].z;
+            }
+        }
+        break;
+    case AxisSet::CAMERA:
+    case AxisSet::WORLD:
+    case AxisSet::CUSTOM:
+        // identical for every arcball, arcballs without custom axes keep
+        // the world axes in a custom set
+        for (int j = 0; j < 3; j++) {
+            glm::vec3 axis = axis_set == AxisSet::CAMERA ? units[j] : glm::mat3_cast(inv)[j];
+            std::fill(axis_x[j].begin(), axis_x[j].end(), axis.x);
+            std::fill(axis_y[j].begin(), axis_y[j].end(), axis.y);
+            std::fill(axis_z[j].begin(), axis_z[j].end(), axis.z);
+        }
+        break;
+    case AxisSet::NONE:
+        break;
+    }
+
+    // the custom axes are brought into eye space by the same rotation as the
+    // world axes, an arcball without them is left with none available
+    if (axis_set == AxisSet::CUSTOM) {
+        const glm::mat3 frame = glm::mat3_cast(inv);
+        for (unsigned int i = 0; i < n; i++) {
+            custom_available[i].clear();
+            for (auto axis : custom_axes[i]) {
+                custom_available[i].push_back(frame * axis);
+            }
+        }
+    }
+}
+
+void ArcballBatch::update_nearest()
+{
+    const unsigned int n = size();
+
+    if (axis_set == AxisSet::NONE) {
+        std::fill(nearest.begin(), nearest.end(), 0);
+        return;
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+        const glm::vec3 ball_point(to_x[i], to_y[i], to_z[i]);
+        if (uses_custom_axes(i)) {
+            nearest[i] = nearest_constraint(ball_point, custom_available[i].data(), custom_available[i].size());
+            continue;
+        }
+        const glm::vec3 axes[3] = {
+            glm::vec3(axis_x[0][i], axis_y[0][i], axis_z[0][i]),
+            glm::vec3(axis_x[1][i], axis_y[1][i], axis_z[1][i]),
+            glm::vec3(axis_x[2][i], axis_y[2][i], axis_z[2][i])
+        };
+        nearest[i] = nearest_constraint(ball_point, axes, 3);
+    }
+}
+
+// the available custom axes are kept while dragging, as the constraint axes
+// of ArcballCore are, even if the custom axes are changed meanwhile
+bool ArcballBatch::uses_custom_axes(unsigned int index) const
+{
+    return axis_set == AxisSet::CUSTOM && !custom_available[index].empty();
+}
+
+void ArcballBatch::update_drag_arcs(ArcballCamera const & camera)
+{
+    const unsigned int n = size();
+
+    if (axis_set != AxisSet::NONE) {
+        for (unsigned int i = 0; i < n; i++) {
+            const unsigned int j = nearest[i];
+            if (uses_custom_axes(i)) {
+                selected_x[i] = custom_available[i][j].x;
+                selected_y[i] = custom_available[i][j].y;
+                selected_z[i] = custom_available[i][j].z;
+                continue;
+            }
+            selected_x[i] = axis_x[j][i];
+            selected_y[i] = axis_y[j][i];
+            selected_z[i] = axis_z[j][i];
+        }
+        kernels->constrain_to(
+            n,
+            from_x.data(),
+            from_y.data(),
+            from_z.data(),
+            selected_x.data(),
+            selected_y.data(),
+            selected_z.data(),
+            from_x.data(),
+            from_y.data(),
+            from_z.data());
+        kernels->constrain_to(
+            n,
+            to_x.data(),
+            to_y.data(),
+            to_z.data(),
+            selected_x.data(),
+            selected_y.data(),
+            selected_z.data(),
+            to_x.data(),
+            to_y.data(),
+            to_z.data());
+    }
+
+    const float eye_orientation[4] = {
+        camera.orientation.w,
+        camera.orientation.x,
+        camera.orientation.y,
+        camera.orientation.z
+    };
+    kernels->drag_compose(
+        n,
+        from_x.data(),
+        from_y.data(),
+        from_z.data(),
+        to_x.data(),
+        to_y.data(),
+        to_z.data(),
+        eye_orientation,
+        start_w.data(),
+        start_x.data(),
+        start_y.data(),
+        start_z.data(),
+        now_w.data(),
+        now_x.data(),
+        now_y.data(),
+        now_z.data());
+}
@@ -0,0 +1,124 @@
+#ifndef ARCBALLBATCH_HPP_INCLUDED
+#define ARCBALLBATCH_HPP_INCLUDED
+
+#include "arcballinput.hpp"
+#include "arcballkernels.hpp"
+#include "arcballmath.hpp"
+#include "constraintaxes.hpp"
+
+#include <array>
+#include <vector>
+
+// The responsibility of this class is to compute the orientation of many
+// virtual arcballs, each with its own viewport, in a single pass. State is
+// kept in structure-of-arrays form and every arcball gives the same result as
+// an ArcballCore updated with the same input, camera and viewport, and with
+// the same center and custom axes, within the tolerance documented in
+// arcballkernels.
+class ArcballBatch {
+public:
+    // Construct empty arcball batch.
+    ArcballBatch();
+    // Add arcball with specified initial orientation inside specified
+    // viewport, return index of the added arcball.
+    unsigned int add(glm::quat orientation, ArcballViewport const & viewport);
+    // Remove all arcballs.
+    void clear();
+    // Reserve storage for specified number of arcballs.
+    void reserve(unsigned int capacity);
+    // Update all arcballs from specified input and camera.
+    void update(ArcballInput const & input, ArcballCamera const & camera);
+    // Set viewport of arcball at specified index.
+    void set_viewport(unsigned int index, ArcballViewport const & viewport);
+    // Set center of the ball of arcball at specified index in window
+    // coordinates. The default is the center of the viewport.
+    void set_center(unsigned int index, glm::vec2 center);
+    // Set custom world space axes of arcball at specified index, they
+    // replace the world axes of that arcball when constraining. Return false
+    // if any axis has zero length, the axes are then left unchanged.
+    bool set_custom_axes(unsigned int index, ConstraintAxes const & axes);
+    // Set enable/disable if orientations can be locked and manipulated on a
+    // specific axis.
+    void set_allow_constraints(bool allow_constraints);
+    // Return number of arcballs.
+    unsigned int size() const;
+    // Return current orientation of arcball at specified index.
+    glm::quat get_orientation(unsigned int index) const;
+    // Return drag arc of arcball at specified index.
+    Arc get_drag(unsigned int index) const;
+    // Return result arc of arcball at specified index.
+    Arc get_result(unsigned int index) const;
+    // Return nearest constraint axis index of arcball at specified index.
+    unsigned int get_nearest(unsigned int index) const;
+    // Return current axis set shared by all arcballs, it is custom if any
+    // arcball has custom axes.
+    AxisSet get_axis_set() const;
+    // Return current axis set of arcball at specified index.
+    AxisSet get_axis_set(unsigned int index) const;
+    // Return true if arcballs are being dragged.
+    bool is_dragging() const;
+private:
+    void update_button(ArcballInput const & input);
+    void update_key(ArcballInput const & input);
+    void update_current_axis_set(ArcballInput const & input);
+    void update_ball_points(ArcballInput const & input);
+    void update_constraint_axes(ArcballCamera const & camera);
+    void update_nearest();
+    bool uses_custom_axes(unsigned int index) const;
+    void update_drag_arcs(ArcballCamera const & camera);
+
+    ArcballKernels const * kernels;
+
+    // shared by every arcball since they are driven by the same input
+    bool allow_constraints;
+    bool dragging;
+    AxisSet axis_set;
+    glm::ivec2 mouse_position_start;
+    // number of arcballs with custom axes
+    unsigned int custom_count;
+
+    std::vector<float> viewport_x;
+    std::vector<float> viewport_y;
+    std::vector<float> viewport_width;
+    std::vector<float> viewport_height;
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> radius;
+
+    std::vector<float> from_x;
+    std::vector<float> from_y;
+    std::vector<float> from_z;
+    std::vector<float> to_x;
+    std::vector<float> to_y;
+    std::vector<float> to_z;
+
+    std::vector<float> reset_w;
+    std::vector<float> reset_x;
+    std::vector<float> reset_y;
+    std::vector<float> reset_z;
+    std::vector<float> start_w;
+    std::vector<float> start_x;
+    std::vector<float> start_y;
+    std::vector<float> start_z;
+    std::vector<float> now_w;
+    std::vector<float> now_x;
+    std::vector<float> now_y;
+    std::vector<float> now_z;
+
+    // constraint axes, the axis set is shared but body axes depend on the
+    // orientation of each arcball
+    std::array<std::vector<float>, 3> axis_x;
+    std::array<std::vector<float>, 3> axis_y;
+    std::array<std::vector<float>, 3> axis_z;
+    // custom axes in world space and in eye space, any number of them so
+    // they are kept inline per arcball instead of as arrays of components
+    std::vector<ConstraintAxes> custom_axes;
+    std::vector<ConstraintAxes> custom_available;
+    std::vector<unsigned int> nearest;
+    // nearest constraint axis gathered for the vectorized kernels
+    std::vector<float> selected_x;
+    std::vector<float> selected_y;
+    std::vector<float> selected_z;
+};
+
+#endif
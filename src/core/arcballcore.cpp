@@ -0,0 +1,414 @@
+#include "arcballcore.hpp"
+
+#include "profiler.hpp"
+
+namespace {
+
+const glm::vec3 X_UNIT(1.0f, 0.0f, 0.0f);
+const glm::vec3 Y_UNIT(0.0f, 1.0f, 0.0f);
+const glm::vec3 Z_UNIT(0.0f, 0.0f, 1.0f);
+
+// Axis set policies, each fills the available constraint axes in eye space
+// from the camera frame, the current orientation and the custom axes. The
+// update is specialized on the policy once per update, so free dragging has
+// no constraint code at all and a constrained drag does not test the axis
+// set again.
+
+struct NoAxes {
+    static const bool constrained = false;
+
+    static void fill(ConstraintAxes &, CameraFrame const &, glm::quat, ConstraintAxes const &)
+    {
+    }
+};
+
+struct CameraAxes {
+    static const bool constrained = true;
+
+    static void fill(ConstraintAxes & axes, CameraFrame const &, glm::quat, ConstraintAxes const &)
+    {
+        axes.push_back(X_UNIT);
+        axes.push_back(Y_UNIT);
+        axes.push_back(Z_UNIT);
+    }
+};
+
+// the columns of the rotation matrix are the rotated unit axes, so the
+// combined rotation is computed once for all three
+struct BodyAxes {
+    static const bool constrained = true;
+
+    static void fill(ConstraintAxes & axes, CameraFrame const & frame, glm::quat now, ConstraintAxes const &)
+    {
+        const glm::mat3 rotation = glm::mat3_cast(frame.inverse * now);
+        axes.push_back(rotation[0]);
+        axes.push_back(rotation[1]);
+        axes.push_back(rotation[2]);
+    }
+};
+
+// the world axes only depend on the camera, they are the columns of the
+// camera frame
+struct WorldAxes {
+    static const bool constrained = true;
+
+    static void fill(ConstraintAxes & axes, CameraFrame const & frame, glm::quat, ConstraintAxes const &)
+    {
+        axes.push_back(frame.axes[0]);
+        axes.push_back(frame.axes[1]);
+        axes.push_back(frame.axes[2]);
+    }
+};
+
+struct CustomAxes {
+    static const bool constrained = true;
+
+    static void fill(ConstraintAxes & axes, CameraFrame const & frame, glm::quat, ConstraintAxes const & custom)
+    {
+        for (auto axis : custom) {
+            axes.push_back(frame.axes * axis);
+        }
+    }
+};
+
+}
+
+ArcballCore::ArcballCore()
+    : ArcballCore(glm::quat())
+{
+}
+
+ArcballCore::ArcballCore(glm::quat orientation)
+    : allow_constraints(false),
+      center(0.0f),
+      radius(0.75f),
+      dragging(false),
+      synchronized(false),
+      state_changed(true)
+{
+    constraint.current = AxisSet::NONE;
+    constraint.nearest = 0;
+    camera_frame.camera = glm::quat();
+    camera_frame.inverse = glm::quat();
+    camera_frame.axes = glm::mat3(1.0f);
+    this->orientation.reset = orientation;
+    this->orientation.start = orientation;
+    this->orientation.now = orientation;
+}
+
+void ArcballCore::update(
+    ArcballInput const & input,
+    ArcballCamera const & camera,
+    ArcballViewport const & viewport)
+{
+    state_changed = !idle(input, camera, viewport);
+    if (!state_changed) {
+        return;
+    }
+
+    synchronized = true;
+    last_input = input;
+    last_camera = camera;
+    last_viewport = viewport;
+
+    update_button(input);
+    update_key(input);
+
+    drag.from = ball_coord(viewport, mouse_position_start);
+    drag.to = ball_coord(viewport, input.position);
+
+    if (!dragging) {
+        update_current_axis_set(input);
+    }
+
+    switch (constraint.current) {
+    case AxisSet::NONE:
+        update_constraint<NoAxes>(camera);
+        break;
+    case AxisSet::CAMERA:
+        update_constraint<CameraAxes>(camera);
+        break;
+    case AxisSet::BODY:
+        update_constraint<BodyAxes>(camera);
+        break;
+    case AxisSet::WORLD:
+        update_constraint<WorldAxes>(camera);
+        break;
+    case AxisSet::CUSTOM:
+        update_constraint<CustomAxes>(camera);
+        break;
+    }
+
+    update_result_arc();
+}
+
+void ArcballCore::update(
+    ArcballInput const * inputs,
+    unsigned int count,
+    ArcballCamera const & camera,
+    ArcballViewport const & viewport)
+{
+    bool any_changed = false;
+    for (unsigned int i = 0; i < count; i++) {
+        update(inputs[i], camera, viewport);
+        any_changed = any_changed || state_changed;
+    }
+    state_changed = any_changed;
+}
+
+void ArcballCore::set_allow_constraints(bool allow_constraints)
+{
+    this->allow_constraints = allow_constraints;
+    // the axis set depends on this so the next update may not be skipped
+    synchronized = false;
+}
+
+void ArcballCore::set_orientation(glm::quat orientation)
+{
+    this->orientation.start = orientation;
+    this->orientation.now = orientation;
+    // the result arc and body axes depend on this so the next update may
+    // not be skipped
+    synchronized = false;
+}
+
+void ArcballCore::set_center(glm::vec2 center)
+{
+    if (this->center != center) {
+        this->center = center;
+        // the ball points depend on this so the next update may not be
+        // skipped
+        synchronized = false;
+    }
+}
+
+void ArcballCore::set_radius(float radius)
+{
+    radius = glm::clamp(radius, 0.25f, 1.0f);
+    if (this->radius != radius) {
+        this->radius = radius;
+        // the ball points depend on this so the next update may not be
+        // skipped
+        synchronized = false;
+    }
+}
+
+// constraining and the constraint arcs assume unit axes
+bool ArcballCore::set_custom_axes(ConstraintAxes const & axes)
+{
+    ConstraintAxes normalized;
+    for (auto const & axis : axes) {
+        if (!(glm::dot(axis, axis) > 0.0f)) {
+            return false;
+        }
+        normalized.push_back(glm::normalize(axis));
+    }
+
+    custom_axes = normalized;
+    // the axis set depends on this so the next update may not be skipped
+    synchronized = false;
+    return true;
+}
+
+bool ArcballCore::changed() const
+{
+    return state_changed;
+}
+
+bool ArcballCore::get_allow_constraints() const
+{
+    return allow_constraints;
+}
+
+bool ArcballCore::is_dragging() const
+{
+    return dragging;
+}
+
+float ArcballCore::get_radius() const
+{
+    return radius;
+}
+
+glm::vec2 ArcballCore::get_center() const
+{
+    return center;
+}
+
+Arc const & ArcballCore::get_drag() const
+{
+    return drag;
+}
+
+Arc const & ArcballCore::get_result() const
+{
+    return result;
+}
+
+Orientation const & ArcballCore::get_orientation() const
+{
+    return orientation;
+}
+
+Constraint const & ArcballCore::get_constraint() const
+{
+    return constraint;
+}
+
+ConstraintAxes const & ArcballCore::get_custom_axes() const
+{
+    return custom_axes;
+}
+
+// return true if an update with specified input, camera and viewport would
+// leave the arcball as it is, this is the case when nothing was clicked,
+// released or pressed and mouse position, held buttons, modifiers, camera and
+// viewport are all the same as in the last update
+bool ArcballCore::idle(
+    ArcballInput const & input,
+    ArcballCamera const & camera,
+    ArcballViewport const & viewport) const
+{
+    const bool events = input.clicked ||
+                        input.released ||
+                        input.increase_radius ||
+                        input.decrease_radius ||
+                        input.reset;
+
+    return synchronized &&
+           !events &&
+           input.position == last_input.position &&
+           input.down == last_input.down &&
+           input.shift == last_input.shift &&
+           input.ctrl == last_input.ctrl &&
+           camera.orientation == last_camera.orientation &&
+           viewport == last_viewport;
+}
+
+void ArcballCore::update_button(ArcballInput const & input)
+{
+    dragging = input.down;
+
+    if (input.clicked) {
+        // begin drag
+        mouse_position_start = input.position;
+    } else if (input.released) {
+        // end drag
+        orientation.start = orientation.now;
+    }
+}
+
+void ArcballCore::update_key(ArcballInput const & input)
+{
+    if (input.increase_radius) {
+        radius = glm::clamp(radius + 0.25f, 0.25f, 1.0f);
+    } else if (input.decrease_radius) {
+        radius = glm::clamp(radius - 0.25f, 0.25f, 1.0f);
+    }
+
+    if (input.reset) {
+        orientation.start = orientation.reset;
+        orientation.now = orientation.reset;
+    }
+}
+
+void ArcballCore::update_current_axis_set(ArcballInput const & input)
+{
+    const bool shift = input.shift;
+    const bool ctrl = input.ctrl;
+
+    if (allow_constraints && ctrl && shift) {
+        constraint.current = custom_axes.empty() ? AxisSet::WORLD : AxisSet::CUSTOM;
+    } else if (allow_constraints && ctrl) {
+        constraint.current = AxisSet::BODY;
+    } else if (allow_constraints && shift) {
+        constraint.current = AxisSet::CAMERA;
+    } else {
+        constraint.current = AxisSet::NONE;
+    }
+}
+
+// update constraint axes and the nearest axis while hovering, or the drag
+// arc while dragging, for the axis set of specified policy
+template <typename Axes>
+void ArcballCore::update_constraint(ArcballCamera const & camera)
+{
+    if (!dragging) {
+        update_constraint_axes<Axes>(camera);
+
+        PROFILE_SCOPE("nearest_constraint");
+        constraint.nearest = Axes::constrained ? nearest_constraint(
+            drag.to,
+            constraint.available.data(),
+            constraint.available.size()) : 0;
+    }
+
+    if (dragging) {
+        update_drag_arc<Axes>(camera);
+    }
+}
+
+template <typename Axes>
+void ArcballCore::update_constraint_axes(ArcballCamera const & camera)
+{
+    PROFILE_SCOPE("ArcballCore::update_constraint_axes");
+
+    constraint.available.clear();
+
+    // the axes that should not rotate on camera axes is multiplied by the
+    // inverse/conjugate of the camera orientation to cancel out the camera
+    // orientation when dragging
+    update_camera_frame(camera);
+    Axes::fill(constraint.available, camera_frame, orientation.now, custom_axes);
+}
+
+template <typename Axes>
+void ArcballCore::update_drag_arc(ArcballCamera const & camera)
+{
+    PROFILE_SCOPE("ArcballCore::update_drag_arc");
+
+    if (Axes::constrained) {
+        drag.from = constrain_to(drag.from, constraint.available[constraint.nearest]);
+        drag.to = constrain_to(drag.to, constraint.available[constraint.nearest]);
+    }
+
+    glm::quat orientation_drag = drag_rotation(drag.from, drag.to, camera.orientation);
+
+    // product of two quaternions give the combination of the rotations
+    // they represent
+    orientation.now = glm::normalize(orientation_drag * orientation.start);
+}
+
+// the result arc is the shortest arc for obtaining the current orientation
+// from its starting orientation
+void ArcballCore::update_result_arc()
+{
+    PROFILE_SCOPE("ArcballCore::update_result_arc");
+
+    result = result_arc(orientation.start);
+}
+
+// the inverse camera orientation and its matrix are only recomputed when the
+// camera has turned, not on every update made through the same camera
+void ArcballCore::update_camera_frame(ArcballCamera const & camera)
+{
+    if (camera.orientation == camera_frame.camera) {
+        return;
+    }
+    camera_frame.camera = camera.orientation;
+    camera_frame.inverse = glm::conjugate(camera.orientation);
+    camera_frame.axes = glm::mat3_cast(camera_frame.inverse);
+}
+
+// return coordinate on the ball from mouse position
+glm::vec3 ArcballCore::ball_coord(ArcballViewport const & viewport, glm::ivec2 mouse_position)
+{
+    glm::vec3 window_mouse_position = window_coord(
+        viewport.x,
+        viewport.y,
+        viewport.width,
+        viewport.height,
+        mouse_position);
+
+    return ::ball_coord(window_mouse_position, center, radius);
+}
@@ -0,0 +1,130 @@
+#ifndef ARCBALLCORE_HPP_INCLUDED
+#define ARCBALLCORE_HPP_INCLUDED
+
+#include "arcballinput.hpp"
+#include "arcballmath.hpp"
+#include "constraintaxes.hpp"
+
+struct Constraint {
+    AxisSet current;
+    ConstraintAxes available;
+    unsigned int nearest;
+};
+
+struct Orientation {
+    glm::quat reset;
+    glm::quat start;
+    glm::quat now;
+};
+
+// Inverse of the camera orientation and its rotation matrix, whose columns
+// are the world axes in eye space, for the camera orientation they were
+// computed from.
+struct CameraFrame {
+    glm::quat camera;
+    glm::quat inverse;
+    glm::mat3 axes;
+};
+
+// The responsibility of this class is to compute the orientation of a
+// virtual arcball from plain input, camera and viewport state, without any
+// dependency on a windowing or rendering stack.
+class ArcballCore {
+public:
+    // Construct arcball core with identity orientation.
+    ArcballCore();
+    // Construct arcball core with specified initial orientation.
+    explicit ArcballCore(glm::quat orientation);
+    // Update arcball from specified input, camera and viewport. The update
+    // is skipped when nothing has changed since the last update.
+    void update(
+        ArcballInput const & input,
+        ArcballCamera const & camera,
+        ArcballViewport const & viewport);
+    // Update arcball from specified number of inputs in order, as if each
+    // was a separate update with the same camera and viewport. The arcball
+    // has changed if any of the updates changed it.
+    void update(
+        ArcballInput const * inputs,
+        unsigned int count,
+        ArcballCamera const & camera,
+        ArcballViewport const & viewport);
+    // Set enable/disable if orientation can be locked and manipulated on a
+    // specific axis.
+    void set_allow_constraints(bool allow_constraints);
+    // Set start and current orientation, as if the arcball had been dragged
+    // there. The reset orientation is kept.
+    void set_orientation(glm::quat orientation);
+    // Set center of the ball in window coordinates, this is where the object
+    // is projected to. The default is the center of the viewport.
+    void set_center(glm::vec2 center);
+    // Set radius of the ball relative to the viewport, clamped to the range
+    // the radius keys step through.
+    void set_radius(float radius);
+    // Set custom world space axes which replace the world axes when
+    // constraints are allowed and both shift and ctrl are held. An empty set
+    // restores the world axes. The axes are normalized. Return false if an
+    // axis has no length, the axes are then left as they were.
+    bool set_custom_axes(ConstraintAxes const & axes);
+    // Return true if the last update changed the arcball.
+    bool changed() const;
+    // Return true if constraints are allowed.
+    bool get_allow_constraints() const;
+    // Return true if arcball is being dragged.
+    bool is_dragging() const;
+    // Return radius of the ball relative to the viewport.
+    float get_radius() const;
+    // Return center of the ball in window coordinates.
+    glm::vec2 get_center() const;
+    // Return arc between the two dragged points on the ball.
+    Arc const & get_drag() const;
+    // Return shortest arc for obtaining the start orientation.
+    Arc const & get_result() const;
+    // Return reset, start and current orientation.
+    Orientation const & get_orientation() const;
+    // Return current constraint axes.
+    Constraint const & get_constraint() const;
+    // Return custom world space axes.
+    ConstraintAxes const & get_custom_axes() const;
+private:
+    bool idle(
+        ArcballInput const & input,
+        ArcballCamera const & camera,
+        ArcballViewport const & viewport) const;
+    void update_button(ArcballInput const & input);
+    void update_key(ArcballInput const & input);
+    void update_current_axis_set(ArcballInput const & input);
+    template <typename Axes>
+    void update_constraint(ArcballCamera const & camera);
+    template <typename Axes>
+    void update_constraint_axes(ArcballCamera const & camera);
+    template <typename Axes>
+    void update_drag_arc(ArcballCamera const & camera);
+    void update_result_arc();
+    void update_camera_frame(ArcballCamera const & camera);
+
+    glm::vec3 ball_coord(ArcballViewport const & viewport, glm::ivec2 mouse_position);
+
+    bool allow_constraints;
+    ConstraintAxes custom_axes;
+    glm::vec2 center;
+    float radius;
+    bool dragging;
+    glm::ivec2 mouse_position_start;
+
+    // state of the last update that was not skipped
+    bool synchronized;
+    bool state_changed;
+    ArcballInput last_input;
+    ArcballCamera last_camera;
+    ArcballViewport last_viewport;
+
+    Arc drag;
+    Arc result;
+    Orientation orientation;
+    Constraint constraint;
+    // computed once per camera, many updates are made through the same one
+    CameraFrame camera_frame;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "arcballevents.hpp"
+
+namespace {
+
+// return true if specified input is only state, in which case a newer input
+// makes it redundant
+bool stateless(ArcballInput const & input)
+{
+    return !input.clicked &&
+           !input.released &&
+           !input.increase_radius &&
+           !input.decrease_radius &&
+           !input.reset;
+}
+
+}
+
+ArcballEventQueue::ArcballEventQueue(unsigned int capacity)
+    : state(ArcballInput())
+{
+    inputs.reserve(capacity);
+    inputs.push_back(state);
+}
+
+void ArcballEventQueue::motion(glm::ivec2 position)
+{
+    state.position = position;
+    push(state);
+}
+
+void ArcballEventQueue::button(bool down)
+{
+    if (state.down == down) {
+        return;
+    }
+    state.down = down;
+
+    ArcballInput input = state;
+    input.clicked = down;
+    input.released = !down;
+    push(input);
+}
+
+void ArcballEventQueue::modifiers(bool shift, bool ctrl)
+{
+    state.shift = shift;
+    state.ctrl = ctrl;
+    push(state);
+}
+
+void ArcballEventQueue::increase_radius()
+{
+    ArcballInput input = state;
+    input.increase_radius = true;
+    push(input);
+}
+
+void ArcballEventQueue::decrease_radius()
+{
+    ArcballInput input = state;
+    input.decrease_radius = true;
+    push(input);
+}
+
+void ArcballEventQueue::reset()
+{
+    ArcballInput input = state;
+    input.reset = true;
+    push(input);
+}
+
+ArcballInput const * ArcballEventQueue::data() const
+{
+    return inputs.data();
+}
+
+unsigned int ArcballEventQueue::size() const
+{
+    return inputs.size();
+}
+
+void ArcballEventQueue::clear()
+{
+    inputs.clear();
+    inputs.push_back(state);
+}
+
+// an input without events replaces the last input if that also has none,
+// this is what keeps the cost of a motion event at a single copy
+void ArcballEventQueue::push(ArcballInput const & input)
+{
+    if (stateless(input) && stateless(inputs.back())) {
+        inputs.back() = input;
+    } else {
+        inputs.push_back(input);
+    }
+}
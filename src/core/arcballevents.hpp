@@ -0,0 +1,46 @@
+#ifndef ARCBALLEVENTS_HPP_INCLUDED
+#define ARCBALLEVENTS_HPP_INCLUDED
+
+#include "arcballinput.hpp"
+
+#include <vector>
+
+// The responsibility of this class is to collect raw input events as they
+// arrive, at any rate, and turn them into the shortest sequence of inputs
+// that updates an arcball to the same state as one update per event would.
+//
+// An arcball drag only depends on the point where it started and the point
+// it is at now, so consecutive inputs without any click, release or key
+// press are replaced by the newest one. Inputs with such an event are kept in
+// order together with the input before them, which decides the constraint
+// axis a drag starts on.
+class ArcballEventQueue {
+public:
+    // Construct queue with room for specified number of inputs before it
+    // has to grow.
+    explicit ArcballEventQueue(unsigned int capacity = 64);
+    // Mouse moved to specified position.
+    void motion(glm::ivec2 position);
+    // Drag button was pressed or released at the current position.
+    void button(bool down);
+    // Modifiers changed to specified state.
+    void modifiers(bool shift, bool ctrl);
+    // Radius increase, decrease and reset key was pressed.
+    void increase_radius();
+    void decrease_radius();
+    void reset();
+    // Return queued inputs, there is always at least one input which is the
+    // current state.
+    ArcballInput const * data() const;
+    // Return number of queued inputs.
+    unsigned int size() const;
+    // Remove queued inputs except for the current state.
+    void clear();
+private:
+    void push(ArcballInput const & input);
+
+    ArcballInput state;
+    std::vector<ArcballInput> inputs;
+};
+
+#endif
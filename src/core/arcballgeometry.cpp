@@ -0,0 +1,108 @@
+#include "arcballgeometry.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include <array>
+#include <cmath>
+
+std::vector<glm::vec3> const & unit_circle()
+{
+    // computed on first use, initialization of a local static is thread-safe
+    static const std::vector<glm::vec3> circle = []() {
+        const auto PI_2 = glm::pi<float>() * 2.0f;
+        const auto segment = PI_2 / circle_segments;
+
+        std::vector<glm::vec3> positions;
+        for (auto i = 0.0f; i < PI_2; i += segment) {
+            positions.push_back(glm::vec3(cos(i), sin(i), 0.0f));
+        }
+        return positions;
+    }();
+    return circle;
+}
+
+void fill_circle(float radius, std::vector<glm::vec3> & positions)
+{
+    for (auto const & position : unit_circle()) {
+        positions.push_back(position * radius);
+    }
+}
+
+void fill_arc(
+    float radius,
+    std::vector<glm::vec3> & positions,
+    glm::vec3 from,
+    glm::vec3 to)
+{
+    std::array<glm::vec3, arc_segments + 1> points;
+    points[0] = from;
+    points[1] = to;
+    points[arc_segments] = to;
+
+    // we have our first and last point, we bisect the arc to find the second
+    // point
+    for (int i = 0; i < arc_bisects; i++) {
+        points[1] = bisect(points[0], points[1]);
+    }
+
+    auto push = [&positions, radius](glm::vec3 point) {
+        positions.push_back(point * radius);
+    };
+
+    push(points[0]);
+    push(points[1]);
+
+    // using our first two points, we use dynamic programming to build up the
+    // remaining points of the arc
+    const float dot_two = glm::dot(points[0], points[1]) * 2.0f;
+    for (int i = 2; i < arc_segments; i++) {
+        points[i] = (points[i - 1] * dot_two) - points[i - 2];
+        push(points[i]);
+    }
+    push(points[arc_segments]);
+}
+
+void fill_half_arc(
+    float radius,
+    std::vector<glm::vec3> & positions,
+    glm::vec3 axis)
+{
+    glm::vec3 start;
+    glm::vec3 middle;
+    half_arc_points(axis, start, middle);
+
+    // "combine" the two half arcs into one arc
+    fill_arc(radius, positions, start, middle);
+    fill_arc(radius, positions, middle, -start);
+}
+
+void half_arc_points(glm::vec3 axis, glm::vec3 & start, glm::vec3 & middle)
+{
+    // create a perpendicular vector that is a "mirror" over another axis
+    glm::vec3 mirror_point;
+    if (axis.z != 1.0f) {
+        mirror_point.x = axis.y;
+        mirror_point.y = -axis.x;
+        mirror_point = glm::normalize(mirror_point);
+    } else {
+        mirror_point.x = 0.0f;
+        mirror_point.y = 1.0f;
+    }
+
+    start = mirror_point;
+    middle = glm::cross(mirror_point, axis);
+}
+
+glm::vec3 bisect(glm::vec3 a, glm::vec3 b)
+{
+    const float epsilon = 1.0e-8f;
+    auto v = a + b;
+    float length2 = glm::length2(v);
+    if (length2 < epsilon) {
+        v = glm::vec3(0.0f, 0.0f, 1.0f);
+    } else {
+        v *= (1.0 / std::sqrt(length2));
+    }
+    return v;
+}
@@ -0,0 +1,40 @@
+#ifndef ARCBALLGEOMETRY_HPP_INCLUDED
+#define ARCBALLGEOMETRY_HPP_INCLUDED
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Number of line segments in a circle.
+const int circle_segments = 64;
+// Number of line segments in an arc.
+const int arc_segments = 32;
+// Number of bisections used to find the second point of an arc.
+const int arc_bisects = 5;
+
+// Return positions of the unit circle in the view plane, they are only
+// computed once.
+std::vector<glm::vec3> const & unit_circle();
+// Append circle with specified radius in the view plane to positions.
+void fill_circle(float radius, std::vector<glm::vec3> & positions);
+// Append arc between two points on a ball with specified radius to
+// positions.
+void fill_arc(
+    float radius,
+    std::vector<glm::vec3> & positions,
+    glm::vec3 from,
+    glm::vec3 to);
+// Append front half of the great circle perpendicular to specified axis on a
+// ball with specified radius to positions.
+void fill_half_arc(
+    float radius,
+    std::vector<glm::vec3> & positions,
+    glm::vec3 axis);
+// Set start and middle point of the front half of the great circle
+// perpendicular to specified axis, the half ends opposite of where it
+// starts.
+void half_arc_points(glm::vec3 axis, glm::vec3 & start, glm::vec3 & middle);
+// Return normalized point halfway between two points on the unit ball.
+glm::vec3 bisect(glm::vec3 a, glm::vec3 b);
+
+#endif
@@ -0,0 +1,214 @@
+#include "arcballinertia.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// arcballs slower than this in radians per second are at rest
+const float rest_speed = 0.05f;
+// the largest number of steps in a single advance, time beyond that is
+// dropped so a long stall does not have to be caught up with
+const unsigned int max_steps = 30;
+
+const unsigned int none = std::numeric_limits<unsigned int>::max();
+
+}
+
+SpinTracker::SpinTracker(float window)
+    : window(window),
+      next(0),
+      count(0)
+{
+}
+
+void SpinTracker::clear()
+{
+    next = 0;
+    count = 0;
+}
+
+void SpinTracker::add(float time, glm::quat orientation)
+{
+    times[next] = time;
+    orientations[next] = orientation;
+    next = (next + 1) % spin_samples;
+    count = std::min(count + 1, spin_samples);
+}
+
+glm::vec3 SpinTracker::get_velocity(float time) const
+{
+    if (count < 2) {
+        return glm::vec3(0.0f);
+    }
+
+    const unsigned int newest = (next + spin_samples - 1) % spin_samples;
+    unsigned int oldest = newest;
+    for (unsigned int i = 0; i < count; i++) {
+        const unsigned int index = (next + spin_samples - count + i) % spin_samples;
+        if (times[index] >= time - window) {
+            oldest = index;
+            break;
+        }
+    }
+
+    const float span = times[newest] - times[oldest];
+    if (oldest == newest || span <= 0.0f) {
+        return glm::vec3(0.0f);
+    }
+
+    // rotation from the oldest to the newest orientation, taking the shorter
+    // way around
+    glm::quat delta = orientations[newest] * glm::conjugate(orientations[oldest]);
+    if (delta.w < 0.0f) {
+        delta = -delta;
+    }
+    const glm::vec3 axis(delta.x, delta.y, delta.z);
+    const float sin_half = glm::length(axis);
+    if (sin_half == 0.0f) {
+        return glm::vec3(0.0f);
+    }
+    const float angle = 2.0f * std::atan2(sin_half, delta.w);
+
+    return axis * (angle / (sin_half * span));
+}
+
+ArcballInertia::ArcballInertia(float damping, float step)
+    : kernels(&arcball_kernels()),
+      step(step),
+      decay(std::exp(-damping * step)),
+      time(0.0f),
+      accumulator(0.0f)
+{
+}
+
+void ArcballInertia::spin(unsigned int id, glm::quat orientation, glm::vec3 velocity)
+{
+    stop(id);
+    if (glm::dot(velocity, velocity) < rest_speed * rest_speed) {
+        return;
+    }
+
+    if (id >= indices.size()) {
+        indices.resize(id + 1, none);
+    }
+    indices[id] = ids.size();
+
+    ids.push_back(id);
+    velocity_x.push_back(velocity.x);
+    velocity_y.push_back(velocity.y);
+    velocity_z.push_back(velocity.z);
+    orientation_w.push_back(orientation.w);
+    orientation_x.push_back(orientation.x);
+    orientation_y.push_back(orientation.y);
+    orientation_z.push_back(orientation.z);
+}
+
+void ArcballInertia::stop(unsigned int id)
+{
+    if (is_spinning(id)) {
+        remove(indices[id]);
+    }
+}
+
+void ArcballInertia::clear()
+{
+    while (!ids.empty()) {
+        remove(ids.size() - 1);
+    }
+}
+
+void ArcballInertia::advance(float delta)
+{
+    time += delta;
+    accumulator += delta;
+
+    unsigned int steps = 0;
+    while (accumulator >= step && steps < max_steps) {
+        kernels->spin(
+            ids.size(),
+            step,
+            decay,
+            velocity_x.data(),
+            velocity_y.data(),
+            velocity_z.data(),
+            orientation_w.data(),
+            orientation_x.data(),
+            orientation_y.data(),
+            orientation_z.data());
+        accumulator -= step;
+        steps++;
+    }
+    accumulator = std::fmod(accumulator, step);
+
+    if (steps > 0) {
+        settle();
+    }
+}
+
+bool ArcballInertia::is_spinning(unsigned int id) const
+{
+    return id < indices.size() && indices[id] != none;
+}
+
+glm::quat ArcballInertia::get_orientation(unsigned int id) const
+{
+    const unsigned int index = indices[id];
+    return glm::quat(
+        orientation_w[index],
+        orientation_x[index],
+        orientation_y[index],
+        orientation_z[index]);
+}
+
+unsigned int ArcballInertia::size() const
+{
+    return ids.size();
+}
+
+float ArcballInertia::get_time() const
+{
+    return time;
+}
+
+// remove spinning arcball at specified index by moving the last one into its
+// place, so the arrays stay packed
+void ArcballInertia::remove(unsigned int index)
+{
+    const unsigned int last = ids.size() - 1;
+    indices[ids[index]] = none;
+    if (index != last) {
+        indices[ids[last]] = index;
+        ids[index] = ids[last];
+        velocity_x[index] = velocity_x[last];
+        velocity_y[index] = velocity_y[last];
+        velocity_z[index] = velocity_z[last];
+        orientation_w[index] = orientation_w[last];
+        orientation_x[index] = orientation_x[last];
+        orientation_y[index] = orientation_y[last];
+        orientation_z[index] = orientation_z[last];
+    }
+
+    ids.pop_back();
+    velocity_x.pop_back();
+    velocity_y.pop_back();
+    velocity_z.pop_back();
+    orientation_w.pop_back();
+    orientation_x.pop_back();
+    orientation_y.pop_back();
+    orientation_z.pop_back();
+}
+
+// remove every arcball that has come to rest, the velocity decays at the same
+// rate for all of them so this is rarely more than a few
+void ArcballInertia::settle()
+{
+    const float rest2 = rest_speed * rest_speed;
+    for (unsigned int i = ids.size(); i-- > 0;) {
+        const float speed2 = velocity_x[i] * velocity_x[i] + velocity_y[i] * velocity_y[i] + velocity_z[i] * velocity_z[i];
+        if (speed2 < rest2) {
+            remove(i);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef ARCBALLINERTIA_HPP_INCLUDED
+#define ARCBALLINERTIA_HPP_INCLUDED
+
+#include "arcballkernels.hpp"
+#include "arcballmath.hpp"
+
+#include <array>
+#include <vector>
+
+// Number of drag orientations a spin tracker remembers.
+const unsigned int spin_samples = 8;
+
+// The responsibility of this class is to estimate the angular velocity of a
+// dragged arcball from its last few orientations, so it can keep spinning
+// when released.
+class SpinTracker {
+public:
+    // Construct tracker without any orientations, only orientations at most
+    // specified number of seconds older than the newest are used.
+    explicit SpinTracker(float window = 0.1f);
+    // Forget every orientation.
+    void clear();
+    // Add orientation at specified time in seconds.
+    void add(float time, glm::quat orientation);
+    // Return angular velocity in radians per second around world axes at
+    // specified time, from the oldest to the newest orientation within the
+    // window before that time. It is zero if the arcball has not moved
+    // within the window.
+    glm::vec3 get_velocity(float time) const;
+private:
+    float window;
+    std::array<float, spin_samples> times;
+    std::array<glm::quat, spin_samples> orientations;
+    unsigned int next;
+    unsigned int count;
+};
+
+// The responsibility of this class is to keep many released arcballs
+// spinning, with an angular velocity that decays on a fixed timestep. The
+// spinning arcballs are packed in structure-of-arrays form and advanced
+// together by the spin kernel, arcballs are removed as soon as they come to
+// rest so only spinning arcballs cost anything.
+class ArcballInertia {
+public:
+    // Construct inertia without spinning arcballs. The angular velocity
+    // decays by specified damping per second and is integrated in steps of
+    // specified length in seconds.
+    explicit ArcballInertia(float damping = 3.0f, float step = 1.0f / 120.0f);
+    // Start spinning arcball with specified id from specified orientation
+    // with specified angular velocity in radians per second around world
+    // axes. An arcball that is already spinning is restarted, an arcball that
+    // is too slow to spin is stopped.
+    void spin(unsigned int id, glm::quat orientation, glm::vec3 velocity);
+    // Stop arcball with specified id, if it is spinning.
+    void stop(unsigned int id);
+    // Stop all arcballs.
+    void clear();
+    // Advance time by specified number of seconds. Every spinning arcball is
+    // advanced by the whole steps that fit, the rest is carried over to the
+    // next advance.
+    void advance(float delta);
+    // Return true if arcball with specified id is spinning.
+    bool is_spinning(unsigned int id) const;
+    // Return orientation of arcball with specified id, which must be
+    // spinning.
+    glm::quat get_orientation(unsigned int id) const;
+    // Return number of spinning arcballs.
+    unsigned int size() const;
+    // Return time in seconds advanced since construction.
+    float get_time() const;
+private:
+    void remove(unsigned int index);
+    void settle();
+
+    ArcballKernels const * kernels;
+    float step;
+    float decay;
+    float time;
+    float accumulator;
+
+    // index of each id in the packed arrays, or none if not spinning
+    std::vector<unsigned int> indices;
+
+    std::vector<unsigned int> ids;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> velocity_z;
+    std::vector<float> orientation_w;
+    std::vector<float> orientation_x;
+    std::vector<float> orientation_y;
+    std::vector<float> orientation_z;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef ARCBALLINPUT_HPP_INCLUDED
+#define ARCBALLINPUT_HPP_INCLUDED
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Input state for a single update, in window coordinates.
+struct ArcballInput {
+    // mouse position
+    glm::ivec2 position;
+    // drag button is held down, was clicked or was released this update
+    bool down;
+    bool clicked;
+    bool released;
+    // keys pressed this update
+    bool increase_radius;
+    bool decrease_radius;
+    bool reset;
+    // modifiers held down
+    bool shift;
+    bool ctrl;
+};
+
+// Viewport rectangle in window coordinates.
+struct ArcballViewport {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+inline bool operator==(ArcballViewport const & a, ArcballViewport const & b)
+{
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+// Camera the arcball is viewed through.
+struct ArcballCamera {
+    glm::quat orientation;
+};
+
+#endif
@@ -0,0 +1,375 @@
+#include "arcballkernels.hpp"
+#include "arcballkernelsimpl.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+void project_to_ball_scalar(
+    unsigned int count,
+    float mouse_x,
+    float mouse_y,
+    float const * viewport_x,
+    float const * viewport_y,
+    float const * viewport_width,
+    float const * viewport_height,
+    float const * center_x,
+    float const * center_y,
+    float const * radius,
+    float * x,
+    float * y,
+    float * z)
+{
+    for (unsigned int i = 0; i < count; i++) {
+        const float wx = 2.0f * (mouse_x - viewport_x[i]) / viewport_width[i] - 1.0f;
+        const float wy = -(2.0f * (mouse_y - viewport_y[i]) / viewport_height[i] - 1.0f);
+
+        float px = (wx - center_x[i]) / radius[i];
+        float py = (wy - center_y[i]) / radius[i];
+        float pz = 0.0f;
+
+        const float length2 = px * px + py * py;
+        if (length2 > 1.0f) {
+            const float s = 1.0f / std::sqrt(length2);
+            px *= s;
+            py *= s;
+        } else {
+            pz = std::sqrt(1.0f - length2);
+        }
+
+        x[i] = px;
+        y[i] = py;
+        z[i] = pz;
+    }
+}
+
+void constrain_to_scalar(
+    unsigned int count,
+    float const * point_x,
+    float const * point_y,
+    float const * point_z,
+    float const * axis_x,
+    float const * axis_y,
+    float const * axis_z,
+    float * x,
+    float * y,
+    float * z)
+{
+    for (unsigned int i = 0; i < count; i++) {
+        const float px = point_x[i];
+        const float py = point_y[i];
+        const float pz = point_z[i];
+        const float ax = axis_x[i];
+        const float ay = axis_y[i];
+        const float az = axis_z[i];
+
+        const float d = ax * px + ay * py + az * pz;
+        const float qx = px - ax * d;
+        const float qy = py - ay * d;
+        const float qz = pz - az * d;
+        const float length = std::sqrt(qx * qx + qy * qy + qz * qz);
+
+        if (length > 0.0f) {
+            float s = 1.0f / length;
+            if (qz < 0.0f) {
+                s = -s;
+            }
+            x[i] = qx * s;
+            y[i] = qy * s;
+            z[i] = qz * s;
+        } else if (az == 1.0f) {
+            x[i] = 1.0f;
+            y[i] = 0.0f;
+            z[i] = 0.0f;
+        } else {
+            const float nx = -ay;
+            const float n = 1.0f / std::sqrt(nx * nx + ax * ax + 0.0f * 0.0f);
+            x[i] = nx * n;
+            y[i] = ax * n;
+            z[i] = 0.0f;
+        }
+    }
+}
+
+void drag_compose_scalar(
+    unsigned int count,
+    float const * from_x,
+    float const * from_y,
+    float const * from_z,
+    float const * to_x,
+    float const * to_y,
+    float const * to_z,
+    float const eye[4],
+    float const * start_w,
+    float const * start_x,
+    float const * start_y,
+    float const * start_z,
+    float * now_w,
+    float * now_x,
+    float * now_y,
+    float * now_z)
+{
+    const float ew = eye[0];
+    const float ex = eye[1];
+    const float ey = eye[2];
+    const float ez = eye[3];
+
+    for (unsigned int i = 0; i < count; i++) {
+        const float fx = from_x[i];
+        const float fy = from_y[i];
+        const float fz = from_z[i];
+        const float tx = to_x[i];
+        const float ty = to_y[i];
+        const float tz = to_z[i];
+
+        // drag rotation
+        const float pw = fx * tx + fy * ty + fz * tz;
+        const float cx = fy * tz - ty * fz;
+        const float cy = fz * tx - tz * fx;
+        const float cz = fx * ty - tx * fy;
+
+        // rotate rotation axis into eye space
+        const float uvx = ey * cz - cy * ez;
+        const float uvy = ez * cx - cz * ex;
+        const float uvz = ex * cy - cx * ey;
+        const float uuvx = ey * uvz - uvy * ez;
+        const float uuvy = ez * uvx - uvz * ex;
+        const float uuvz = ex * uvy - uvx * ey;
+        const float px = cx + (uvx * ew + uuvx) * 2.0f;
+        const float py = cy + (uvy * ew + uuvy) * 2.0f;
+        const float pz = cz + (uvz * ew + uuvz) * 2.0f;
+
+        // combine with start orientation
+        const float qw = start_w[i];
+        const float qx = start_x[i];
+        const float qy = start_y[i];
+        const float qz = start_z[i];
+        const float rw = pw * qw - px * qx - py * qy - pz * qz;
+        const float rx = pw * qx + px * qw + py * qz - pz * qy;
+        const float ry = pw * qy + py * qw + pz * qx - px * qz;
+        const float rz = pw * qz + pz * qw + px * qy - py * qx;
+
+        // normalize
+        const float length = std::sqrt((rx * rx + ry * ry) + (rz * rz + rw * rw));
+        if (length > 0.0f) {
+            const float s = 1.0f / length;
+            now_w[i] = rw * s;
+            now_x[i] = rx * s;
+            now_y[i] = ry * s;
+            now_z[i] = rz * s;
+        } else {
+            now_w[i] = 1.0f;
+            now_x[i] = 0.0f;
+            now_y[i] = 0.0f;
+            now_z[i] = 0.0f;
+        }
+    }
+}
+
+void spin_scalar(
+    unsigned int count,
+    float step,
+    float decay,
+    float * velocity_x,
+    float * velocity_y,
+    float * velocity_z,
+    float * w,
+    float * x,
+    float * y,
+    float * z)
+{
+    const float half_step = 0.5f * step;
+
+    for (unsigned int i = 0; i < count; i++) {
+        const float vx = velocity_x[i];
+        const float vy = velocity_y[i];
+        const float vz = velocity_z[i];
+
+        // rotation of the step from the series of cos and sin of the half
+        // angle
+        const float hx = vx * half_step;
+        const float hy = vy * half_step;
+        const float hz = vz * half_step;
+        const float angle2 = (hx * hx + hy * hy) + hz * hz;
+        const float pw = 1.0f - angle2 * (0.5f - angle2 * (1.0f / 24.0f));
+        const float sinc = 1.0f - angle2 * (1.0f / 6.0f - angle2 * (1.0f / 120.0f));
+        const float px = hx * sinc;
+        const float py = hy * sinc;
+        const float pz = hz * sinc;
+
+        // combine with current orientation
+        const float qw = w[i];
+        const float qx = x[i];
+        const float qy = y[i];
+        const float qz = z[i];
+        const float rw = pw * qw - px * qx - py * qy - pz * qz;
+        const float rx = pw * qx + px * qw + py * qz - pz * qy;
+        const float ry = pw * qy + py * qw + pz * qx - px * qz;
+        const float rz = pw * qz + pz * qw + px * qy - py * qx;
+
+        // normalize, the length is never zero since both are rotations
+        const float s = 1.0f / std::sqrt((rx * rx + ry * ry) + (rz * rz + rw * rw));
+        w[i] = rw * s;
+        x[i] = rx * s;
+        y[i] = ry * s;
+        z[i] = rz * s;
+
+        velocity_x[i] = vx * decay;
+        velocity_y[i] = vy * decay;
+        velocity_z[i] = vz * decay;
+    }
+}
+
+// sin(x) / x from x squared, for x up to pi / 2
+float sinc(float x2)
+{
+    return 1.0f - x2 * (sinc_c1 - x2 * (sinc_c2 - x2 * (sinc_c3 - x2 * (sinc_c4 - x2 * sinc_c5))));
+}
+
+void slerp_scalar(
+    unsigned int count,
+    float const * t,
+    float const * from_w,
+    float const * from_x,
+    float const * from_y,
+    float const * from_z,
+    float const * to_w,
+    float const * to_x,
+    float const * to_y,
+    float const * to_z,
+    float * w,
+    float * x,
+    float * y,
+    float * z)
+{
+    for (unsigned int i = 0; i < count; i++) {
+        const float aw = from_w[i];
+        const float ax = from_x[i];
+        const float ay = from_y[i];
+        const float az = from_z[i];
+        float bw = to_w[i];
+        float bx = to_x[i];
+        float by = to_y[i];
+        float bz = to_z[i];
+        const float tt = t[i];
+        const float s = 1.0f - tt;
+
+        // take the shorter way around
+        float d = (ax * bx + ay * by) + (az * bz + aw * bw);
+        if (d < 0.0f) {
+            bw = -bw;
+            bx = -bx;
+            by = -by;
+            bz = -bz;
+            d = -d;
+        }
+
+        float wa = s;
+        float wb = tt;
+        if (!(d > slerp_linear_dot)) {
+            // the half angle between the orientations is less than a right
+            // angle, the tangent of half of it is at most one
+            const float mw = bw - aw;
+            const float mx = bx - ax;
+            const float my = by - ay;
+            const float mz = bz - az;
+            const float pw = bw + aw;
+            const float px = bx + ax;
+            const float py = by + ay;
+            const float pz = bz + az;
+            const float m2 = (mx * mx + my * my) + (mz * mz + mw * mw);
+            const float p2 = (px * px + py * py) + (pz * pz + pw * pw);
+            float r = std::sqrt(m2 / p2);
+
+            // arc tangent, reduced around a quarter pi
+            float base = 0.0f;
+            if (r > tan_pi_8) {
+                r = (r - 1.0f) / (r + 1.0f);
+                base = quarter_pi;
+            }
+            const float r2 = r * r;
+            const float a = ((r2 * atan_c3 + atan_c2) * r2 + atan_c1) * r2 + atan_c0;
+            const float angle = 2.0f * ((a * r2 * r + r) + base);
+
+            // sin(s * angle) / sin(angle) and sin(t * angle) / sin(angle)
+            const float sa = s * angle;
+            const float ta = tt * angle;
+            const float inverse = 1.0f / sinc(angle * angle);
+            wa = s * sinc(sa * sa) * inverse;
+            wb = tt * sinc(ta * ta) * inverse;
+        }
+
+        const float rw = wa * aw + wb * bw;
+        const float rx = wa * ax + wb * bx;
+        const float ry = wa * ay + wb * by;
+        const float rz = wa * az + wb * bz;
+
+        // normalize, the length is never zero since both weights are
+        // positive and the orientations on the same side
+        const float n = 1.0f / std::sqrt((rx * rx + ry * ry) + (rz * rz + rw * rw));
+        w[i] = rw * n;
+        x[i] = rx * n;
+        y[i] = ry * n;
+        z[i] = rz * n;
+    }
+}
+
+ArcballKernels const & select_kernels()
+{
+    ArcballKernels const * avx2 = avx2_kernels();
+    ArcballKernels const * sse2 = sse2_kernels();
+
+    char const * forced = std::getenv("ARCBALL_KERNELS");
+    if (forced) {
+        if (std::strcmp(forced, "scalar") == 0) {
+            return scalar_kernels();
+        } else if (std::strcmp(forced, "sse2") == 0 && sse2) {
+            return *sse2;
+        } else if (std::strcmp(forced, "avx2") == 0 && avx2) {
+            return *avx2;
+        }
+    }
+
+    if (avx2) {
+        return *avx2;
+    } else if (sse2) {
+        return *sse2;
+    } else {
+        return scalar_kernels();
+    }
+}
+
+}
+
+ArcballKernels const & arcball_kernels()
+{
+    static ArcballKernels const & kernels = select_kernels();
+    return kernels;
+}
+
+ArcballKernels const & scalar_kernels()
+{
+    static const ArcballKernels kernels = {
+        "scalar",
+        1,
+        project_to_ball_scalar,
+        constrain_to_scalar,
+        drag_compose_scalar,
+        spin_scalar,
+        slerp_scalar
+    };
+    return kernels;
+}
+
+ArcballKernels const * avx2_kernels()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return unchecked_avx2_kernels();
+    }
+#endif
+    return nullptr;
+}
@@ -0,0 +1,125 @@
+#ifndef ARCBALLKERNELS_HPP_INCLUDED
+#define ARCBALLKERNELS_HPP_INCLUDED
+
+// Vectorized versions of the arcball math operating on structure-of-arrays
+// data, where each array element belongs to a separate arcball or mouse
+// sample. Every kernel performs the same sequence of correctly rounded
+// operations as its scalar counterpart, so the vectorized kernels match the
+// scalar kernel bit for bit. The scalar kernel follows the operation order of
+// arcballmath and glm, results are guaranteed to be within 2 ULP per
+// component of arcballmath for a single evaluation. Note that differences
+// may grow when orientations are chained over many drags.
+
+// Project mouse position onto count balls, each inside its own viewport and
+// with its own center in window coordinates and radius.
+typedef void (*ProjectToBallKernel)(
+    unsigned int count,
+    float mouse_x,
+    float mouse_y,
+    float const * viewport_x,
+    float const * viewport_y,
+    float const * viewport_width,
+    float const * viewport_height,
+    float const * center_x,
+    float const * center_y,
+    float const * radius,
+    float * x,
+    float * y,
+    float * z);
+
+// Constrain count ball points to count axes, output may alias input.
+typedef void (*ConstrainKernel)(
+    unsigned int count,
+    float const * point_x,
+    float const * point_y,
+    float const * point_z,
+    float const * axis_x,
+    float const * axis_y,
+    float const * axis_z,
+    float * x,
+    float * y,
+    float * z);
+
+// Compose drag rotation from count drag arcs with count start orientations,
+// the eye orientation is shared and given as w, x, y and z.
+typedef void (*DragComposeKernel)(
+    unsigned int count,
+    float const * from_x,
+    float const * from_y,
+    float const * from_z,
+    float const * to_x,
+    float const * to_y,
+    float const * to_z,
+    float const eye[4],
+    float const * start_w,
+    float const * start_x,
+    float const * start_y,
+    float const * start_z,
+    float * now_w,
+    float * now_x,
+    float * now_y,
+    float * now_z);
+
+// Advance count spinning orientations by a single step of specified length in
+// seconds. Each orientation is rotated by its angular velocity in radians per
+// second around world axes, then the angular velocity is multiplied by
+// specified decay. The rotation of a step is a fourth order approximation of
+// the exact rotation, accurate to well below float precision for angles up to
+// a few degrees per step.
+typedef void (*SpinKernel)(
+    unsigned int count,
+    float step,
+    float decay,
+    float * velocity_x,
+    float * velocity_y,
+    float * velocity_z,
+    float * w,
+    float * x,
+    float * y,
+    float * z);
+
+// Interpolate count pairs of orientations, each at its own parameter between
+// zero and one, taking the shorter way around. Pairs less than about 1.6
+// degrees apart are interpolated linearly and normalized, which is within
+// float precision of the spherical interpolation at that angle. Other pairs
+// are interpolated by the angle between them, with the trigonometric
+// functions approximated by polynomials accurate to a few ULP. The result is
+// normalized, output may alias input.
+typedef void (*SlerpKernel)(
+    unsigned int count,
+    float const * t,
+    float const * from_w,
+    float const * from_x,
+    float const * from_y,
+    float const * from_z,
+    float const * to_w,
+    float const * to_x,
+    float const * to_y,
+    float const * to_z,
+    float * w,
+    float * x,
+    float * y,
+    float * z);
+
+struct ArcballKernels {
+    char const * name;
+    unsigned int width;
+    ProjectToBallKernel project_to_ball;
+    ConstrainKernel constrain_to;
+    DragComposeKernel drag_compose;
+    SpinKernel spin;
+    SlerpKernel slerp;
+};
+
+// Return kernels for the widest instruction set supported by the processor,
+// the choice can be overridden with the ARCBALL_KERNELS environment variable
+// set to "scalar", "sse2" or "avx2".
+ArcballKernels const & arcball_kernels();
+// Return scalar kernels, always available.
+ArcballKernels const & scalar_kernels();
+// Return SSE2 kernels or null if not built for this processor.
+ArcballKernels const * sse2_kernels();
+// Return AVX2 kernels or null if not built for this processor.
+ArcballKernels const * avx2_kernels();
+
+#endif
@@ -0,0 +1,50 @@
+#include "arcballkernels.hpp"
+
+// this file is compiled with AVX2 code generation enabled, nothing in here
+// may be called before the processor has been checked for AVX2 support
+#if defined(__AVX2__)
+
+#include "arcballkernelsimpl.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2Lanes {
+    typedef __m256 reg;
+    static const unsigned int width = 8;
+
+    static reg load(float const * p) { return _mm256_loadu_ps(p); }
+    static void store(float * p, reg a) { _mm256_storeu_ps(p, a); }
+    static reg set(float a) { return _mm256_set1_ps(a); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    static reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+    static reg sqrt(reg a) { return _mm256_sqrt_ps(a); }
+    static reg neg(reg a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static reg gt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static reg lt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static reg eq(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static reg select(reg mask, reg a, reg b) { return _mm256_blendv_ps(b, a, mask); }
+    static bool all(reg mask) { return _mm256_movemask_ps(mask) == 0xff; }
+};
+
+}
+
+ArcballKernels const * unchecked_avx2_kernels()
+{
+    static const ArcballKernels kernels = make_lanes_kernels<Avx2Lanes>("avx2");
+    return &kernels;
+}
+
+#else
+
+#include "arcballkernelsimpl.hpp"
+
+ArcballKernels const * unchecked_avx2_kernels()
+{
+    return nullptr;
+}
+
+#endif
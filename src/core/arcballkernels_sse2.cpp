@@ -0,0 +1,46 @@
+#include "arcballkernels.hpp"
+
+#if defined(__SSE2__)
+
+#include "arcballkernelsimpl.hpp"
+
+#include <emmintrin.h>
+
+namespace {
+
+struct Sse2Lanes {
+    typedef __m128 reg;
+    static const unsigned int width = 4;
+
+    static reg load(float const * p) { return _mm_loadu_ps(p); }
+    static void store(float * p, reg a) { _mm_storeu_ps(p, a); }
+    static reg set(float a) { return _mm_set1_ps(a); }
+    static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+    static reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+    static reg sqrt(reg a) { return _mm_sqrt_ps(a); }
+    static reg neg(reg a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static reg gt(reg a, reg b) { return _mm_cmpgt_ps(a, b); }
+    static reg lt(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+    static reg eq(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+    static reg select(reg mask, reg a, reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    static bool all(reg mask) { return _mm_movemask_ps(mask) == 0xf; }
+};
+
+}
+
+ArcballKernels const * sse2_kernels()
+{
+    static const ArcballKernels kernels = make_lanes_kernels<Sse2Lanes>("sse2");
+    return &kernels;
+}
+
+#else
+
+ArcballKernels const * sse2_kernels()
+{
+    return nullptr;
+}
+
+#endif
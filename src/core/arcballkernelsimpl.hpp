@@ -0,0 +1,488 @@
+#ifndef ARCBALLKERNELSIMPL_HPP_INCLUDED
+#define ARCBALLKERNELSIMPL_HPP_INCLUDED
+
+#include "arcballkernels.hpp"
+
+// Return AVX2 kernels without checking for processor support, or null if
+// the compiler could not generate AVX2 code.
+ArcballKernels const * unchecked_avx2_kernels();
+
+// Pairs of orientations with a dot product above this are interpolated
+// linearly by the slerp kernels, the half angle between them is at most
+// 0.0141 where the linear interpolation is off by less than 1e-7.
+const float slerp_linear_dot = 0.9999f;
+
+// Coefficients of the arc tangent on [-tan(pi / 8), tan(pi / 8)] and of the
+// series of sin(x) / x, used by the slerp kernels.
+const float atan_c0 = -3.33329491539e-1f;
+const float atan_c1 = 1.99777106478e-1f;
+const float atan_c2 = -1.38776856032e-1f;
+const float atan_c3 = 8.05374449538e-2f;
+const float tan_pi_8 = 0.414213562373f;
+const float quarter_pi = 0.785398163397f;
+const float sinc_c1 = 1.0f / 6.0f;
+const float sinc_c2 = 1.0f / 120.0f;
+const float sinc_c3 = 1.0f / 5040.0f;
+const float sinc_c4 = 1.0f / 362880.0f;
+const float sinc_c5 = 1.0f / 39916800.0f;
+
+// Kernel bodies shared by every instruction set. A lanes type provides the
+// register type, its width and the basic operations. The full registers are
+// processed here and the remaining elements are handed to the scalar kernels.
+// Each instruction set must instantiate these with a lanes type that has
+// internal linkage, since the instantiations are compiled with different
+// code generation flags.
+
+template <typename Lanes>
+void project_to_ball_lanes(
+    unsigned int count,
+    float mouse_x,
+    float mouse_y,
+    float const * viewport_x,
+    float const * viewport_y,
+    float const * viewport_width,
+    float const * viewport_height,
+    float const * center_x,
+    float const * center_y,
+    float const * radius,
+    float * x,
+    float * y,
+    float * z)
+{
+    typedef typename Lanes::reg reg;
+
+    const reg one = Lanes::set(1.0f);
+    const reg two = Lanes::set(2.0f);
+    const reg zero = Lanes::set(0.0f);
+    const reg mx = Lanes::set(mouse_x);
+    const reg my = Lanes::set(mouse_y);
+
+    unsigned int i = 0;
+    for (; i + Lanes::width <= count; i += Lanes::width) {
+        const reg r = Lanes::load(radius + i);
+
+        // window coordinate
+        reg wx = Lanes::mul(two, Lanes::sub(mx, Lanes::load(viewport_x + i)));
+        wx = Lanes::sub(Lanes::div(wx, Lanes::load(viewport_width + i)), one);
+        reg wy = Lanes::mul(two, Lanes::sub(my, Lanes::load(viewport_y + i)));
+        wy = Lanes::neg(Lanes::sub(Lanes::div(wy, Lanes::load(viewport_height + i)), one));
+
+        // ball coordinate
+        const reg px = Lanes::div(Lanes::sub(wx, Lanes::load(center_x + i)), r);
+        const reg py = Lanes::div(Lanes::sub(wy, Lanes::load(center_y + i)), r);
+        const reg length2 = Lanes::add(Lanes::mul(px, px), Lanes::mul(py, py));
+
+        const reg outside = Lanes::gt(length2, one);
+        const reg s = Lanes::div(one, Lanes::sqrt(length2));
+        const reg pz = Lanes::sqrt(Lanes::sub(one, length2));
+
+        Lanes::store(x + i, Lanes::select(outside, Lanes::mul(px, s), px));
+        Lanes::store(y + i, Lanes::select(outside, Lanes::mul(py, s), py));
+        Lanes::store(z + i, Lanes::select(outside, zero, pz));
+    }
+
+    scalar_kernels().project_to_ball(
+        count - i,
+        mouse_x,
+        mouse_y,
+        viewport_x + i,
+        viewport_y + i,
+        viewport_width + i,
+        viewport_height + i,
+        center_x + i,
+        center_y + i,
+        radius + i,
+        x + i,
+        y + i,
+        z + i);
+}
+
+template <typename Lanes>
+void constrain_to_lanes(
+    unsigned int count,
+    float const * point_x,
+    float const * point_y,
+    float const * point_z,
+    float const * axis_x,
+    float const * axis_y,
+    float const * axis_z,
+    float * x,
+    float * y,
+    float * z)
+{
+    typedef typename Lanes::reg reg;
+
+    const reg one = Lanes::set(1.0f);
+    const reg zero = Lanes::set(0.0f);
+
+    unsigned int i = 0;
+    for (; i + Lanes::width <= count; i += Lanes::width) {
+        const reg px = Lanes::load(point_x + i);
+        const reg py = Lanes::load(point_y + i);
+        const reg pz = Lanes::load(point_z + i);
+        const reg ax = Lanes::load(axis_x + i);
+        const reg ay = Lanes::load(axis_y + i);
+        const reg az = Lanes::load(axis_z + i);
+
+        // project onto plane perpendicular to the axis
+        const reg d = Lanes::add(Lanes::add(Lanes::mul(ax, px), Lanes::mul(ay, py)), Lanes::mul(az, pz));
+        const reg qx = Lanes::sub(px, Lanes::mul(ax, d));
+        const reg qy = Lanes::sub(py, Lanes::mul(ay, d));
+        const reg qz = Lanes::sub(pz, Lanes::mul(az, d));
+        const reg length = Lanes::sqrt(Lanes::add(Lanes::add(Lanes::mul(qx, qx), Lanes::mul(qy, qy)), Lanes::mul(qz, qz)));
+
+        reg s = Lanes::div(one, length);
+        s = Lanes::select(Lanes::lt(qz, zero), Lanes::neg(s), s);
+
+        // the point lies on the axis, pick any point on the plane
+        const reg nx = Lanes::neg(ay);
+        const reg n = Lanes::div(one, Lanes::sqrt(Lanes::add(Lanes::add(Lanes::mul(nx, nx), Lanes::mul(ax, ax)), Lanes::mul(zero, zero))));
+        const reg front = Lanes::eq(az, one);
+        const reg fx = Lanes::select(front, one, Lanes::mul(nx, n));
+        const reg fy = Lanes::select(front, zero, Lanes::mul(ax, n));
+
+        const reg valid = Lanes::gt(length, zero);
+        Lanes::store(x + i, Lanes::select(valid, Lanes::mul(qx, s), fx));
+        Lanes::store(y + i, Lanes::select(valid, Lanes::mul(qy, s), fy));
+        Lanes::store(z + i, Lanes::select(valid, Lanes::mul(qz, s), zero));
+    }
+
+    scalar_kernels().constrain_to(
+        count - i,
+        point_x + i,
+        point_y + i,
+        point_z + i,
+        axis_x + i,
+        axis_y + i,
+        axis_z + i,
+        x + i,
+        y + i,
+        z + i);
+}
+
+template <typename Lanes>
+void drag_compose_lanes(
+    unsigned int count,
+    float const * from_x,
+    float const * from_y,
+    float const * from_z,
+    float const * to_x,
+    float const * to_y,
+    float const * to_z,
+    float const eye[4],
+    float const * start_w,
+    float const * start_x,
+    float const * start_y,
+    float const * start_z,
+    float * now_w,
+    float * now_x,
+    float * now_y,
+    float * now_z)
+{
+    typedef typename Lanes::reg reg;
+
+    const reg zero = Lanes::set(0.0f);
+    const reg one = Lanes::set(1.0f);
+    const reg two = Lanes::set(2.0f);
+    const reg ew = Lanes::set(eye[0]);
+    const reg ex = Lanes::set(eye[1]);
+    const reg ey = Lanes::set(eye[2]);
+    const reg ez = Lanes::set(eye[3]);
+
+    unsigned int i = 0;
+    for (; i + Lanes::width <= count; i += Lanes::width) {
+        const reg fx = Lanes::load(from_x + i);
+        const reg fy = Lanes::load(from_y + i);
+        const reg fz = Lanes::load(from_z + i);
+        const reg tx = Lanes::load(to_x + i);
+        const reg ty = Lanes::load(to_y + i);
+        const reg tz = Lanes::load(to_z + i);
+
+        // drag rotation
+        const reg pw = Lanes::add(Lanes::add(Lanes::mul(fx, tx), Lanes::mul(fy, ty)), Lanes::mul(fz, tz));
+        const reg cx = Lanes::sub(Lanes::mul(fy, tz), Lanes::mul(ty, fz));
+        const reg cy = Lanes::sub(Lanes::mul(fz, tx), Lanes::mul(tz, fx));
+        const reg cz = Lanes::sub(Lanes::mul(fx, ty), Lanes::mul(tx, fy));
+
+        // rotate rotation axis into eye space
+        const reg uvx = Lanes::sub(Lanes::mul(ey, cz), Lanes::mul(cy, ez));
+        const reg uvy = Lanes::sub(Lanes::mul(ez, cx), Lanes::mul(cz, ex));
+        const reg uvz = Lanes::sub(Lanes::mul(ex, cy), Lanes::mul(cx, ey));
+        const reg uuvx = Lanes::sub(Lanes::mul(ey, uvz), Lanes::mul(uvy, ez));
+        const reg uuvy = Lanes::sub(Lanes::mul(ez, uvx), Lanes::mul(uvz, ex));
+        const reg uuvz = Lanes::sub(Lanes::mul(ex, uvy), Lanes::mul(uvx, ey));
+        const reg px = Lanes::add(cx, Lanes::mul(Lanes::add(Lanes::mul(uvx, ew), uuvx), two));
+        const reg py = Lanes::add(cy, Lanes::mul(Lanes::add(Lanes::mul(uvy, ew), uuvy), two));
+        const reg pz = Lanes::add(cz, Lanes::mul(Lanes::add(Lanes::mul(uvz, ew), uuvz), two));
+
+        // combine with start orientation
+        const reg qw = Lanes::load(start_w + i);
+        const reg qx = Lanes::load(start_x + i);
+        const reg qy = Lanes::load(start_y + i);
+        const reg qz = Lanes::load(start_z + i);
+        const reg rw = Lanes::sub(Lanes::sub(Lanes::sub(Lanes::mul(pw, qw), Lanes::mul(px, qx)), Lanes::mul(py, qy)), Lanes::mul(pz, qz));
+        const reg rx = Lanes::sub(Lanes::add(Lanes::add(Lanes::mul(pw, qx), Lanes::mul(px, qw)), Lanes::mul(py, qz)), Lanes::mul(pz, qy));
+        const reg ry = Lanes::sub(Lanes::add(Lanes::add(Lanes::mul(pw, qy), Lanes::mul(py, qw)), Lanes::mul(pz, qx)), Lanes::mul(px, qz));
+        const reg rz = Lanes::sub(Lanes::add(Lanes::add(Lanes::mul(pw, qz), Lanes::mul(pz, qw)), Lanes::mul(px, qy)), Lanes::mul(py, qx));
+
+        // normalize
+        const reg length = Lanes::sqrt(Lanes::add(
+            Lanes::add(Lanes::mul(rx, rx), Lanes::mul(ry, ry)),
+            Lanes::add(Lanes::mul(rz, rz), Lanes::mul(rw, rw))));
+        const reg valid = Lanes::gt(length, zero);
+        const reg s = Lanes::div(one, length);
+
+        Lanes::store(now_w + i, Lanes::select(valid, Lanes::mul(rw, s), one));
+        Lanes::store(now_x + i, Lanes::select(valid, Lanes::mul(rx, s), zero));
+        Lanes::store(now_y + i, Lanes::select(valid, Lanes::mul(ry, s), zero));
+        Lanes::store(now_z + i, Lanes::select(valid, Lanes::mul(rz, s), zero));
+    }
+
+    scalar_kernels().drag_compose(
+        count - i,
+        from_x + i,
+        from_y + i,
+        from_z + i,
+        to_x + i,
+        to_y + i,
+        to_z + i,
+        eye,
+        start_w + i,
+        start_x + i,
+        start_y + i,
+        start_z + i,
+        now_w + i,
+        now_x + i,
+        now_y + i,
+        now_z + i);
+}
+
+template <typename Lanes>
+void spin_lanes(
+    unsigned int count,
+    float step,
+    float decay,
+    float * velocity_x,
+    float * velocity_y,
+    float * velocity_z,
+    float * w,
+    float * x,
+    float * y,
+    float * z)
+{
+    typedef typename Lanes::reg reg;
+
+    const reg one = Lanes::set(1.0f);
+    const reg half = Lanes::set(0.5f);
+    const reg sixth = Lanes::set(1.0f / 6.0f);
+    const reg inverse24 = Lanes::set(1.0f / 24.0f);
+    const reg inverse120 = Lanes::set(1.0f / 120.0f);
+    const reg half_step = Lanes::set(0.5f * step);
+    const reg d = Lanes::set(decay);
+
+    unsigned int i = 0;
+    for (; i + Lanes::width <= count; i += Lanes::width) {
+        const reg vx = Lanes::load(velocity_x + i);
+        const reg vy = Lanes::load(velocity_y + i);
+        const reg vz = Lanes::load(velocity_z + i);
+
+        // rotation of the step
+        const reg hx = Lanes::mul(vx, half_step);
+        const reg hy = Lanes::mul(vy, half_step);
+        const reg hz = Lanes::mul(vz, half_step);
+        const reg angle2 = Lanes::add(Lanes::add(Lanes::mul(hx, hx), Lanes::mul(hy, hy)), Lanes::mul(hz, hz));
+        const reg pw = Lanes::sub(one, Lanes::mul(angle2, Lanes::sub(half, Lanes::mul(angle2, inverse24))));
+        const reg sinc = Lanes::sub(one, Lanes::mul(angle2, Lanes::sub(sixth, Lanes::mul(angle2, inverse120))));
+        const reg px = Lanes::mul(hx, sinc);
+        const reg py = Lanes::mul(hy, sinc);
+        const reg pz = Lanes::mul(hz, sinc);
+
+        // combine with current orientation
+        const reg qw = Lanes::load(w + i);
+        const reg qx = Lanes::load(x + i);
+        const reg qy = Lanes::load(y + i);
+        const reg qz = Lanes::load(z + i);
+        const reg rw = Lanes::sub(Lanes::sub(Lanes::sub(Lanes::mul(pw, qw), Lanes::mul(px, qx)), Lanes::mul(py, qy)), Lanes::mul(pz, qz));
+        const reg rx = Lanes::sub(Lanes::add(Lanes::add(Lanes::mul(pw, qx), Lanes::mul(px, qw)), Lanes::mul(py, qz)), Lanes::mul(pz, qy));
+        const reg ry = Lanes::sub(Lanes::add(Lanes::add(Lanes::mul(pw, qy), Lanes::mul(py, qw)), Lanes::mul(pz, qx)), Lanes::mul(px, qz));
+        const reg rz = Lanes::sub(Lanes::add(Lanes::add(Lanes::mul(pw, qz), Lanes::mul(pz, qw)), Lanes::mul(px, qy)), Lanes::mul(py, qx));
+
+        // normalize
+        const reg s = Lanes::div(one, Lanes::sqrt(Lanes::add(
+            Lanes::add(Lanes::mul(rx, rx), Lanes::mul(ry, ry)),
+            Lanes::add(Lanes::mul(rz, rz), Lanes::mul(rw, rw)))));
+        Lanes::store(w + i, Lanes::mul(rw, s));
+        Lanes::store(x + i, Lanes::mul(rx, s));
+        Lanes::store(y + i, Lanes::mul(ry, s));
+        Lanes::store(z + i, Lanes::mul(rz, s));
+
+        Lanes::store(velocity_x + i, Lanes::mul(vx, d));
+        Lanes::store(velocity_y + i, Lanes::mul(vy, d));
+        Lanes::store(velocity_z + i, Lanes::mul(vz, d));
+    }
+
+    scalar_kernels().spin(
+        count - i,
+        step,
+        decay,
+        velocity_x + i,
+        velocity_y + i,
+        velocity_z + i,
+        w + i,
+        x + i,
+        y + i,
+        z + i);
+}
+
+// sin(x) / x from x squared, for x up to pi / 2
+template <typename Lanes>
+typename Lanes::reg sinc_lanes(typename Lanes::reg x2)
+{
+    typedef typename Lanes::reg reg;
+
+    reg s = Lanes::sub(Lanes::set(sinc_c4), Lanes::mul(x2, Lanes::set(sinc_c5)));
+    s = Lanes::sub(Lanes::set(sinc_c3), Lanes::mul(x2, s));
+    s = Lanes::sub(Lanes::set(sinc_c2), Lanes::mul(x2, s));
+    s = Lanes::sub(Lanes::set(sinc_c1), Lanes::mul(x2, s));
+    return Lanes::sub(Lanes::set(1.0f), Lanes::mul(x2, s));
+}
+
+template <typename Lanes>
+void slerp_lanes(
+    unsigned int count,
+    float const * t,
+    float const * from_w,
+    float const * from_x,
+    float const * from_y,
+    float const * from_z,
+    float const * to_w,
+    float const * to_x,
+    float const * to_y,
+    float const * to_z,
+    float * w,
+    float * x,
+    float * y,
+    float * z)
+{
+    typedef typename Lanes::reg reg;
+
+    const reg zero = Lanes::set(0.0f);
+    const reg one = Lanes::set(1.0f);
+    const reg two = Lanes::set(2.0f);
+    const reg linear_dot = Lanes::set(slerp_linear_dot);
+
+    unsigned int i = 0;
+    for (; i + Lanes::width <= count; i += Lanes::width) {
+        const reg aw = Lanes::load(from_w + i);
+        const reg ax = Lanes::load(from_x + i);
+        const reg ay = Lanes::load(from_y + i);
+        const reg az = Lanes::load(from_z + i);
+        reg bw = Lanes::load(to_w + i);
+        reg bx = Lanes::load(to_x + i);
+        reg by = Lanes::load(to_y + i);
+        reg bz = Lanes::load(to_z + i);
+        const reg tt = Lanes::load(t + i);
+        const reg s = Lanes::sub(one, tt);
+
+        // take the shorter way around
+        reg d = Lanes::add(
+            Lanes::add(Lanes::mul(ax, bx), Lanes::mul(ay, by)),
+            Lanes::add(Lanes::mul(az, bz), Lanes::mul(aw, bw)));
+        const reg flip = Lanes::lt(d, zero);
+        bw = Lanes::select(flip, Lanes::neg(bw), bw);
+        bx = Lanes::select(flip, Lanes::neg(bx), bx);
+        by = Lanes::select(flip, Lanes::neg(by), by);
+        bz = Lanes::select(flip, Lanes::neg(bz), bz);
+        d = Lanes::select(flip, Lanes::neg(d), d);
+
+        // weights of the linear interpolation, the angle is only needed when
+        // some pair is too far apart for it
+        reg wa = s;
+        reg wb = tt;
+        const reg linear = Lanes::gt(d, linear_dot);
+        if (!Lanes::all(linear)) {
+            // the half angle between the orientations is less than a right
+            // angle, the tangent of half of it is at most one
+            const reg mw = Lanes::sub(bw, aw);
+            const reg mx = Lanes::sub(bx, ax);
+            const reg my = Lanes::sub(by, ay);
+            const reg mz = Lanes::sub(bz, az);
+            const reg pw = Lanes::add(bw, aw);
+            const reg px = Lanes::add(bx, ax);
+            const reg py = Lanes::add(by, ay);
+            const reg pz = Lanes::add(bz, az);
+            const reg m2 = Lanes::add(
+                Lanes::add(Lanes::mul(mx, mx), Lanes::mul(my, my)),
+                Lanes::add(Lanes::mul(mz, mz), Lanes::mul(mw, mw)));
+            const reg p2 = Lanes::add(
+                Lanes::add(Lanes::mul(px, px), Lanes::mul(py, py)),
+                Lanes::add(Lanes::mul(pz, pz), Lanes::mul(pw, pw)));
+            reg r = Lanes::sqrt(Lanes::div(m2, p2));
+
+            // arc tangent, reduced around a quarter pi
+            const reg reduce = Lanes::gt(r, Lanes::set(tan_pi_8));
+            r = Lanes::select(reduce, Lanes::div(Lanes::sub(r, one), Lanes::add(r, one)), r);
+            const reg base = Lanes::select(reduce, Lanes::set(quarter_pi), zero);
+            const reg r2 = Lanes::mul(r, r);
+            reg a = Lanes::add(Lanes::mul(r2, Lanes::set(atan_c3)), Lanes::set(atan_c2));
+            a = Lanes::add(Lanes::mul(a, r2), Lanes::set(atan_c1));
+            a = Lanes::add(Lanes::mul(a, r2), Lanes::set(atan_c0));
+            a = Lanes::add(Lanes::add(Lanes::mul(Lanes::mul(a, r2), r), r), base);
+            const reg angle = Lanes::mul(two, a);
+
+            // sin(s * angle) / sin(angle) and sin(t * angle) / sin(angle)
+            const reg sa = Lanes::mul(s, angle);
+            const reg ta = Lanes::mul(tt, angle);
+            const reg inverse = Lanes::div(one, sinc_lanes<Lanes>(Lanes::mul(angle, angle)));
+            wa = Lanes::select(linear, wa, Lanes::mul(Lanes::mul(s, sinc_lanes<Lanes>(Lanes::mul(sa, sa))), inverse));
+            wb = Lanes::select(linear, wb, Lanes::mul(Lanes::mul(tt, sinc_lanes<Lanes>(Lanes::mul(ta, ta))), inverse));
+        }
+
+        const reg rw = Lanes::add(Lanes::mul(wa, aw), Lanes::mul(wb, bw));
+        const reg rx = Lanes::add(Lanes::mul(wa, ax), Lanes::mul(wb, bx));
+        const reg ry = Lanes::add(Lanes::mul(wa, ay), Lanes::mul(wb, by));
+        const reg rz = Lanes::add(Lanes::mul(wa, az), Lanes::mul(wb, bz));
+
+        // normalize, the length is never zero since both weights are
+        // positive and the orientations on the same side
+        const reg n = Lanes::div(one, Lanes::sqrt(Lanes::add(
+            Lanes::add(Lanes::mul(rx, rx), Lanes::mul(ry, ry)),
+            Lanes::add(Lanes::mul(rz, rz), Lanes::mul(rw, rw)))));
+        Lanes::store(w + i, Lanes::mul(rw, n));
+        Lanes::store(x + i, Lanes::mul(rx, n));
+        Lanes::store(y + i, Lanes::mul(ry, n));
+        Lanes::store(z + i, Lanes::mul(rz, n));
+    }
+
+    scalar_kernels().slerp(
+        count - i,
+        t + i,
+        from_w + i,
+        from_x + i,
+        from_y + i,
+        from_z + i,
+        to_w + i,
+        to_x + i,
+        to_y + i,
+        to_z + i,
+        w + i,
+        x + i,
+        y + i,
+        z + i);
+}
+
+template <typename Lanes>
+ArcballKernels make_lanes_kernels(char const * name)
+{
+    ArcballKernels kernels;
+    kernels.name = name;
+    kernels.width = Lanes::width;
+    kernels.project_to_ball = project_to_ball_lanes<Lanes>;
+    kernels.constrain_to = constrain_to_lanes<Lanes>;
+    kernels.drag_compose = drag_compose_lanes<Lanes>;
+    kernels.spin = spin_lanes<Lanes>;
+    kernels.slerp = slerp_lanes<Lanes>;
+    return kernels;
+}
+
+#endif
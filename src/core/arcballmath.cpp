@@ -0,0 +1,134 @@
+#include "arcballmath.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+#include <cmath>
+#include <limits>
+
+// return window coordinate from mouse position
+glm::vec3 window_coord(
+    float viewport_x,
+    float viewport_y,
+    float viewport_width,
+    float viewport_height,
+    glm::ivec2 mouse_position)
+{
+    return glm::vec3(
+        2.0f * (mouse_position.x - viewport_x) / viewport_width - 1.0f,
+        -(2.0f * (mouse_position.y - viewport_y) / viewport_height - 1.0f),
+        0.0f
+    );
+}
+
+// return coordinate on the ball centered in the viewport from window
+// coordinate
+glm::vec3 ball_coord(glm::vec3 window_position, float radius)
+{
+    return ball_coord(window_position, glm::vec2(0.0f), radius);
+}
+
+// return coordinate on the ball from window coordinate, the center is the
+// projected object position in window coordinates
+glm::vec3 ball_coord(glm::vec3 window_position, glm::vec2 center, float radius)
+{
+    glm::vec3 point = (window_position - glm::vec3(center, 0.0f)) / radius;
+
+    float r = glm::length2(point);
+    if (r > 1.0f) {
+        // set to nearest point on ball
+        point *= (1.0f / std::sqrt(r));
+    } else {
+        // point on ball
+        point.z = std::sqrt(1.0f - r);
+    }
+
+    return point;
+}
+
+// return specified ball point constrained to specified axis by projecting the
+// ball point onto a perpendicular plane relative to the constraint axis, the
+// ball point is also flipped to the front when necessary
+glm::vec3 constrain_to(glm::vec3 point, glm::vec3 axis)
+{
+    glm::vec3 point_on_plane;
+    glm::vec3 proj = point - (axis * glm::dot(axis, point));
+
+    float length = glm::length(proj);
+    if (length > 0.0f) {
+        float s = 1.0f / length;
+        if (proj.z < 0.0f) {
+            s = -s;
+        }
+        point_on_plane = proj * s;
+    } else if (axis.z == 1.0f) {
+        point_on_plane = glm::vec3(1.0f, 0.0f, 0.0f);
+    } else {
+        point_on_plane = glm::normalize(glm::vec3(-axis.y, axis.x, 0.0f));
+    }
+
+    return point_on_plane;
+}
+
+// return index for nearest arc relative to specified point
+unsigned int nearest_constraint(
+    glm::vec3 ball_point,
+    glm::vec3 const * axes,
+    unsigned int count)
+{
+    float max = -std::numeric_limits<float>::infinity();
+    unsigned int nearest = 0;
+
+    for (unsigned int i = 0; i < count; i++) {
+        glm::vec3 point_on_plane = constrain_to(ball_point, axes[i]);
+        float dot = glm::dot(point_on_plane, ball_point);
+        // selects instead of a branch since which axis is nearest is not
+        // predictable while the mouse moves around the ball
+        const bool nearer = dot > max;
+        max = nearer ? dot : max;
+        nearest = nearer ? i : nearest;
+    }
+
+    return nearest;
+}
+
+// from the two clicked points on the ball we construct a quaternion that
+// represents the rotation which rotates the ball from the initial point to the
+// end point, the quaternion vector (or rotation axis) is brought into eye space
+glm::quat drag_rotation(glm::vec3 from, glm::vec3 to, glm::quat eye)
+{
+    float w = glm::dot(from, to);
+    glm::vec3 v = eye * glm::cross(from, to);
+    return glm::quat(w, v);
+}
+
+// convert the orienation to two points on the ball, this is the shortest arc
+// for obtaining the orientation from the identity orientation
+Arc result_arc(glm::quat q)
+{
+    Arc result;
+
+    // pick an initial point that is perpendicular to the quaternion vector
+    float s = std::sqrt(q.x * q.x + q.y * q.y);
+    if (s == 0.0f) {
+        result.from.x = 0.0f;
+        result.from.y = 1.0f;
+        result.from.z = 0.0f;
+    } else {
+        result.from.x = -q.y / s;
+        result.from.y = q.x / s;
+        result.from.z = 0.0f;
+    }
+
+    result.to.x = q.w * result.from.x - q.z * result.from.y;
+    result.to.y = q.w * result.from.y + q.z * result.from.x;
+    result.to.z = q.x * result.from.y - q.y * result.from.x;
+
+    // negate initial ball point for a shorter arc
+    if (q.w < 0.0f) {
+        result.from.x = -result.from.x;
+        result.from.y = -result.from.y;
+        result.from.z = 0.0f;
+    }
+
+    return result;
+}
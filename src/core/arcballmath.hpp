@@ -0,0 +1,51 @@
+#ifndef ARCBALLMATH_HPP_INCLUDED
+#define ARCBALLMATH_HPP_INCLUDED
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+enum class AxisSet {
+    NONE,
+    CAMERA,
+    BODY,
+    WORLD,
+    CUSTOM
+};
+
+struct Arc {
+    glm::vec3 from;
+    glm::vec3 to;
+};
+
+// The arcball math shared by every arcball implementation, kept free of
+// arcball state so that a single arcball and a batch of arcballs produce
+// identical results.
+
+// Return window coordinate from mouse position inside specified viewport.
+glm::vec3 window_coord(
+    float viewport_x,
+    float viewport_y,
+    float viewport_width,
+    float viewport_height,
+    glm::ivec2 mouse_position);
+// Return coordinate on ball with specified radius centered in the viewport
+// from window coordinate.
+glm::vec3 ball_coord(glm::vec3 window_position, float radius);
+// Return coordinate on ball with specified center and radius in window
+// coordinates from window coordinate.
+glm::vec3 ball_coord(glm::vec3 window_position, glm::vec2 center, float radius);
+// Return ball point constrained to specified axis.
+glm::vec3 constrain_to(glm::vec3 point, glm::vec3 axis);
+// Return index of the axis whose constrained arc is nearest specified ball
+// point. Every axis is evaluated and the index is selected without branching.
+unsigned int nearest_constraint(
+    glm::vec3 ball_point,
+    glm::vec3 const * axes,
+    unsigned int count);
+// Return rotation which rotates the ball from one point to another, the
+// rotation axis is brought into eye space.
+glm::quat drag_rotation(glm::vec3 from, glm::vec3 to, glm::quat eye);
+// Return shortest arc for obtaining specified orientation.
+Arc result_arc(glm::quat orientation);
+
+#endif
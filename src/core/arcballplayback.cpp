@@ -0,0 +1,455 @@
+#include "arcballplayback.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const unsigned int none = std::numeric_limits<unsigned int>::max();
+
+// logarithm of a rotation, the axis scaled by half the angle
+glm::vec3 log_rotation(glm::quat q)
+{
+    const glm::vec3 v(q.x, q.y, q.z);
+    const float s = glm::length(v);
+    if (s == 0.0f) {
+        return glm::vec3(0.0f);
+    }
+    return v * (std::atan2(s, q.w) / s);
+}
+
+// rotation of a logarithm
+glm::quat exp_rotation(glm::vec3 v)
+{
+    const float angle = glm::length(v);
+    if (angle == 0.0f) {
+        return glm::quat();
+    }
+    return glm::quat(std::cos(angle), v * (std::sin(angle) / angle));
+}
+
+glm::quat slerp_scalar(glm::quat a, glm::quat b, float t)
+{
+    glm::quat r;
+    scalar_kernels().slerp(1, &t, &a.w, &a.x, &a.y, &a.z, &b.w, &b.x, &b.y, &b.z, &r.w, &r.x, &r.y, &r.z);
+    return r;
+}
+
+// parameter of specified time within the segment of a track starting at
+// keyframe with specified index
+float segment_parameter(OrientationTrack const & track, unsigned int index, float time)
+{
+    if (track.size() < 2) {
+        return 0.0f;
+    }
+    const float start = track.get_time(index);
+    const float t = (time - start) / (track.get_time(index + 1) - start);
+    return std::min(std::max(t, 0.0f), 1.0f);
+}
+
+// keyframe that ends the segment starting at specified index
+unsigned int segment_end(OrientationTrack const & track, unsigned int index)
+{
+    return std::min(index + 1, track.size() - 1);
+}
+
+}
+
+OrientationTrack::OrientationTrack(Interpolation interpolation)
+    : interpolation(interpolation)
+{
+}
+
+void OrientationTrack::add(float time, glm::quat orientation)
+{
+    const auto it = std::lower_bound(times.begin(), times.end(), time);
+    const unsigned int index = it - times.begin();
+
+    // a keyframe in front is put on the side of the one after it, any other
+    // is flipped onto the side of the one before it below
+    if (index == 0 && !times.empty() && glm::dot(orientation, orientations[0]) < 0.0f) {
+        orientation = -orientation;
+    }
+
+    if (it != times.end() && *it == time) {
+        orientations[index] = orientation;
+    } else {
+        times.insert(it, time);
+        orientations.insert(orientations.begin() + index, orientation);
+        controls.insert(controls.begin() + index, orientation);
+    }
+
+    // keep every keyframe on the side of the one before, the ones after the
+    // new keyframe only need to flip if it is not between its neighbours
+    for (unsigned int i = std::max(index, 1u); i < orientations.size(); i++) {
+        if (glm::dot(orientations[i - 1], orientations[i]) >= 0.0f) {
+            if (i > index) {
+                break;
+            }
+            continue;
+        }
+        orientations[i] = -orientations[i];
+        controls[i] = -controls[i];
+    }
+
+    const unsigned int first = index > 0 ? index - 1 : 0;
+    const unsigned int last = std::min(index + 2, size());
+    for (unsigned int i = first; i < last; i++) {
+        update_control(i);
+    }
+}
+
+void OrientationTrack::clear()
+{
+    times.clear();
+    orientations.clear();
+    controls.clear();
+}
+
+unsigned int OrientationTrack::size() const
+{
+    return times.size();
+}
+
+Interpolation OrientationTrack::get_interpolation() const
+{
+    return interpolation;
+}
+
+float OrientationTrack::get_start() const
+{
+    return times.empty() ? 0.0f : times.front();
+}
+
+float OrientationTrack::get_end() const
+{
+    return times.empty() ? 0.0f : times.back();
+}
+
+unsigned int OrientationTrack::find(float time, unsigned int hint) const
+{
+    if (times.size() < 2) {
+        return 0;
+    }
+    const unsigned int last = times.size() - 2;
+    hint = std::min(hint, last);
+
+    // the segment of the hint or the one after it
+    if (time >= times[hint]) {
+        if (hint == last || time < times[hint + 1]) {
+            return hint;
+        }
+        if (hint + 1 == last || time < times[hint + 2]) {
+            return hint + 1;
+        }
+    } else if (hint == 0) {
+        return 0;
+    }
+
+    const unsigned int after = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+    return std::min(std::max(after, 1u) - 1, last);
+}
+
+float OrientationTrack::get_time(unsigned int index) const
+{
+    return times[index];
+}
+
+glm::quat OrientationTrack::get_orientation(unsigned int index) const
+{
+    return orientations[index];
+}
+
+glm::quat OrientationTrack::get_control(unsigned int index) const
+{
+    return controls[index];
+}
+
+glm::quat OrientationTrack::sample(float time) const
+{
+    if (times.empty()) {
+        return glm::quat();
+    }
+
+    const unsigned int index = find(time);
+    const unsigned int next = segment_end(*this, index);
+    const float t = segment_parameter(*this, index, time);
+
+    const glm::quat q = slerp_scalar(orientations[index], orientations[next], t);
+    if (interpolation == Interpolation::SLERP) {
+        return q;
+    }
+    const glm::quat c = slerp_scalar(controls[index], controls[next], t);
+    return slerp_scalar(q, c, 2.0f * t * (1.0f - t));
+}
+
+// the control orientation of a keyframe makes the rate of turn continuous
+// through it, the first and last keyframe are their own control
+void OrientationTrack::update_control(unsigned int index)
+{
+    const glm::quat q = orientations[index];
+    if (interpolation == Interpolation::SLERP || index == 0 || index + 1 == size()) {
+        controls[index] = q;
+        return;
+    }
+
+    const glm::quat inverse = glm::conjugate(q);
+    const glm::vec3 next = log_rotation(inverse * orientations[index + 1]);
+    const glm::vec3 previous = log_rotation(inverse * orientations[index - 1]);
+    controls[index] = glm::normalize(q * exp_rotation((next + previous) * -0.25f));
+}
+
+ArcballPlayback::ArcballPlayback()
+    : kernels(&arcball_kernels())
+{
+}
+
+void ArcballPlayback::play(
+    unsigned int id,
+    std::shared_ptr<OrientationTrack const> track,
+    float time,
+    bool loop)
+{
+    stop(id);
+
+    if (id >= indices.size()) {
+        indices.resize(id + 1, none);
+    }
+    indices[id] = ids.size();
+
+    const glm::quat orientation = track->sample(time);
+    ids.push_back(id);
+    times.push_back(time);
+    segments.push_back(track->find(time));
+    loops.push_back(loop);
+    ended.push_back(!loop && time >= track->get_end());
+    orientation_w.push_back(orientation.w);
+    orientation_x.push_back(orientation.x);
+    orientation_y.push_back(orientation.y);
+    orientation_z.push_back(orientation.z);
+    tracks.push_back(std::move(track));
+}
+
+void ArcballPlayback::stop(unsigned int id)
+{
+    if (is_playing(id)) {
+        remove(indices[id]);
+    }
+}
+
+void ArcballPlayback::clear()
+{
+    while (!ids.empty()) {
+        remove(ids.size() - 1);
+    }
+}
+
+void ArcballPlayback::advance(float delta)
+{
+    const unsigned int count = ids.size();
+    slots.resize(count);
+    t.resize(count);
+    from_w.resize(count);
+    from_x.resize(count);
+    from_y.resize(count);
+    from_z.resize(count);
+    to_w.resize(count);
+    to_x.resize(count);
+    to_y.resize(count);
+    to_z.resize(count);
+    sample_w.resize(count);
+    sample_x.resize(count);
+    sample_y.resize(count);
+    sample_z.resize(count);
+
+    unsigned int squads = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        squads += tracks[i]->get_interpolation() == Interpolation::SQUAD;
+    }
+
+    // gather the segment of every arcball at its new time
+    unsigned int next_squad = 0;
+    unsigned int next_slerp = squads;
+    for (unsigned int i = 0; i < count; i++) {
+        OrientationTrack const & track = *tracks[i];
+        const float start = track.get_start();
+        const float end = track.get_end();
+
+        float time = times[i] + delta;
+        if (loops[i] && time > end && end > start) {
+            time = start + std::fmod(time - start, end - start);
+        }
+        times[i] = time;
+        ended[i] = !loops[i] && time >= end;
+
+        const unsigned int slot = track.get_interpolation() == Interpolation::SQUAD ? next_squad++ : next_slerp++;
+        slots[i] = slot;
+
+        if (track.size() == 0) {
+            t[slot] = 0.0f;
+            from_w[slot] = to_w[slot] = 1.0f;
+            from_x[slot] = to_x[slot] = 0.0f;
+            from_y[slot] = to_y[slot] = 0.0f;
+            from_z[slot] = to_z[slot] = 0.0f;
+            continue;
+        }
+
+        const unsigned int index = track.find(time, segments[i]);
+        const unsigned int next = segment_end(track, index);
+        segments[i] = index;
+        t[slot] = segment_parameter(track, index, time);
+
+        const glm::quat from = track.get_orientation(index);
+        const glm::quat to = track.get_orientation(next);
+        from_w[slot] = from.w;
+        from_x[slot] = from.x;
+        from_y[slot] = from.y;
+        from_z[slot] = from.z;
+        to_w[slot] = to.w;
+        to_x[slot] = to.x;
+        to_y[slot] = to.y;
+        to_z[slot] = to.z;
+    }
+
+    kernels->slerp(
+        count,
+        t.data(),
+        from_w.data(),
+        from_x.data(),
+        from_y.data(),
+        from_z.data(),
+        to_w.data(),
+        to_x.data(),
+        to_y.data(),
+        to_z.data(),
+        sample_w.data(),
+        sample_x.data(),
+        sample_y.data(),
+        sample_z.data());
+
+    if (squads > 0) {
+        // squad interpolates the keyframes and their controls, then between
+        // the two
+        for (unsigned int i = 0; i < count; i++) {
+            const unsigned int slot = slots[i];
+            OrientationTrack const & track = *tracks[i];
+            if (slot >= squads || track.size() == 0) {
+                continue;
+            }
+
+            const unsigned int index = segments[i];
+            const glm::quat from = track.get_control(index);
+            const glm::quat to = track.get_control(segment_end(track, index));
+            from_w[slot] = from.w;
+            from_x[slot] = from.x;
+            from_y[slot] = from.y;
+            from_z[slot] = from.z;
+            to_w[slot] = to.w;
+            to_x[slot] = to.x;
+            to_y[slot] = to.y;
+            to_z[slot] = to.z;
+        }
+
+        kernels->slerp(
+            squads,
+            t.data(),
+            from_w.data(),
+            from_x.data(),
+            from_y.data(),
+            from_z.data(),
+            to_w.data(),
+            to_x.data(),
+            to_y.data(),
+            to_z.data(),
+            to_w.data(),
+            to_x.data(),
+            to_y.data(),
+            to_z.data());
+
+        for (unsigned int slot = 0; slot < squads; slot++) {
+            t[slot] = 2.0f * t[slot] * (1.0f - t[slot]);
+        }
+
+        kernels->slerp(
+            squads,
+            t.data(),
+            sample_w.data(),
+            sample_x.data(),
+            sample_y.data(),
+            sample_z.data(),
+            to_w.data(),
+            to_x.data(),
+            to_y.data(),
+            to_z.data(),
+            sample_w.data(),
+            sample_x.data(),
+            sample_y.data(),
+            sample_z.data());
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        const unsigned int slot = slots[i];
+        orientation_w[i] = sample_w[slot];
+        orientation_x[i] = sample_x[slot];
+        orientation_y[i] = sample_y[slot];
+        orientation_z[i] = sample_z[slot];
+    }
+}
+
+bool ArcballPlayback::is_playing(unsigned int id) const
+{
+    return id < indices.size() && indices[id] != none;
+}
+
+bool ArcballPlayback::has_ended(unsigned int id) const
+{
+    return ended[indices[id]];
+}
+
+glm::quat ArcballPlayback::get_orientation(unsigned int id) const
+{
+    const unsigned int index = indices[id];
+    return glm::quat(
+        orientation_w[index],
+        orientation_x[index],
+        orientation_y[index],
+        orientation_z[index]);
+}
+
+unsigned int ArcballPlayback::size() const
+{
+    return ids.size();
+}
+
+// remove playing arcball at specified index by moving the last one into its
+// place, so the arrays stay packed
+void ArcballPlayback::remove(unsigned int index)
+{
+    const unsigned int last = ids.size() - 1;
+    indices[ids[index]] = none;
+    if (index != last) {
+        indices[ids[last]] = index;
+        ids[index] = ids[last];
+        tracks[index] = std::move(tracks[last]);
+        times[index] = times[last];
+        segments[index] = segments[last];
+        loops[index] = loops[last];
+        ended[index] = ended[last];
+        orientation_w[index] = orientation_w[last];
+        orientation_x[index] = orientation_x[last];
+        orientation_y[index] = orientation_y[last];
+        orientation_z[index] = orientation_z[last];
+    }
+
+    ids.pop_back();
+    tracks.pop_back();
+    times.pop_back();
+    segments.pop_back();
+    loops.pop_back();
+    ended.pop_back();
+    orientation_w.pop_back();
+    orientation_x.pop_back();
+    orientation_y.pop_back();
+    orientation_z.pop_back();
+}
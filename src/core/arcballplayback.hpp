@@ -0,0 +1,137 @@
+#ifndef ARCBALLPLAYBACK_HPP_INCLUDED
+#define ARCBALLPLAYBACK_HPP_INCLUDED
+
+#include "arcballkernels.hpp"
+#include "arcballmath.hpp"
+
+#include <memory>
+#include <vector>
+
+// Interpolation between the keyframes of an orientation track.
+enum class Interpolation {
+    // spherical linear, turns at a steady rate from keyframe to keyframe
+    SLERP,
+    // spherical cubic, the rate of turn changes smoothly through keyframes
+    SQUAD
+};
+
+// The responsibility of this class is to hold orientations at points in time
+// and interpolate between them. Each keyframe is stored on the same side as
+// the keyframe before it, so interpolation always takes the shorter way
+// around, together with the inner control orientation squad interpolation
+// needs.
+class OrientationTrack {
+public:
+    // Construct track without keyframes with specified interpolation.
+    explicit OrientationTrack(Interpolation interpolation = Interpolation::SQUAD);
+    // Add keyframe with specified orientation at specified time in seconds,
+    // replacing any keyframe at the same time. Keyframes may be added in any
+    // order, adding them in order of time is constant time.
+    void add(float time, glm::quat orientation);
+    // Remove every keyframe.
+    void clear();
+    // Return number of keyframes.
+    unsigned int size() const;
+    // Return interpolation between keyframes.
+    Interpolation get_interpolation() const;
+    // Return time of first keyframe, or zero if there are none.
+    float get_start() const;
+    // Return time of last keyframe, or zero if there are none.
+    float get_end() const;
+    // Return index of keyframe that starts the segment specified time is in,
+    // clamped to the first and last segment. The search starts from the
+    // segment of specified hint, so it is constant time when the time has
+    // only moved on a little since the hint was found.
+    unsigned int find(float time, unsigned int hint = 0) const;
+    // Return time of keyframe at specified index.
+    float get_time(unsigned int index) const;
+    // Return orientation of keyframe at specified index.
+    glm::quat get_orientation(unsigned int index) const;
+    // Return squad control orientation of keyframe at specified index.
+    glm::quat get_control(unsigned int index) const;
+    // Return orientation at specified time, the first or last keyframe
+    // before or after the track. It is identity if there are no keyframes.
+    glm::quat sample(float time) const;
+private:
+    void update_control(unsigned int index);
+
+    Interpolation interpolation;
+    std::vector<float> times;
+    std::vector<glm::quat> orientations;
+    std::vector<glm::quat> controls;
+};
+
+// The responsibility of this class is to play orientation tracks on many
+// arcballs at once, each at its own time within its own track. The playing
+// arcballs are packed like spinning arcballs in the inertia and their tracks
+// are sampled together by the slerp kernel, squad tracks take two more passes
+// of the kernel over just those arcballs.
+class ArcballPlayback {
+public:
+    // Construct playback without playing arcballs.
+    ArcballPlayback();
+    // Start playing specified track on arcball with specified id from
+    // specified time in seconds within the track. A track that loops starts
+    // over from its first keyframe when past its last, otherwise it holds
+    // the last keyframe until stopped. An arcball that is already playing is
+    // restarted.
+    void play(
+        unsigned int id,
+        std::shared_ptr<OrientationTrack const> track,
+        float time = 0.0f,
+        bool loop = false);
+    // Stop arcball with specified id, if it is playing.
+    void stop(unsigned int id);
+    // Stop all arcballs.
+    void clear();
+    // Advance time of every playing arcball by specified number of seconds
+    // and sample their tracks.
+    void advance(float delta);
+    // Return true if arcball with specified id is playing.
+    bool is_playing(unsigned int id) const;
+    // Return true if arcball with specified id, which must be playing, has
+    // been sampled past the last keyframe of a track that does not loop.
+    bool has_ended(unsigned int id) const;
+    // Return orientation of arcball with specified id, which must be
+    // playing, at its time when last started or advanced.
+    glm::quat get_orientation(unsigned int id) const;
+    // Return number of playing arcballs.
+    unsigned int size() const;
+private:
+    void remove(unsigned int index);
+
+    ArcballKernels const * kernels;
+
+    // index of each id in the packed arrays, or none if not playing
+    std::vector<unsigned int> indices;
+
+    std::vector<unsigned int> ids;
+    std::vector<std::shared_ptr<OrientationTrack const>> tracks;
+    std::vector<float> times;
+    std::vector<unsigned int> segments;
+    std::vector<unsigned char> loops;
+    std::vector<unsigned char> ended;
+    std::vector<float> orientation_w;
+    std::vector<float> orientation_x;
+    std::vector<float> orientation_y;
+    std::vector<float> orientation_z;
+
+    // segments gathered for the kernel and the sampled orientations, squad
+    // tracks come first so the passes for them run over a prefix
+    std::vector<unsigned int> slots;
+    std::vector<float> t;
+    std::vector<float> from_w;
+    std::vector<float> from_x;
+    std::vector<float> from_y;
+    std::vector<float> from_z;
+    std::vector<float> to_w;
+    std::vector<float> to_x;
+    std::vector<float> to_y;
+    std::vector<float> to_z;
+    std::vector<float> sample_w;
+    std::vector<float> sample_x;
+    std::vector<float> sample_y;
+    std::vector<float> sample_z;
+};
+
+#endif
@@ -0,0 +1,326 @@
+#include "arcballrecord.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+// A log starts with a header:
+//
+//     magic      8 bytes  "ARCBALL" followed by the format version
+//     flags      1 byte   bit 0 is allow constraints
+//     orientation         4 floats w, x, y, z
+//
+// followed by samples until the end of the log:
+//
+//     flags      1 byte   bit 0 camera follows, bit 1 viewport follows,
+//                         bit 3 center follows
+//     buttons    1 byte   ArcballInput booleans, one bit each
+//     time                1 float
+//     position            2 int32
+//     camera              4 floats w, x, y, z (optional)
+//     viewport            4 int32 x, y, width, height (optional)
+//     center              2 floats x, y (optional)
+//
+// or by a sample setting the orientation:
+//
+//     flags      1 byte   bit 2 orientation follows
+//     time                1 float
+//     orientation         4 floats w, x, y, z
+//
+// every value is little endian so logs are portable between machines.
+
+namespace {
+
+const char magic[7] = { 'A', 'R', 'C', 'B', 'A', 'L', 'L' };
+const std::uint8_t version = 3;
+
+const std::uint8_t CAMERA_FOLLOWS = 1 << 0;
+const std::uint8_t VIEWPORT_FOLLOWS = 1 << 1;
+const std::uint8_t ORIENTATION_FOLLOWS = 1 << 2;
+const std::uint8_t CENTER_FOLLOWS = 1 << 3;
+
+void write_u8(std::ostream & out, std::uint8_t value)
+{
+    out.put(static_cast<char>(value));
+}
+
+void write_u32(std::ostream & out, std::uint32_t value)
+{
+    const char bytes[4] = {
+        static_cast<char>(value & 0xff),
+        static_cast<char>((value >> 8) & 0xff),
+        static_cast<char>((value >> 16) & 0xff),
+        static_cast<char>((value >> 24) & 0xff)
+    };
+    out.write(bytes, 4);
+}
+
+void write_i32(std::ostream & out, std::int32_t value)
+{
+    write_u32(out, static_cast<std::uint32_t>(value));
+}
+
+void write_float(std::ostream & out, float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write_u32(out, bits);
+}
+
+void write_quat(std::ostream & out, glm::quat q)
+{
+    write_float(out, q.w);
+    write_float(out, q.x);
+    write_float(out, q.y);
+    write_float(out, q.z);
+}
+
+bool read_u8(std::istream & in, std::uint8_t & value)
+{
+    const int c = in.get();
+    value = static_cast<std::uint8_t>(c);
+    return c != std::istream::traits_type::eof();
+}
+
+bool read_u32(std::istream & in, std::uint32_t & value)
+{
+    unsigned char bytes[4];
+    if (!in.read(reinterpret_cast<char *>(bytes), 4)) {
+        return false;
+    }
+    value = static_cast<std::uint32_t>(bytes[0]) |
+            static_cast<std::uint32_t>(bytes[1]) << 8 |
+            static_cast<std::uint32_t>(bytes[2]) << 16 |
+            static_cast<std::uint32_t>(bytes[3]) << 24;
+    return true;
+}
+
+bool read_i32(std::istream & in, int & value)
+{
+    std::uint32_t bits;
+    if (!read_u32(in, bits)) {
+        return false;
+    }
+    std::int32_t signed_bits;
+    std::memcpy(&signed_bits, &bits, sizeof(bits));
+    value = signed_bits;
+    return true;
+}
+
+bool read_float(std::istream & in, float & value)
+{
+    std::uint32_t bits;
+    if (!read_u32(in, bits)) {
+        return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+bool read_quat(std::istream & in, glm::quat & q)
+{
+    return read_float(in, q.w) &&
+           read_float(in, q.x) &&
+           read_float(in, q.y) &&
+           read_float(in, q.z);
+}
+
+std::uint8_t pack_buttons(ArcballInput const & input)
+{
+    return static_cast<std::uint8_t>(
+        input.down << 0 |
+        input.clicked << 1 |
+        input.released << 2 |
+        input.increase_radius << 3 |
+        input.decrease_radius << 4 |
+        input.reset << 5 |
+        input.shift << 6 |
+        input.ctrl << 7);
+}
+
+void unpack_buttons(std::uint8_t buttons, ArcballInput & input)
+{
+    input.down = (buttons >> 0) & 1;
+    input.clicked = (buttons >> 1) & 1;
+    input.released = (buttons >> 2) & 1;
+    input.increase_radius = (buttons >> 3) & 1;
+    input.decrease_radius = (buttons >> 4) & 1;
+    input.reset = (buttons >> 5) & 1;
+    input.shift = (buttons >> 6) & 1;
+    input.ctrl = (buttons >> 7) & 1;
+}
+
+}
+
+ArcballRecorder::ArcballRecorder()
+    : started(false)
+{
+}
+
+bool ArcballRecorder::open(std::string const & path, glm::quat orientation, bool allow_constraints)
+{
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    out.write(magic, sizeof(magic));
+    write_u8(out, version);
+    write_u8(out, allow_constraints ? 1 : 0);
+    write_quat(out, orientation);
+
+    begin = clock::now();
+    started = false;
+    return good();
+}
+
+void ArcballRecorder::record(
+    ArcballInput const & input,
+    ArcballCamera const & camera,
+    ArcballViewport const & viewport,
+    glm::vec2 center)
+{
+    if (!out.is_open()) {
+        return;
+    }
+
+    std::uint8_t flags = CAMERA_FOLLOWS | VIEWPORT_FOLLOWS | CENTER_FOLLOWS;
+    if (!started) {
+        started = true;
+    } else {
+        if (camera.orientation == last.camera.orientation) {
+            flags &= ~CAMERA_FOLLOWS;
+        }
+        if (viewport == last.viewport) {
+            flags &= ~VIEWPORT_FOLLOWS;
+        }
+        if (center == last.center) {
+            flags &= ~CENTER_FOLLOWS;
+        }
+    }
+
+    last.time = std::chrono::duration<float>(clock::now() - begin).count();
+    last.input = input;
+    last.camera = camera;
+    last.viewport = viewport;
+    last.center = center;
+
+    write_u8(out, flags);
+    write_u8(out, pack_buttons(input));
+    write_float(out, last.time);
+    write_i32(out, input.position.x);
+    write_i32(out, input.position.y);
+    if (flags & CAMERA_FOLLOWS) {
+        write_quat(out, camera.orientation);
+    }
+    if (flags & VIEWPORT_FOLLOWS) {
+        write_i32(out, viewport.x);
+        write_i32(out, viewport.y);
+        write_i32(out, viewport.width);
+        write_i32(out, viewport.height);
+    }
+    if (flags & CENTER_FOLLOWS) {
+        write_float(out, center.x);
+        write_float(out, center.y);
+    }
+}
+
+void ArcballRecorder::record_orientation(glm::quat orientation)
+{
+    if (!out.is_open()) {
+        return;
+    }
+
+    write_u8(out, ORIENTATION_FOLLOWS);
+    write_float(out, std::chrono::duration<float>(clock::now() - begin).count());
+    write_quat(out, orientation);
+}
+
+bool ArcballRecorder::good() const
+{
+    return out.good();
+}
+
+bool read_recording(std::istream & in, ArcballRecording & recording)
+{
+    char header[sizeof(magic)];
+    std::uint8_t header_version;
+    std::uint8_t header_flags;
+    if (!in.read(header, sizeof(header)) ||
+        std::memcmp(header, magic, sizeof(magic)) != 0 ||
+        !read_u8(in, header_version) ||
+        header_version != version ||
+        !read_u8(in, header_flags) ||
+        !read_quat(in, recording.orientation)) {
+        return false;
+    }
+    recording.allow_constraints = header_flags & 1;
+    recording.samples.clear();
+
+    ArcballSample sample = ArcballSample();
+    bool updated = false;
+    std::uint8_t flags;
+    while (read_u8(in, flags)) {
+        if (flags & ORIENTATION_FOLLOWS) {
+            ArcballSample set = sample;
+            set.set_orientation = true;
+            if (!read_float(in, set.time) || !read_quat(in, set.orientation)) {
+                return false;
+            }
+            recording.samples.push_back(set);
+            continue;
+        }
+
+        std::uint8_t buttons;
+        const bool read = read_u8(in, buttons) &&
+                          read_float(in, sample.time) &&
+                          read_i32(in, sample.input.position.x) &&
+                          read_i32(in, sample.input.position.y);
+        if (!read) {
+            return false;
+        }
+        unpack_buttons(buttons, sample.input);
+
+        if (flags & CAMERA_FOLLOWS) {
+            if (!read_quat(in, sample.camera.orientation)) {
+                return false;
+            }
+        } else if (!updated) {
+            // the first update must be complete
+            return false;
+        }
+
+        if (flags & VIEWPORT_FOLLOWS) {
+            const bool read_viewport = read_i32(in, sample.viewport.x) &&
+                                       read_i32(in, sample.viewport.y) &&
+                                       read_i32(in, sample.viewport.width) &&
+                                       read_i32(in, sample.viewport.height);
+            if (!read_viewport) {
+                return false;
+            }
+        } else if (!updated) {
+            return false;
+        }
+
+        if (flags & CENTER_FOLLOWS) {
+            if (!read_float(in, sample.center.x) || !read_float(in, sample.center.y)) {
+                return false;
+            }
+        } else if (!updated) {
+            return false;
+        }
+
+        updated = true;
+        recording.samples.push_back(sample);
+    }
+
+    return true;
+}
+
+bool load_recording(std::string const & path, ArcballRecording & recording)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    return read_recording(in, recording);
+}
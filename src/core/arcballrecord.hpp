@@ -0,0 +1,73 @@
+#ifndef ARCBALLRECORD_HPP_INCLUDED
+#define ARCBALLRECORD_HPP_INCLUDED
+
+#include "arcballinput.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Input, camera, viewport and ball center of a single update, with the time
+// in seconds since the recording began. A sample which sets the orientation is not an
+// update, the arcball is set to the orientation as when inertia or playback
+// hand the object back to it.
+struct ArcballSample {
+    float time;
+    ArcballInput input;
+    ArcballCamera camera;
+    ArcballViewport viewport;
+    glm::vec2 center;
+    bool set_orientation;
+    glm::quat orientation;
+};
+
+// A recorded session, the initial arcball state followed by every update in
+// the order they were made.
+struct ArcballRecording {
+    glm::quat orientation;
+    bool allow_constraints;
+    std::vector<ArcballSample> samples;
+};
+
+// The responsibility of this class is to write every update of an arcball
+// to a compact binary log, so the session can be replayed deterministically
+// without a window. Camera, viewport and center are only written when they
+// differ from the previous sample.
+class ArcballRecorder {
+public:
+    // Construct recorder without a log.
+    ArcballRecorder();
+    // Open log at specified path for an arcball with specified initial
+    // orientation and constraint setting. Return false if the log could not
+    // be created.
+    bool open(std::string const & path, glm::quat orientation, bool allow_constraints);
+    // Append update from specified input, camera and viewport, with the
+    // ball at specified center.
+    void record(
+        ArcballInput const & input,
+        ArcballCamera const & camera,
+        ArcballViewport const & viewport,
+        glm::vec2 center);
+    // Append setting the arcball to specified orientation.
+    void record_orientation(glm::quat orientation);
+    // Return true if every sample so far was written.
+    bool good() const;
+private:
+    typedef std::chrono::steady_clock clock;
+
+    std::ofstream out;
+    clock::time_point begin;
+    bool started;
+    ArcballSample last;
+};
+
+// Read recording from specified stream. Return false if the stream is not a
+// recording or is truncated.
+bool read_recording(std::istream & in, ArcballRecording & recording);
+// Read recording from log at specified path. Return false if the log could
+// not be read.
+bool load_recording(std::string const & path, ArcballRecording & recording);
+
+#endif
@@ -0,0 +1,181 @@
+#include "arcballthread.hpp"
+
+#include <chrono>
+
+namespace {
+
+// how long the input thread sleeps when there is nothing to update, this
+// bounds the latency added by the thread
+const std::chrono::microseconds idle_sleep(100);
+
+}
+
+ArcballThread::ArcballThread(ArcballCore const & core)
+    : core(core),
+      applied(0),
+      version(0),
+      published(State{ core, 0, 0 }),
+      submitted(0),
+      synchronized(0),
+      fetched_version(0),
+      running(true)
+{
+    thread = std::thread(&ArcballThread::run, this);
+}
+
+ArcballThread::~ArcballThread()
+{
+    stop();
+}
+
+void ArcballThread::submit(
+    ArcballInput const & input,
+    ArcballCamera const & camera,
+    ArcballViewport const & viewport)
+{
+    Command command;
+    command.type = CommandType::UPDATE;
+    command.input = input;
+    command.camera = camera;
+    command.viewport = viewport;
+    submit(command);
+}
+
+void ArcballThread::set_allow_constraints(bool allow_constraints)
+{
+    Command command;
+    command.type = CommandType::ALLOW_CONSTRAINTS;
+    command.allow_constraints = allow_constraints;
+    submit(command);
+    synchronized = submitted;
+}
+
+void ArcballThread::set_center(glm::vec2 center)
+{
+    Command command;
+    command.type = CommandType::CENTER;
+    command.center = center;
+    submit(command);
+}
+
+void ArcballThread::set_orientation(glm::quat orientation)
+{
+    Command command;
+    command.type = CommandType::ORIENTATION;
+    command.orientation = orientation;
+    submit(command);
+    synchronized = submitted;
+}
+
+// a state published before the last setting that the submitting thread has
+// also made on its own copy is skipped, it would undo the setting until the
+// input thread catches up
+bool ArcballThread::fetch(ArcballCore & core)
+{
+    flush();
+
+    if (!published.update()) {
+        return false;
+    }
+    State const & state = published.front();
+    if (state.applied < synchronized || state.version == fetched_version) {
+        return false;
+    }
+    fetched_version = state.version;
+    core = state.core;
+    return true;
+}
+
+void ArcballThread::stop()
+{
+    if (thread.joinable()) {
+        while (!flush()) {
+            std::this_thread::yield();
+        }
+        running.store(false, std::memory_order_release);
+        thread.join();
+    }
+}
+
+// a command is never dropped, when the queue is full it waits in the backlog
+// rather than blocking the submitting thread
+void ArcballThread::submit(Command const & command)
+{
+    if (!flush() || !commands.push(command)) {
+        backlog.push_back(command);
+    }
+    submitted++;
+}
+
+// hand commands in the backlog over to the input thread, return true if the
+// backlog is empty
+bool ArcballThread::flush()
+{
+    while (!backlog.empty() && commands.push(backlog.front())) {
+        backlog.pop_front();
+    }
+    return backlog.empty();
+}
+
+void ArcballThread::run()
+{
+    bool stopping = false;
+    while (!stopping) {
+        // commands submitted before the stop request are still applied
+        stopping = !running.load(std::memory_order_acquire);
+        if (!drain() && !stopping) {
+            std::this_thread::sleep_for(idle_sleep);
+        }
+    }
+}
+
+// apply every queued command and publish the arcball, return true if there
+// was anything to apply
+bool ArcballThread::drain()
+{
+    Command command;
+    unsigned long count = 0;
+    bool changed = false;
+
+    while (commands.pop(command)) {
+        changed = apply(command) || changed;
+        count++;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    // published even if unchanged so the submitting thread sees which
+    // commands are applied
+    applied += count;
+    if (changed) {
+        version++;
+    }
+    State & state = published.back();
+    state.core = core;
+    state.applied = applied;
+    state.version = version;
+    published.publish();
+
+    return true;
+}
+
+// apply specified command, return true if it changed the arcball
+bool ArcballThread::apply(Command const & command)
+{
+    switch (command.type) {
+    case CommandType::UPDATE:
+        core.update(command.input, command.camera, command.viewport);
+        return core.changed();
+    case CommandType::ALLOW_CONSTRAINTS:
+        core.set_allow_constraints(command.allow_constraints);
+        return true;
+    case CommandType::CENTER:
+        core.set_center(command.center);
+        return true;
+    case CommandType::ORIENTATION:
+        core.set_orientation(command.orientation);
+        return true;
+    }
+    return false;
+}
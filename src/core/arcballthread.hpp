@@ -0,0 +1,98 @@
+#ifndef ARCBALLTHREAD_HPP_INCLUDED
+#define ARCBALLTHREAD_HPP_INCLUDED
+
+#include "arcballcore.hpp"
+#include "spscqueue.hpp"
+#include "triplebuffer.hpp"
+
+#include <atomic>
+#include <deque>
+#include <thread>
+
+// The responsibility of this class is to update an arcball on a dedicated
+// input thread. Inputs and settings are handed over as commands through a
+// lock-free queue, the input thread applies them on its own time and
+// publishes every arcball state that changed through a triple buffer, so
+// neither the submitting thread nor the input thread ever waits on the other
+// or on a lock.
+class ArcballThread {
+public:
+    // Start input thread updating a copy of specified arcball.
+    explicit ArcballThread(ArcballCore const & core);
+    // Stop input thread.
+    ~ArcballThread();
+    ArcballThread(ArcballThread const &) = delete;
+    ArcballThread & operator=(ArcballThread const &) = delete;
+    // Submit update from specified input, camera and viewport.
+    void submit(
+        ArcballInput const & input,
+        ArcballCamera const & camera,
+        ArcballViewport const & viewport);
+    // Set enable/disable constraints on the input thread, after the updates
+    // submitted before. States published before it are no longer fetched.
+    void set_allow_constraints(bool allow_constraints);
+    // Set center of the ball on the input thread, after the updates
+    // submitted before.
+    void set_center(glm::vec2 center);
+    // Set orientation on the input thread, after the updates submitted
+    // before. States published before it are no longer fetched.
+    void set_orientation(glm::quat orientation);
+    // Copy the newest arcball state into specified arcball, without waiting
+    // for the input thread. Return true if the arcball changed since the
+    // last fetch.
+    bool fetch(ArcballCore & core);
+    // Stop input thread once every submitted command is applied and
+    // published.
+    void stop();
+private:
+    enum class CommandType {
+        UPDATE,
+        ALLOW_CONSTRAINTS,
+        CENTER,
+        ORIENTATION
+    };
+
+    struct Command {
+        CommandType type;
+        ArcballInput input;
+        ArcballCamera camera;
+        ArcballViewport viewport;
+        bool allow_constraints;
+        glm::vec2 center;
+        glm::quat orientation;
+    };
+
+    // an arcball state, the number of commands applied to reach it and a
+    // version which is increased whenever the arcball changes
+    struct State {
+        ArcballCore core;
+        unsigned long applied;
+        unsigned long version;
+    };
+
+    void submit(Command const & command);
+    bool flush();
+    void run();
+    bool drain();
+    bool apply(Command const & command);
+
+    // only touched by the input thread
+    ArcballCore core;
+    unsigned long applied;
+    unsigned long version;
+
+    SpscQueue<Command, 1024> commands;
+    TripleBuffer<State> published;
+
+    // only touched by the submitting thread, commands the queue had no room
+    // for are kept in order and handed over before any newer command
+    std::deque<Command> backlog;
+    unsigned long submitted;
+    unsigned long synchronized;
+    unsigned long fetched_version;
+
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+#endif
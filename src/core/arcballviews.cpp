@@ -0,0 +1,145 @@
+#include "arcballviews.hpp"
+
+#include "profiler.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// return true if specified viewport contains specified position
+bool contains(ArcballViewport const & viewport, glm::ivec2 position)
+{
+    return position.x >= viewport.x &&
+           position.y >= viewport.y &&
+           position.x < viewport.x + viewport.width &&
+           position.y < viewport.y + viewport.height;
+}
+
+// return ball of specified view with specified radius relative to its
+// viewport as a disc in window coordinates of the input, where y grows
+// downwards. The ball is only round in a square viewport, the disc is the
+// largest one inside it. The views drawn later are nearer so they are picked
+// first, as in pick_view.
+BallDisc view_disc(ArcballView const & view, float radius, unsigned int index, unsigned int count)
+{
+    auto const & viewport = view.viewport;
+    BallDisc disc;
+    disc.center = glm::vec2(
+        viewport.x + (view.center.x + 1.0f) * 0.5f * viewport.width,
+        viewport.y + (1.0f - view.center.y) * 0.5f * viewport.height);
+    disc.radius = radius * 0.5f * std::min(viewport.width, viewport.height);
+    disc.depth = static_cast<float>(count - index);
+    return disc;
+}
+
+}
+
+unsigned int pick_view(std::vector<ArcballView> const & views, glm::ivec2 position)
+{
+    for (unsigned int i = views.size(); i-- > 0;) {
+        if (contains(views[i].viewport, position)) {
+            return i;
+        }
+    }
+    return no_view;
+}
+
+ArcballViews::ArcballViews()
+    : active(no_view)
+{
+}
+
+void ArcballViews::set_views(std::vector<ArcballView> const & views, float radius)
+{
+    this->views = views;
+    cores.resize(views.size());
+
+    discs.resize(views.size());
+    for (unsigned int i = 0; i < views.size(); i++) {
+        discs[i] = view_disc(views[i], radius, i, views.size());
+    }
+    tree.update(discs);
+
+    if (active != no_view && active >= views.size()) {
+        active = no_view;
+    }
+}
+
+// a ball is picked over a viewport drawn on top of it, but not where it
+// reaches out of its own viewport, and a cursor outside every view leaves the
+// input with the active view, or the first view if none has been active yet
+bool ArcballViews::route(ArcballInput const & input, bool dragging)
+{
+    if (views.empty() || (dragging && active != no_view)) {
+        return false;
+    }
+
+    const int ball = tree.pick(glm::vec2(input.position));
+    unsigned int picked = pick_view(views, input.position);
+    if (ball >= 0 && contains(views[ball].viewport, input.position)) {
+        picked = ball;
+    }
+    if (picked == no_view) {
+        picked = active != no_view ? active : 0;
+    }
+
+    const bool changed = picked != active;
+    active = picked;
+    return changed;
+}
+
+// the views that do not receive input show the arcball at rest with the
+// cursor in the middle of their viewport, holding the same modifiers
+void ArcballViews::follow(ArcballCore const & arcball, glm::quat orientation, ArcballInput const & input)
+{
+    PROFILE_SCOPE("ArcballViews::follow");
+
+    for (unsigned int i = 0; i < views.size(); i++) {
+        if (i == active) {
+            continue;
+        }
+
+        auto & core = cores[i];
+        auto const & view = views[i];
+
+        if (core.get_allow_constraints() != arcball.get_allow_constraints()) {
+            core.set_allow_constraints(arcball.get_allow_constraints());
+        }
+        if (core.get_custom_axes() != arcball.get_custom_axes()) {
+            core.set_custom_axes(arcball.get_custom_axes());
+        }
+        if (core.get_orientation().now != orientation) {
+            core.set_orientation(orientation);
+        }
+        core.set_radius(arcball.get_radius());
+        core.set_center(view.center);
+
+        ArcballInput hover = ArcballInput();
+        hover.position = glm::ivec2(
+            view.viewport.x + view.viewport.width / 2,
+            view.viewport.y + view.viewport.height / 2);
+        hover.shift = input.shift;
+        hover.ctrl = input.ctrl;
+        core.update(hover, view.camera, view.viewport);
+    }
+}
+
+unsigned int ArcballViews::size() const
+{
+    return views.size();
+}
+
+unsigned int ArcballViews::get_active() const
+{
+    return active;
+}
+
+ArcballView const & ArcballViews::get_view(unsigned int index) const
+{
+    return views[index];
+}
+
+ArcballCore const & ArcballViews::get_core(unsigned int index) const
+{
+    return cores[index];
+}
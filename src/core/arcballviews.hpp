@@ -0,0 +1,71 @@
+#ifndef ARCBALLVIEWS_HPP_INCLUDED
+#define ARCBALLVIEWS_HPP_INCLUDED
+
+#include "arcballcore.hpp"
+#include "balltree.hpp"
+
+#include <vector>
+
+// Index of no view.
+const unsigned int no_view = static_cast<unsigned int>(-1);
+
+// A view of an arcball, the camera it is seen through, its viewport in window
+// coordinates and the center of the ball in window coordinates of that
+// viewport.
+struct ArcballView {
+    ArcballCamera camera;
+    ArcballViewport viewport;
+    glm::vec2 center;
+};
+
+// Return index of the view whose viewport contains specified position, the
+// last one if several do since it is drawn on top, or no view.
+unsigned int pick_view(std::vector<ArcballView> const & views, glm::ivec2 position);
+
+// The responsibility of this class is to let one arcball be seen and dragged
+// through several views. Input goes to the view whose ball is under the
+// cursor, or else the view whose viewport is, and stays with the view a drag
+// started in until it is released. The balls are picked with a ball tree
+// that is refitted as the views move. The arcball that
+// receives it is solved by its owner through the active view. Every other
+// view keeps an arcball core of its own, which follows the orientation shown,
+// radius and constraint setting of the receiving arcball through the camera
+// of that view once per frame.
+class ArcballViews {
+public:
+    // Construct without views.
+    ArcballViews();
+    // Set views and radius of the ball relative to the viewports, usually
+    // once per frame as the cameras move. The active view is kept unless it
+    // no longer exists.
+    void set_views(std::vector<ArcballView> const & views, float radius);
+    // Route specified input to a view and make it the active view, the
+    // active view is kept while dragging is true. Return true if the active
+    // view changed.
+    bool route(ArcballInput const & input, bool dragging);
+    // Bring every view but the active one up to date with specified
+    // arcball, which received input through the active view, with specified
+    // orientation it is shown in and with the modifiers of specified input.
+    // The orientation shown differs from the orientation of the arcball
+    // while it spins or plays back. A view whose arcball, orientation,
+    // modifiers and view are all unchanged is skipped.
+    void follow(ArcballCore const & arcball, glm::quat orientation, ArcballInput const & input);
+    // Return number of views.
+    unsigned int size() const;
+    // Return index of active view, or no view if there are none.
+    unsigned int get_active() const;
+    // Return view at specified index.
+    ArcballView const & get_view(unsigned int index) const;
+    // Return arcball core of view at specified index, which must not be the
+    // active view.
+    ArcballCore const & get_core(unsigned int index) const;
+private:
+    std::vector<ArcballView> views;
+    std::vector<ArcballCore> cores;
+    unsigned int active;
+    // ball of every view in window coordinates of the input
+    std::vector<BallDisc> discs;
+    BallTree tree;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "arccache.hpp"
+
+ArcCache::ArcCache()
+    : shape(Shape::NONE)
+{
+    unit_positions.reserve(2 * (arc_segments + 1));
+}
+
+void ArcCache::fill_arc(
+    float radius,
+    std::vector<glm::vec3> & positions,
+    glm::vec3 from,
+    glm::vec3 to)
+{
+    if (!hit(Shape::ARC, from, to)) {
+        unit_positions.clear();
+        ::fill_arc(1.0f, unit_positions, from, to);
+    }
+    append(radius, positions);
+}
+
+void ArcCache::fill_half_arc(
+    float radius,
+    std::vector<glm::vec3> & positions,
+    glm::vec3 axis)
+{
+    if (!hit(Shape::HALF_ARC, axis, axis)) {
+        unit_positions.clear();
+        ::fill_half_arc(1.0f, unit_positions, axis);
+    }
+    append(radius, positions);
+}
+
+// return true if the remembered arc has specified shape and points, if not
+// the specified ones are remembered instead
+bool ArcCache::hit(Shape shape, glm::vec3 a, glm::vec3 b)
+{
+    if (this->shape == shape && this->a == a && this->b == b) {
+        return true;
+    }
+    this->shape = shape;
+    this->a = a;
+    this->b = b;
+    return false;
+}
+
+// the arc functions scale every unit point by the radius as the last step so
+// scaling the remembered unit points gives the same positions
+void ArcCache::append(float radius, std::vector<glm::vec3> & positions) const
+{
+    for (auto const & position : unit_positions) {
+        positions.push_back(position * radius);
+    }
+}
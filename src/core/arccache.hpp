@@ -0,0 +1,43 @@
+#ifndef ARCCACHE_HPP_INCLUDED
+#define ARCCACHE_HPP_INCLUDED
+
+#include "arcballgeometry.hpp"
+
+// The responsibility of this class is to remember the arc it generated last
+// on the unit ball, so that asking for the same arc again, at any radius,
+// only scales the remembered positions instead of generating them. Positions
+// are identical to the ones of fill_arc and fill_half_arc.
+class ArcCache {
+public:
+    // Construct empty cache.
+    ArcCache();
+    // Append arc between two points on a ball with specified radius to
+    // positions, see fill_arc.
+    void fill_arc(
+        float radius,
+        std::vector<glm::vec3> & positions,
+        glm::vec3 from,
+        glm::vec3 to);
+    // Append front half of the great circle perpendicular to specified axis
+    // on a ball with specified radius to positions, see fill_half_arc.
+    void fill_half_arc(
+        float radius,
+        std::vector<glm::vec3> & positions,
+        glm::vec3 axis);
+private:
+    enum class Shape {
+        NONE,
+        ARC,
+        HALF_ARC
+    };
+
+    bool hit(Shape shape, glm::vec3 a, glm::vec3 b);
+    void append(float radius, std::vector<glm::vec3> & positions) const;
+
+    Shape shape;
+    glm::vec3 a;
+    glm::vec3 b;
+    std::vector<glm::vec3> unit_positions;
+};
+
+#endif
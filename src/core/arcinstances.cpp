@@ -0,0 +1,129 @@
+#include "arcinstances.hpp"
+
+#include <cmath>
+
+namespace {
+
+// the vertex attributes are read straight out of the packed instances
+static_assert(sizeof(ArcInstance) == 13 * sizeof(float), "instances must be tightly packed");
+
+// bisect in single precision throughout, as a shader would
+glm::vec3 shader_bisect(glm::vec3 a, glm::vec3 b)
+{
+    glm::vec3 v = a + b;
+    const float length2 = glm::dot(v, v);
+    if (length2 < 1.0e-8f) {
+        return glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+    return v * (1.0f / std::sqrt(length2));
+}
+
+}
+
+void ArcInstanceBatch::clear()
+{
+    instances.clear();
+}
+
+void ArcInstanceBatch::reserve(unsigned int capacity)
+{
+    instances.reserve(capacity);
+}
+
+void ArcInstanceBatch::add_arc(
+    glm::vec3 from,
+    glm::vec3 to,
+    float radius,
+    glm::vec2 center,
+    glm::vec3 color,
+    float opacity)
+{
+    ArcInstance instance;
+    instance.center = center;
+    instance.from = from;
+    instance.to = to;
+    instance.radius = radius;
+    instance.color = color;
+    instance.opacity = opacity;
+    instances.push_back(instance);
+}
+
+void ArcInstanceBatch::add_half_arc(
+    glm::vec3 axis,
+    float radius,
+    glm::vec2 center,
+    glm::vec3 color,
+    float opacity)
+{
+    glm::vec3 start;
+    glm::vec3 middle;
+    half_arc_points(axis, start, middle);
+
+    add_arc(start, middle, radius, center, color, opacity);
+    add_arc(middle, -start, radius, center, color, opacity);
+}
+
+void ArcInstanceBatch::add_circle(
+    float radius,
+    glm::vec2 center,
+    glm::vec3 color,
+    float opacity)
+{
+    // quarters since the arc between two opposite points is undefined
+    const glm::vec3 quarters[5] = {
+        glm::vec3(1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(1.0f, 0.0f, 0.0f)
+    };
+    for (int i = 0; i < 4; i++) {
+        add_arc(quarters[i], quarters[i + 1], radius, center, color, opacity);
+    }
+}
+
+unsigned int ArcInstanceBatch::size() const
+{
+    return instances.size();
+}
+
+ArcInstance const * ArcInstanceBatch::data() const
+{
+    return instances.data();
+}
+
+// the vertex with id k is point k of the recurrence in fill_arc, which is
+// rerun up to k since a vertex shader can not see the other vertices
+glm::vec3 evaluate_arc_vertex(ArcInstance const & instance, int vertex_id)
+{
+    const glm::vec3 center(instance.center, 0.0f);
+    if (vertex_id >= arc_segments) {
+        return center + instance.to * instance.radius;
+    }
+
+    glm::vec3 previous = instance.from;
+    glm::vec3 current = instance.to;
+    for (int i = 0; i < arc_bisects; i++) {
+        current = shader_bisect(previous, current);
+    }
+    if (vertex_id == 0) {
+        return center + previous * instance.radius;
+    }
+
+    const float dot_two = glm::dot(previous, current) * 2.0f;
+    for (int i = 1; i < vertex_id; i++) {
+        const glm::vec3 next = current * dot_two - previous;
+        previous = current;
+        current = next;
+    }
+    return center + current * instance.radius;
+}
+
+void evaluate_arc_instances(ArcInstanceBatch const & batch, std::vector<glm::vec3> & positions)
+{
+    for (unsigned int i = 0; i < batch.size(); i++) {
+        for (int vertex_id = 0; vertex_id < arc_instance_vertices; vertex_id++) {
+            positions.push_back(evaluate_arc_vertex(batch.data()[i], vertex_id));
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ARCINSTANCES_HPP_INCLUDED
+#define ARCINSTANCES_HPP_INCLUDED
+
+#include "arcballgeometry.hpp"
+
+#include <vector>
+
+// Number of vertices of an arc instance, drawn as a line strip.
+const int arc_instance_vertices = arc_segments + 1;
+
+// Largest distance between a point of an arc instance as evaluated by
+// evaluate_arc_vertex or the arc vertex shader and the same point from
+// fill_arc, on a ball with a radius of at most one. On x86 the evaluator
+// agrees exactly, a quotient rounded through double is the single precision
+// quotient. The recurrence amplifies any other rounding of its first step
+// along the arc, fused multiply adds or a GPU move points by up to 2.5e-4,
+// about a tenth of a pixel in an 800 pixel viewport.
+const float arc_instance_tolerance = 5.0e-4f;
+
+// Parameters of a single arc, laid out as the per instance vertex attributes
+// of the arc vertex shader. The center of the ball is in window coordinates.
+struct ArcInstance {
+    glm::vec2 center;
+    glm::vec3 from;
+    glm::vec3 to;
+    float radius;
+    glm::vec3 color;
+    float opacity;
+};
+
+// The responsibility of this class is to pack the parameters of arcs into a
+// flat buffer that is uploaded once and drawn with a single instanced draw,
+// the arc vertex shader reconstructs the points of every arc.
+class ArcInstanceBatch {
+public:
+    // Remove all instances.
+    void clear();
+    // Reserve storage for specified number of instances.
+    void reserve(unsigned int capacity);
+    // Add arc between two points on a ball with specified radius and
+    // center.
+    void add_arc(
+        glm::vec3 from,
+        glm::vec3 to,
+        float radius,
+        glm::vec2 center,
+        glm::vec3 color,
+        float opacity);
+    // Add front half of the great circle perpendicular to specified axis on
+    // a ball with specified radius and center, this takes two instances.
+    void add_half_arc(
+        glm::vec3 axis,
+        float radius,
+        glm::vec2 center,
+        glm::vec3 color,
+        float opacity);
+    // Add circle with specified radius and center in the view plane, this
+    // takes four instances.
+    void add_circle(
+        float radius,
+        glm::vec2 center,
+        glm::vec3 color,
+        float opacity);
+    // Return number of instances.
+    unsigned int size() const;
+    // Return packed instances.
+    ArcInstance const * data() const;
+private:
+    std::vector<ArcInstance> instances;
+};
+
+// Return position of the vertex with specified id of an arc instance in
+// window coordinates, evaluated step by step as the arc vertex shader does.
+// It is the reference for the shader math, checked against fill_arc by
+// arcball_bench --check without a GPU.
+glm::vec3 evaluate_arc_vertex(ArcInstance const & instance, int vertex_id);
+// Append position of every vertex of every instance in specified batch to
+// positions, in draw order.
+void evaluate_arc_instances(ArcInstanceBatch const & batch, std::vector<glm::vec3> & positions);
+
+#endif
@@ -0,0 +1,55 @@
+#include "ballprojector.hpp"
+
+BallProjector::BallProjector()
+    : view(1.0f),
+      projection(1.0f),
+      view_projection(1.0f)
+{
+}
+
+void BallProjector::set_eye(glm::mat4 const & view, glm::mat4 const & projection)
+{
+    if (this->view == view && this->projection == projection) {
+        return;
+    }
+    this->view = view;
+    this->projection = projection;
+    view_projection = projection * view;
+}
+
+glm::mat4 const & BallProjector::get_view_projection() const
+{
+    return view_projection;
+}
+
+// the rows of the matrix needed for x, y and w are taken out once so each
+// position costs three dot products and a division
+void BallProjector::project(
+    glm::vec3 const * positions,
+    float const * radii,
+    unsigned int count,
+    std::vector<BallDisc> & discs) const
+{
+    glm::mat4 const & m = view_projection;
+    const glm::vec4 row_x(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row_y(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row_w(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    discs.resize(count);
+    for (unsigned int i = 0; i < count; i++) {
+        const glm::vec4 position(positions[i], 1.0f);
+        const float w = glm::dot(row_w, position);
+        const float inverse_w = w != 0.0f ? 1.0f / w : 0.0f;
+
+        BallDisc & disc = discs[i];
+        disc.center = glm::vec2(glm::dot(row_x, position), glm::dot(row_y, position)) * inverse_w;
+        disc.radius = radii[i];
+        disc.depth = w;
+    }
+}
+
+glm::vec2 BallProjector::project(glm::vec3 position) const
+{
+    const glm::vec4 clip = view_projection * glm::vec4(position, 1.0f);
+    return clip.w != 0.0f ? glm::vec2(clip.x, clip.y) / clip.w : glm::vec2(0.0f);
+}
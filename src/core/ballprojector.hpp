@@ -0,0 +1,43 @@
+#ifndef BALLPROJECTOR_HPP_INCLUDED
+#define BALLPROJECTOR_HPP_INCLUDED
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Ball of an arcball projected to the window, center and radius are in
+// window coordinates and depth is the distance from the eye.
+struct BallDisc {
+    glm::vec2 center;
+    float radius;
+    float depth;
+};
+
+// The responsibility of this class is to project the positions of many
+// objects to ball discs in the window once per frame, through a view
+// projection matrix that is only recomputed when the eye changes.
+class BallProjector {
+public:
+    // Construct projector with identity view and projection.
+    BallProjector();
+    // Set view and projection matrix of the eye.
+    void set_eye(glm::mat4 const & view, glm::mat4 const & projection);
+    // Return cached product of projection and view matrix.
+    glm::mat4 const & get_view_projection() const;
+    // Project specified number of world positions to discs with specified
+    // radii in window coordinates. Positions behind the eye get a negative
+    // depth.
+    void project(
+        glm::vec3 const * positions,
+        float const * radii,
+        unsigned int count,
+        std::vector<BallDisc> & discs) const;
+    // Return window coordinate of specified world position.
+    glm::vec2 project(glm::vec3 position) const;
+private:
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;
+};
+
+#endif
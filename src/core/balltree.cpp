@@ -0,0 +1,195 @@
+#include "balltree.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// the largest number of discs in a leaf
+const unsigned int leaf_size = 4;
+// a refitted tree is rebuilt when its bounds have grown this much since the
+// last build
+const float max_cost_growth = 2.0f;
+// the hierarchy is balanced so this is enough for any number of discs
+const unsigned int max_depth = 64;
+
+const float infinity = std::numeric_limits<float>::infinity();
+
+}
+
+BallTree::BallTree()
+    : built_cost(0.0f),
+      builds(0)
+{
+}
+
+void BallTree::build(std::vector<BallDisc> const & discs)
+{
+    this->discs = discs;
+
+    order.resize(discs.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    nodes.clear();
+    if (!discs.empty()) {
+        build_node(0, discs.size());
+    }
+
+    built_cost = refit();
+    builds++;
+}
+
+void BallTree::update(std::vector<BallDisc> const & discs)
+{
+    if (nodes.empty() || discs.size() != this->discs.size()) {
+        build(discs);
+        return;
+    }
+
+    this->discs = discs;
+    if (refit() > max_cost_growth * built_cost) {
+        build(discs);
+    }
+}
+
+// the nodes are visited nearest first and a node is skipped when even its
+// nearest disc is behind the disc picked so far
+int BallTree::pick(glm::vec2 point) const
+{
+    int picked = -1;
+    float picked_depth = infinity;
+
+    if (nodes.empty()) {
+        return picked;
+    }
+
+    unsigned int stack[max_depth];
+    unsigned int size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        const unsigned int index = stack[--size];
+        Node const & node = nodes[index];
+        const bool outside = point.x < node.min.x || point.x > node.max.x ||
+                             point.y < node.min.y || point.y > node.max.y;
+        if (outside || node.depth >= picked_depth) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (unsigned int i = node.index; i < node.index + node.count; i++) {
+                BallDisc const & disc = discs[order[i]];
+                const glm::vec2 offset = point - disc.center;
+                const bool inside = glm::dot(offset, offset) <= disc.radius * disc.radius;
+                if (inside && disc.depth > 0.0f && disc.depth < picked_depth) {
+                    picked = order[i];
+                    picked_depth = disc.depth;
+                }
+            }
+            continue;
+        }
+
+        const unsigned int left = index + 1;
+        const unsigned int right = node.index;
+        if (nodes[left].depth < nodes[right].depth) {
+            stack[size++] = right;
+            stack[size++] = left;
+        } else {
+            stack[size++] = left;
+            stack[size++] = right;
+        }
+    }
+
+    return picked;
+}
+
+unsigned int BallTree::get_builds() const
+{
+    return builds;
+}
+
+// build the structure of the subtree over the discs from begin to end in
+// order by splitting them at the median center along the longest side of
+// their bounds, return index of the subtree root
+unsigned int BallTree::build_node(unsigned int begin, unsigned int end)
+{
+    const unsigned int index = nodes.size();
+    nodes.push_back(Node());
+
+    if (end - begin <= leaf_size) {
+        nodes[index].index = begin;
+        nodes[index].count = end - begin;
+        return index;
+    }
+
+    glm::vec2 low(infinity);
+    glm::vec2 high(-infinity);
+    for (unsigned int i = begin; i < end; i++) {
+        low = glm::min(low, discs[order[i]].center);
+        high = glm::max(high, discs[order[i]].center);
+    }
+    const int axis = high.x - low.x >= high.y - low.y ? 0 : 1;
+
+    const unsigned int middle = begin + (end - begin) / 2;
+    std::nth_element(
+        order.begin() + begin,
+        order.begin() + middle,
+        order.begin() + end,
+        [this, axis](unsigned int a, unsigned int b) {
+            return discs[a].center[axis] < discs[b].center[axis];
+        });
+
+    build_node(begin, middle);
+    const unsigned int right = build_node(middle, end);
+
+    nodes[index].index = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+// set bounds and depth of specified leaf from its discs, discs behind the eye
+// are left out
+void BallTree::fit_leaf(Node & node) const
+{
+    node.min = glm::vec2(infinity);
+    node.max = glm::vec2(-infinity);
+    node.depth = infinity;
+
+    for (unsigned int i = node.index; i < node.index + node.count; i++) {
+        BallDisc const & disc = discs[order[i]];
+        if (disc.depth <= 0.0f) {
+            continue;
+        }
+        node.min = glm::min(node.min, disc.center - disc.radius);
+        node.max = glm::max(node.max, disc.center + disc.radius);
+        node.depth = std::min(node.depth, disc.depth);
+    }
+}
+
+// recompute bounds and depth of every node from the discs, children always
+// come after their parent so a single backwards pass is enough, return sum of
+// the perimeters of all bounds as a measure of how tight the tree is
+float BallTree::refit()
+{
+    float cost = 0.0f;
+
+    for (unsigned int i = nodes.size(); i-- > 0;) {
+        Node & node = nodes[i];
+        if (node.count > 0) {
+            fit_leaf(node);
+        } else {
+            Node const & left = nodes[i + 1];
+            Node const & right = nodes[node.index];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+            node.depth = std::min(left.depth, right.depth);
+        }
+
+        if (node.min.x <= node.max.x) {
+            cost += (node.max.x - node.min.x) + (node.max.y - node.min.y);
+        }
+    }
+
+    return cost;
+}
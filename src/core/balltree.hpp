@@ -0,0 +1,53 @@
+#ifndef BALLTREE_HPP_INCLUDED
+#define BALLTREE_HPP_INCLUDED
+
+#include "ballprojector.hpp"
+
+#include <vector>
+
+// The responsibility of this class is to find the ball disc under a point in
+// the window in logarithmic time, with a bounding volume hierarchy over the
+// discs. When the camera or objects move the bounds are refitted in place and
+// the hierarchy is only rebuilt when refitting has made it too loose.
+class BallTree {
+public:
+    // Construct empty tree.
+    BallTree();
+    // Build tree from specified discs.
+    void build(std::vector<BallDisc> const & discs);
+    // Update tree to specified discs, which are the discs of the last update
+    // or build moved, the tree is refitted if the number of discs is the
+    // same and rebuilt otherwise.
+    void update(std::vector<BallDisc> const & discs);
+    // Return index of the disc nearest the eye that contains specified point
+    // in window coordinates, or -1 if there is none. Discs behind the eye are
+    // never picked.
+    int pick(glm::vec2 point) const;
+    // Return number of times the tree has been built.
+    unsigned int get_builds() const;
+private:
+    struct Node {
+        glm::vec2 min;
+        glm::vec2 max;
+        // nearest depth of any disc below the node
+        float depth;
+        // index of the right child for inner nodes, left child is the next
+        // node, and index of the first disc in order for leaves
+        unsigned int index;
+        // number of discs for leaves, zero for inner nodes
+        unsigned int count;
+    };
+
+    unsigned int build_node(unsigned int begin, unsigned int end);
+    void fit_leaf(Node & node) const;
+    float refit();
+
+    std::vector<BallDisc> discs;
+    std::vector<unsigned int> order;
+    std::vector<Node> nodes;
+    // sum of the perimeters of all node bounds right after the last build
+    float built_cost;
+    unsigned int builds;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "constraintaxes.hpp"
+
+ConstraintAxes::ConstraintAxes()
+    : count(0)
+{
+}
+
+void ConstraintAxes::clear()
+{
+    count = 0;
+}
+
+bool ConstraintAxes::push_back(glm::vec3 axis)
+{
+    if (count == max_constraint_axes) {
+        return false;
+    }
+    axes[count++] = axis;
+    return true;
+}
+
+unsigned int ConstraintAxes::size() const
+{
+    return count;
+}
+
+bool ConstraintAxes::empty() const
+{
+    return count == 0;
+}
+
+glm::vec3 const & ConstraintAxes::operator[](unsigned int index) const
+{
+    return axes[index];
+}
+
+glm::vec3 const * ConstraintAxes::data() const
+{
+    return axes.data();
+}
+
+glm::vec3 const * ConstraintAxes::begin() const
+{
+    return axes.data();
+}
+
+glm::vec3 const * ConstraintAxes::end() const
+{
+    return axes.data() + count;
+}
+
+bool ConstraintAxes::operator==(ConstraintAxes const & other) const
+{
+    if (count != other.count) {
+        return false;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        if (axes[i] != other.axes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ConstraintAxes::operator!=(ConstraintAxes const & other) const
+{
+    return !(*this == other);
+}
@@ -0,0 +1,40 @@
+#ifndef CONSTRAINTAXES_HPP_INCLUDED
+#define CONSTRAINTAXES_HPP_INCLUDED
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+// Largest number of axes in a constraint axis set.
+const unsigned int max_constraint_axes = 8;
+
+// The responsibility of this class is to hold a set of constraint axes in
+// fixed inline storage, so that filling it never touches the heap.
+class ConstraintAxes {
+public:
+    // Construct empty axis set.
+    ConstraintAxes();
+    // Remove all axes.
+    void clear();
+    // Append specified axis. Return false if the set is full, the axis is
+    // then not appended.
+    bool push_back(glm::vec3 axis);
+    // Return number of axes.
+    unsigned int size() const;
+    // Return true if there are no axes.
+    bool empty() const;
+    // Return axis at specified index.
+    glm::vec3 const & operator[](unsigned int index) const;
+    // Return pointer to the first axis.
+    glm::vec3 const * data() const;
+    glm::vec3 const * begin() const;
+    glm::vec3 const * end() const;
+    // Return true if both sets hold the same axes in the same order.
+    bool operator==(ConstraintAxes const & other) const;
+    bool operator!=(ConstraintAxes const & other) const;
+private:
+    std::array<glm::vec3, max_constraint_axes> axes;
+    unsigned int count;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "dragsolver.hpp"
+
+#include "constraintaxes.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// number of drags in a chunk, small enough that the chain does not wait long
+// for the first chunk
+const unsigned int chunk_size = 1024;
+
+// fill constraint axes in eye space the same way as the axis set policies of
+// ArcballCore
+void fill_axes(ConstraintAxes & axes, AxisSet axis_set, glm::quat inv, glm::quat now)
+{
+    switch (axis_set) {
+    case AxisSet::CAMERA:
+        axes.push_back(glm::vec3(1.0f, 0.0f, 0.0f));
+        axes.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+        axes.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+        break;
+    case AxisSet::BODY:
+    case AxisSet::WORLD: {
+        const glm::mat3 rotation = glm::mat3_cast(axis_set == AxisSet::BODY ? inv * now : inv);
+        axes.push_back(rotation[0]);
+        axes.push_back(rotation[1]);
+        axes.push_back(rotation[2]);
+        break;
+    }
+    case AxisSet::NONE:
+    case AxisSet::CUSTOM:
+        break;
+    }
+}
+
+}
+
+glm::quat solve_drag(DragSegment const & segment, glm::quat orientation, float radius)
+{
+    glm::vec3 from = ball_coord(glm::vec3(segment.from, 0.0f), radius);
+    glm::vec3 to = ball_coord(glm::vec3(segment.to, 0.0f), radius);
+
+    ConstraintAxes axes;
+    fill_axes(axes, segment.axis_set, glm::conjugate(segment.camera), orientation);
+    if (!axes.empty()) {
+        const glm::vec3 axis = axes[nearest_constraint(from, axes.data(), axes.size())];
+        from = constrain_to(from, axis);
+        to = constrain_to(to, axis);
+    }
+
+    return drag_rotation(from, to, segment.camera);
+}
+
+void solve_drags(
+    DragSegment const * segments,
+    unsigned int count,
+    glm::quat orientation,
+    float radius,
+    glm::quat * orientations)
+{
+    for (unsigned int i = 0; i < count; i++) {
+        orientation = glm::normalize(solve_drag(segments[i], orientation, radius) * orientation);
+        orientations[i] = orientation;
+    }
+}
+
+DragSolver::DragSolver(float radius, unsigned int threads)
+    : radius(radius),
+      pool(threads),
+      chunk_count(0),
+      next_chunk(0)
+{
+}
+
+// the calling thread chains the chunks in order and the other workers solve
+// the rotations of the chunks ahead of it, when the next chunk is not solved
+// yet the calling thread solves one itself rather than wait
+void DragSolver::solve(
+    std::vector<DragSegment> const & segments,
+    glm::quat orientation,
+    std::vector<glm::quat> & orientations)
+{
+    const unsigned int count = segments.size();
+    orientations.resize(count);
+    rotations.resize(count);
+
+    const unsigned int chunks = (count + chunk_size - 1) / chunk_size;
+    if (chunks > chunk_count) {
+        solved.reset(new std::atomic<bool>[chunks]);
+        chunk_count = chunks;
+    }
+    for (unsigned int i = 0; i < chunks; i++) {
+        solved[i] = false;
+    }
+    next_chunk = 0;
+
+    pool.run([&](unsigned int worker) {
+        if (worker != 0) {
+            while (solve_next_chunk(segments)) {
+            }
+            return;
+        }
+
+        for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+            while (!solved[chunk]) {
+                if (!solve_next_chunk(segments)) {
+                    std::this_thread::yield();
+                }
+            }
+
+            const unsigned int end = std::min((chunk + 1) * chunk_size, count);
+            for (unsigned int i = chunk * chunk_size; i < end; i++) {
+                const glm::quat rotation = segments[i].axis_set == AxisSet::BODY ?
+                    solve_drag(segments[i], orientation, radius) :
+                    rotations[i];
+                orientation = glm::normalize(rotation * orientation);
+                orientations[i] = orientation;
+            }
+        }
+    });
+}
+
+unsigned int DragSolver::get_threads() const
+{
+    return pool.size();
+}
+
+// solve the rotations of the next unclaimed chunk except for its body drags
+// and return false if every chunk is claimed
+bool DragSolver::solve_next_chunk(std::vector<DragSegment> const & segments)
+{
+    const unsigned int count = segments.size();
+    const unsigned int chunks = (count + chunk_size - 1) / chunk_size;
+    // checked before claiming so that waiting for a chunk does not keep
+    // incrementing the counter
+    if (next_chunk >= chunks) {
+        return false;
+    }
+    const unsigned int chunk = next_chunk++;
+    if (chunk >= chunks) {
+        return false;
+    }
+
+    const unsigned int end = std::min((chunk + 1) * chunk_size, count);
+    for (unsigned int i = chunk * chunk_size; i < end; i++) {
+        // the orientation is only used by body axes
+        if (segments[i].axis_set != AxisSet::BODY) {
+            rotations[i] = solve_drag(segments[i], glm::quat(), radius);
+        }
+    }
+
+    solved[chunk] = true;
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef DRAGSOLVER_HPP_INCLUDED
+#define DRAGSOLVER_HPP_INCLUDED
+
+#include "arcballmath.hpp"
+#include "workerpool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// A single drag of an arcball, pressed at one point and released at another
+// in window coordinates relative to the ball center, seen through a camera
+// with specified orientation. Custom axis sets are not supported.
+struct DragSegment {
+    glm::vec2 from;
+    glm::vec2 to;
+    AxisSet axis_set;
+    glm::quat camera;
+};
+
+// Return rotation of specified drag on a ball with specified radius, for an
+// arcball with specified orientation when the drag begins. The constraint
+// axis is the one nearest the pressed point, as an ArcballCore hovering
+// there before the press would pick it.
+glm::quat solve_drag(DragSegment const & segment, glm::quat orientation, float radius);
+// Set the orientation after every one of specified number of drags, each
+// starting where the one before ended and the first at specified
+// orientation. This gives the same orientations as an ArcballCore driven
+// through the drags.
+void solve_drags(
+    DragSegment const * segments,
+    unsigned int count,
+    glm::quat orientation,
+    float radius,
+    glm::quat * orientations);
+
+// The responsibility of this class is to solve long chains of drags on
+// every core. The rotation of a drag only depends on the orientation it
+// starts from for body axes, so every other rotation is solved in parallel
+// over chunks of drags while the calling thread chains the chunks in order
+// as they complete, solving body drags as it reaches them. The chain is the
+// same product as solving in order, so the orientations are identical.
+class DragSolver {
+public:
+    // Construct solver for a ball with specified radius, with specified
+    // number of threads or one per hardware thread if zero.
+    explicit DragSolver(float radius = 0.75f, unsigned int threads = 0);
+    // Replace specified orientations with the orientation after every one of
+    // specified drags, see solve_drags.
+    void solve(
+        std::vector<DragSegment> const & segments,
+        glm::quat orientation,
+        std::vector<glm::quat> & orientations);
+    // Return number of threads solving, including the calling thread.
+    unsigned int get_threads() const;
+private:
+    bool solve_next_chunk(std::vector<DragSegment> const & segments);
+
+    float radius;
+    WorkerPool pool;
+    unsigned int chunk_count;
+    std::atomic<unsigned int> next_chunk;
+    std::unique_ptr<std::atomic<bool>[]> solved;
+    std::vector<glm::quat> rotations;
+};
+
+#endif
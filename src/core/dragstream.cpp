@@ -0,0 +1,260 @@
+#include "dragstream.hpp"
+
+#include "mappedfile.hpp"
+#include "textparse.hpp"
+#include "trajectorycodec.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// A binary drag stream starts with an 8 byte magic "ARCDRAG" followed by the
+// format version, followed by segments until the end of the stream:
+//
+//     from       2 floats x, y
+//     to         2 floats x, y
+//     axes       1 byte   0 none, 1 camera, 2 body, 3 world
+//     camera     4 floats w, x, y, z
+//
+// every value is little endian so streams are portable between machines.
+
+namespace {
+
+const char magic[7] = { 'A', 'R', 'C', 'D', 'R', 'A', 'G' };
+const std::uint8_t version = 1;
+const unsigned int header_size = sizeof(magic) + 1;
+const unsigned int segment_size = 4 * 4 + 1 + 4 * 4;
+
+const char * const axis_set_names[4] = { "none", "camera", "body", "world" };
+
+void write_float(char * & out, float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; i++) {
+        *out++ = static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+}
+
+float read_float(char const * & in)
+{
+    std::uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        bits |= static_cast<std::uint32_t>(static_cast<unsigned char>(*in++)) << (8 * i);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool parse_separator(char const * & p, char const * end)
+{
+    skip_space(p, end);
+    if (p == end || *p != ',') {
+        return false;
+    }
+    p++;
+    skip_space(p, end);
+    return true;
+}
+
+bool parse_axis_set(char const * & p, char const * end, AxisSet & axis_set)
+{
+    for (unsigned int i = 0; i < 4; i++) {
+        const std::size_t length = std::strlen(axis_set_names[i]);
+        if (static_cast<std::size_t>(end - p) >= length && std::strncmp(p, axis_set_names[i], length) == 0) {
+            axis_set = static_cast<AxisSet>(i);
+            p += length;
+            return true;
+        }
+    }
+    return false;
+}
+
+// parse the floats of a segment in order, with the axis set after the
+// fourth
+bool parse_segment(char const * & p, char const * end, DragSegment & segment)
+{
+    float * const values[8] = {
+        &segment.from.x, &segment.from.y, &segment.to.x, &segment.to.y,
+        &segment.camera.w, &segment.camera.x, &segment.camera.y, &segment.camera.z
+    };
+
+    for (unsigned int i = 0; i < 8; i++) {
+        if (i > 0 && !parse_separator(p, end)) {
+            return false;
+        }
+        if (i == 4 && (!parse_axis_set(p, end, segment.axis_set) || !parse_separator(p, end))) {
+            return false;
+        }
+        if (!parse_float(p, end, *values[i])) {
+            return false;
+        }
+    }
+
+    skip_space(p, end);
+    return p == end;
+}
+
+bool is_binary(char const * begin, char const * end)
+{
+    return static_cast<std::size_t>(end - begin) >= header_size && std::memcmp(begin, magic, sizeof(magic)) == 0;
+}
+
+}
+
+bool parse_drag_segments(char const * begin, char const * end, std::vector<DragSegment> & segments)
+{
+    segments.clear();
+
+    for (char const * line = begin; line < end;) {
+        char const * eol = static_cast<char const *>(std::memchr(line, '\n', end - line));
+        if (!eol) {
+            eol = end;
+        }
+
+        char const * p = line;
+        skip_space(p, eol);
+        if (p < eol && *p != '#') {
+            DragSegment segment;
+            if (!parse_segment(p, eol, segment)) {
+                return false;
+            }
+            segments.push_back(segment);
+        }
+
+        line = eol + 1;
+    }
+
+    return true;
+}
+
+bool read_drag_segments(char const * begin, char const * end, std::vector<DragSegment> & segments)
+{
+    segments.clear();
+
+    if (!is_binary(begin, end) || static_cast<std::uint8_t>(begin[sizeof(magic)]) != version) {
+        return false;
+    }
+
+    const std::size_t size = end - begin - header_size;
+    if (size % segment_size != 0) {
+        return false;
+    }
+
+    segments.resize(size / segment_size);
+    char const * in = begin + header_size;
+    for (auto & segment : segments) {
+        segment.from.x = read_float(in);
+        segment.from.y = read_float(in);
+        segment.to.x = read_float(in);
+        segment.to.y = read_float(in);
+        const std::uint8_t axes = static_cast<std::uint8_t>(*in++);
+        if (axes > 3) {
+            return false;
+        }
+        segment.axis_set = static_cast<AxisSet>(axes);
+        segment.camera.w = read_float(in);
+        segment.camera.x = read_float(in);
+        segment.camera.y = read_float(in);
+        segment.camera.z = read_float(in);
+    }
+
+    return true;
+}
+
+bool load_drag_segments(std::string const & path, std::vector<DragSegment> & segments)
+{
+    std::vector<char> buffer;
+    char const * begin = nullptr;
+    char const * end = nullptr;
+
+    MappedFile file;
+    if (path == "-") {
+        buffer.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        begin = buffer.data();
+        end = begin + buffer.size();
+    } else {
+        if (!file.open(path)) {
+            return false;
+        }
+        begin = file.data();
+        end = begin + file.size();
+    }
+
+    if (is_binary(begin, end)) {
+        return read_drag_segments(begin, end, segments);
+    }
+    return parse_drag_segments(begin, end, segments);
+}
+
+bool save_drag_segments(std::string const & path, std::vector<DragSegment> const & segments)
+{
+    std::vector<char> content(header_size + segments.size() * segment_size);
+    std::memcpy(content.data(), magic, sizeof(magic));
+    content[sizeof(magic)] = static_cast<char>(version);
+
+    char * out = content.data() + header_size;
+    for (auto const & segment : segments) {
+        write_float(out, segment.from.x);
+        write_float(out, segment.from.y);
+        write_float(out, segment.to.x);
+        write_float(out, segment.to.y);
+        *out++ = static_cast<char>(segment.axis_set);
+        write_float(out, segment.camera.w);
+        write_float(out, segment.camera.x);
+        write_float(out, segment.camera.y);
+        write_float(out, segment.camera.z);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), content.size());
+    return static_cast<bool>(file);
+}
+
+// the CSV has enough digits to read back the same floats
+bool save_orientations(std::string const & path, std::vector<glm::quat> const & orientations)
+{
+    auto has_extension = [&](std::string const & extension) {
+        return path.size() >= extension.size() &&
+               path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (has_extension(".traj")) {
+        TrajectoryWriter trajectory;
+        if (!trajectory.open(path)) {
+            return false;
+        }
+        for (auto const & q : orientations) {
+            trajectory.append(q);
+        }
+        return trajectory.close();
+    }
+
+    const bool csv = has_extension(".csv");
+
+    std::vector<char> content;
+    if (csv) {
+        char line[80];
+        for (auto const & q : orientations) {
+            const int length = std::snprintf(line, sizeof(line), "%.9g,%.9g,%.9g,%.9g\n", q.w, q.x, q.y, q.z);
+            content.insert(content.end(), line, line + length);
+        }
+    } else {
+        content.resize(orientations.size() * 16);
+        char * out = content.data();
+        for (auto const & q : orientations) {
+            write_float(out, q.w);
+            write_float(out, q.x);
+            write_float(out, q.y);
+            write_float(out, q.z);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), content.size());
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,34 @@
+#ifndef DRAGSTREAM_HPP_INCLUDED
+#define DRAGSTREAM_HPP_INCLUDED
+
+#include "dragsolver.hpp"
+
+#include <string>
+#include <vector>
+
+// Parse drag segments from CSV content between specified pointers into
+// specified segments. Every line holds one segment as
+//
+//     from_x,from_y,to_x,to_y,axes,camera_w,camera_x,camera_y,camera_z
+//
+// where axes is none, camera, body or world. Empty lines and lines starting
+// with # are skipped. Return false if a line is malformed.
+bool parse_drag_segments(char const * begin, char const * end, std::vector<DragSegment> & segments);
+// Read drag segments from binary content between specified pointers into
+// specified segments. Return false if the content is not a drag stream or
+// is truncated.
+bool read_drag_segments(char const * begin, char const * end, std::vector<DragSegment> & segments);
+// Load drag segments from the file at specified path, or from standard input
+// if the path is "-". The content is CSV if it does not begin like a binary
+// drag stream. Return false if it could not be read or is malformed.
+bool load_drag_segments(std::string const & path, std::vector<DragSegment> & segments);
+// Save specified drag segments as a binary drag stream to the file at
+// specified path. Return false if the file could not be written.
+bool save_drag_segments(std::string const & path, std::vector<DragSegment> const & segments);
+// Save specified orientations to the file at specified path, as CSV lines of
+// w,x,y,z if the path ends with .csv, as a compressed trajectory with the
+// default precision if it ends with .traj and as little endian floats w, x,
+// y, z otherwise. Return false if the file could not be written.
+bool save_orientations(std::string const & path, std::vector<glm::quat> const & orientations);
+
+#endif
@@ -0,0 +1,67 @@
+#include "mappedfile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile()
+    : address(nullptr),
+      length(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(std::string const & path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // an empty file can not be mapped but is still a valid file
+    if (status.st_size > 0) {
+        void * mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        address = mapped;
+        length = status.st_size;
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (address) {
+        munmap(address, length);
+    }
+    address = nullptr;
+    length = 0;
+}
+
+char const * MappedFile::data() const
+{
+    return static_cast<char const *>(address);
+}
+
+std::size_t MappedFile::size() const
+{
+    return length;
+}
@@ -0,0 +1,31 @@
+#ifndef MAPPEDFILE_HPP_INCLUDED
+#define MAPPEDFILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// The responsibility of this class is to map the content of a file read-only
+// into memory for as long as it lives.
+class MappedFile {
+public:
+    // Construct without a mapped file.
+    MappedFile();
+    // Unmap file.
+    ~MappedFile();
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+    // Map file at specified path, any previously mapped file is unmapped.
+    // Return false if the file could not be mapped.
+    bool open(std::string const & path);
+    // Unmap file.
+    void close();
+    // Return mapped content, null if the file is empty or not mapped.
+    char const * data() const;
+    // Return size of mapped content in bytes.
+    std::size_t size() const;
+private:
+    void * address;
+    std::size_t length;
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include "meshcache.hpp"
+#include "objloader.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+// A compiled mesh is a header followed by the vertex positions, the vertex
+// normals and the triangle indices, all in the layout and byte order of the
+// machine that compiled it so that they can be used where they are mapped.
+
+namespace {
+
+const char magic[8] = { 'A', 'R', 'C', 'M', 'E', 'S', 'H', '\0' };
+const std::uint32_t version = 1;
+const std::uint32_t byte_order = 0x01020304;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t source_hash;
+    std::uint64_t source_size;
+    std::uint32_t vertex_count;
+    std::uint32_t index_count;
+};
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "vertices must be tightly packed");
+static_assert(sizeof(Header) % sizeof(float) == 0, "vertices must be aligned");
+
+}
+
+MeshCache::MeshCache()
+    : vertex_count(0),
+      index_count(0),
+      positions(nullptr),
+      normals(nullptr),
+      indices(nullptr)
+{
+}
+
+bool MeshCache::open(std::string const & obj_path, std::string const & cache_path)
+{
+    compiled = MeshData();
+
+    MappedFile obj;
+    if (!obj.open(obj_path)) {
+        return false;
+    }
+
+    const std::uint64_t source_hash = content_hash(obj.data(), obj.size());
+    if (map(cache_path, source_hash, obj.size())) {
+        return true;
+    }
+
+    MeshData mesh;
+    if (!parse_obj(obj.data(), obj.data() + obj.size(), mesh)) {
+        return false;
+    }
+
+    if (write_mesh_cache(cache_path, mesh, source_hash, obj.size()) &&
+        map(cache_path, source_hash, obj.size())) {
+        return true;
+    }
+
+    // the mesh is used from memory rather than parsing it again
+    compiled = std::move(mesh);
+    vertex_count = compiled.positions.size();
+    index_count = compiled.indices.size();
+    positions = compiled.positions.data();
+    normals = compiled.normals.data();
+    indices = compiled.indices.data();
+    return true;
+}
+
+bool MeshCache::is_mapped() const
+{
+    return cache.data() != nullptr;
+}
+
+unsigned int MeshCache::get_vertex_count() const
+{
+    return vertex_count;
+}
+
+unsigned int MeshCache::get_index_count() const
+{
+    return index_count;
+}
+
+glm::vec3 const * MeshCache::get_positions() const
+{
+    return positions;
+}
+
+glm::vec3 const * MeshCache::get_normals() const
+{
+    return normals;
+}
+
+unsigned int const * MeshCache::get_indices() const
+{
+    return indices;
+}
+
+void MeshCache::copy_to(MeshData & mesh) const
+{
+    mesh.positions.assign(positions, positions + vertex_count);
+    mesh.normals.assign(normals, normals + vertex_count);
+    mesh.indices.assign(indices, indices + index_count);
+}
+
+// map compiled copy at specified path, return false unless it is complete
+// and compiled from content with specified hash and size
+bool MeshCache::map(std::string const & cache_path, std::uint64_t source_hash, std::uint64_t source_size)
+{
+    vertex_count = 0;
+    index_count = 0;
+    positions = nullptr;
+    normals = nullptr;
+    indices = nullptr;
+
+    if (!cache.open(cache_path) || cache.size() < sizeof(Header)) {
+        cache.close();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, cache.data(), sizeof(header));
+
+    const std::uint64_t expected_size = sizeof(Header) +
+                                        2 * sizeof(glm::vec3) * static_cast<std::uint64_t>(header.vertex_count) +
+                                        sizeof(unsigned int) * static_cast<std::uint64_t>(header.index_count);
+    const bool valid = std::memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+                       header.version == version &&
+                       header.byte_order == byte_order &&
+                       header.source_hash == source_hash &&
+                       header.source_size == source_size &&
+                       header.index_count % 3 == 0 &&
+                       cache.size() == expected_size;
+    if (!valid) {
+        cache.close();
+        return false;
+    }
+
+    char const * data = cache.data() + sizeof(Header);
+    positions = reinterpret_cast<glm::vec3 const *>(data);
+    normals = positions + header.vertex_count;
+    indices = reinterpret_cast<unsigned int const *>(normals + header.vertex_count);
+
+    // a damaged copy must not make anyone index out of bounds
+    for (std::uint32_t i = 0; i < header.index_count; i++) {
+        if (indices[i] >= header.vertex_count) {
+            cache.close();
+            positions = nullptr;
+            normals = nullptr;
+            indices = nullptr;
+            return false;
+        }
+    }
+
+    vertex_count = header.vertex_count;
+    index_count = header.index_count;
+    return true;
+}
+
+bool write_mesh_cache(
+    std::string const & path,
+    MeshData const & mesh,
+    std::uint64_t source_hash,
+    std::uint64_t source_size)
+{
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byte_order = byte_order;
+    header.source_hash = source_hash;
+    header.source_size = source_size;
+    header.vertex_count = mesh.positions.size();
+    header.index_count = mesh.indices.size();
+
+    // written aside and renamed into place so that a reader never maps a
+    // partially written copy
+    const std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const *>(mesh.positions.data()), mesh.positions.size() * sizeof(glm::vec3));
+        out.write(reinterpret_cast<char const *>(mesh.normals.data()), mesh.normals.size() * sizeof(glm::vec3));
+        out.write(reinterpret_cast<char const *>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+        if (!out) {
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+    }
+
+    return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+// FNV-1a over eight bytes at a time, hashing a large file must stay far
+// cheaper than parsing it
+std::uint64_t content_hash(char const * data, std::size_t size)
+{
+    const std::uint64_t prime = 1099511628211ull;
+    std::uint64_t hash = 14695981039346656037ull;
+
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+
+    return hash;
+}
@@ -0,0 +1,62 @@
+#ifndef MESHCACHE_HPP_INCLUDED
+#define MESHCACHE_HPP_INCLUDED
+
+#include "mappedfile.hpp"
+#include "meshdata.hpp"
+
+#include <cstdint>
+#include <string>
+
+// The responsibility of this class is to keep a compiled copy of an OBJ
+// file, flat pre-triangulated indexed positions and normals, and to map that
+// copy straight into memory instead of parsing the OBJ file. The copy is
+// compiled on first use and compiled again whenever the hash of the OBJ
+// content no longer matches the one it was compiled from. When the copy can
+// not be written, as for read-only assets, the compiled mesh is kept in
+// memory instead so the OBJ file is still only parsed once.
+class MeshCache {
+public:
+    // Construct without a mapped mesh.
+    MeshCache();
+    // Map compiled copy at cache path of the OBJ file at obj path, it is
+    // compiled first if it is missing or stale. Return false if the OBJ file
+    // could not be read.
+    bool open(std::string const & obj_path, std::string const & cache_path);
+    // Return true if the mesh is mapped from the compiled copy, false if it
+    // is held in memory since the copy could not be written.
+    bool is_mapped() const;
+    // Return number of vertices.
+    unsigned int get_vertex_count() const;
+    // Return number of indices, three for every triangle.
+    unsigned int get_index_count() const;
+    // Return vertex positions.
+    glm::vec3 const * get_positions() const;
+    // Return vertex normals.
+    glm::vec3 const * get_normals() const;
+    // Return triangle indices.
+    unsigned int const * get_indices() const;
+    // Copy mapped mesh to specified mesh.
+    void copy_to(MeshData & mesh) const;
+private:
+    bool map(std::string const & cache_path, std::uint64_t source_hash, std::uint64_t source_size);
+
+    MappedFile cache;
+    MeshData compiled;
+    unsigned int vertex_count;
+    unsigned int index_count;
+    glm::vec3 const * positions;
+    glm::vec3 const * normals;
+    unsigned int const * indices;
+};
+
+// Write specified mesh compiled from content with specified hash and size to
+// specified path. Return false if it could not be written.
+bool write_mesh_cache(
+    std::string const & path,
+    MeshData const & mesh,
+    std::uint64_t source_hash,
+    std::uint64_t source_size);
+// Return 64-bit hash of specified content.
+std::uint64_t content_hash(char const * data, std::size_t size);
+
+#endif
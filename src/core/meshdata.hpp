@@ -0,0 +1,16 @@
+#ifndef MESHDATA_HPP_INCLUDED
+#define MESHDATA_HPP_INCLUDED
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Indexed triangle mesh, every vertex has a position and a normal and every
+// three indices form a triangle.
+struct MeshData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<unsigned int> indices;
+};
+
+#endif
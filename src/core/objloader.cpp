@@ -0,0 +1,419 @@
+#include "objloader.hpp"
+#include "mappedfile.hpp"
+#include "textparse.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// a corner of a face, indices into the positions and normals of the file
+// where a missing normal is -1
+struct Corner {
+    int position;
+    int normal;
+};
+
+// flags of a corner parsed by a chunk whose negative index was resolved
+// relative to the beginning of the chunk, which is only known once every
+// chunk before it is parsed
+const unsigned char POSITION_IN_CHUNK = 1 << 0;
+const unsigned char NORMAL_IN_CHUNK = 1 << 1;
+
+// elements parsed from a range of whole lines
+struct Chunk {
+    char const * begin;
+    char const * end;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<Corner> corners;
+    std::vector<unsigned char> corner_flags;
+    bool valid;
+};
+
+// content smaller than this is not worth another thread
+const std::size_t min_chunk_size = 1 << 20;
+
+// key of an unused slot in a vertex index
+const std::uint64_t empty_key = ~0ull;
+
+bool parse_vec3(char const * & p, char const * end, glm::vec3 & value)
+{
+    for (int i = 0; i < 3; i++) {
+        skip_space(p, end);
+        if (!parse_float(p, end, value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// parse "v", "v/vt", "v//vn" or "v/vt/vn" where negative indices are relative
+// to the end of the elements read so far
+bool parse_corner(
+    char const * & p,
+    char const * end,
+    int position_count,
+    int normal_count,
+    Corner & corner,
+    unsigned char & flags)
+{
+    int index;
+    if (!parse_int(p, end, index)) {
+        return false;
+    }
+    corner.position = index < 0 ? position_count + index : index - 1;
+    corner.normal = -1;
+    flags = index < 0 ? POSITION_IN_CHUNK : 0;
+
+    if (p < end && *p == '/') {
+        p++;
+        if (p < end && *p != '/') {
+            // texture coordinates are not used
+            if (!parse_int(p, end, index)) {
+                return false;
+            }
+        }
+        if (p < end && *p == '/') {
+            p++;
+            if (!parse_int(p, end, index)) {
+                return false;
+            }
+            corner.normal = index < 0 ? normal_count + index : index - 1;
+            flags |= index < 0 ? NORMAL_IN_CHUNK : 0;
+        }
+    }
+
+    return true;
+}
+
+char const * line_end(char const * p, char const * end)
+{
+    char const * eol = static_cast<char const *>(std::memchr(p, '\n', end - p));
+    return eol ? eol : end;
+}
+
+// return beginning of the comment on the line between specified pointers, or
+// the end of the line if it has none
+char const * comment_start(char const * p, char const * eol)
+{
+    char const * comment = static_cast<char const *>(std::memchr(p, '#', eol - p));
+    return comment ? comment : eol;
+}
+
+// parse every line of specified chunk up to its comment, indices are left as
+// they are in the file except for negative indices which are made relative to
+// the chunk
+void parse_chunk(Chunk & chunk)
+{
+    std::vector<Corner> polygon;
+    std::vector<unsigned char> polygon_flags;
+    chunk.valid = false;
+
+    for (char const * p = chunk.begin; p < chunk.end; ) {
+        char const * eol = line_end(p, chunk.end);
+        char const * content_end = comment_start(p, eol);
+        skip_space(p, content_end);
+
+        if (content_end - p >= 2 && p[0] == 'v' && is_space(p[1])) {
+            glm::vec3 position;
+            p++;
+            if (!parse_vec3(p, content_end, position)) {
+                return;
+            }
+            chunk.positions.push_back(position);
+        } else if (content_end - p >= 3 && p[0] == 'v' && p[1] == 'n' && is_space(p[2])) {
+            glm::vec3 normal;
+            p += 2;
+            if (!parse_vec3(p, content_end, normal)) {
+                return;
+            }
+            chunk.normals.push_back(normal);
+        } else if (content_end - p >= 2 && p[0] == 'f' && is_space(p[1])) {
+            p++;
+            polygon.clear();
+            polygon_flags.clear();
+            for (skip_space(p, content_end); p < content_end; skip_space(p, content_end)) {
+                Corner corner;
+                unsigned char flags;
+                if (!parse_corner(p, content_end, chunk.positions.size(), chunk.normals.size(), corner, flags)) {
+                    return;
+                }
+                polygon.push_back(corner);
+                polygon_flags.push_back(flags);
+            }
+            if (polygon.size() < 3) {
+                return;
+            }
+            for (unsigned int i = 1; i + 1 < polygon.size(); i++) {
+                const unsigned int fan[3] = { 0, i, i + 1 };
+                for (auto j : fan) {
+                    chunk.corners.push_back(polygon[j]);
+                    chunk.corner_flags.push_back(polygon_flags[j]);
+                }
+            }
+        }
+
+        p = eol + 1;
+    }
+
+    chunk.valid = true;
+}
+
+// resolve chunk relative indices of specified chunk with the number of
+// positions and normals in the chunks before it, return false if an index is
+// out of bounds
+bool resolve_chunk(Chunk & chunk, int position_offset, int normal_offset, int position_count, int normal_count)
+{
+    for (unsigned int i = 0; i < chunk.corners.size(); i++) {
+        Corner & corner = chunk.corners[i];
+        if (chunk.corner_flags[i] & POSITION_IN_CHUNK) {
+            corner.position += position_offset;
+        }
+        if (chunk.corner_flags[i] & NORMAL_IN_CHUNK) {
+            corner.normal += normal_offset;
+        }
+        if (corner.position < 0 || corner.position >= position_count ||
+            corner.normal < -1 || corner.normal >= normal_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The responsibility of this class is to map a corner, a position and normal
+// index pair, to the vertex created for it. It is an open addressing hash
+// table with linear probing that is kept at most half full.
+class VertexIndex {
+public:
+    // Construct index with room for specified number of vertices before it
+    // has to grow.
+    explicit VertexIndex(std::size_t count)
+        : size(0)
+    {
+        std::size_t capacity = 16;
+        while (capacity < 2 * count) {
+            capacity *= 2;
+        }
+        allocate(capacity);
+    }
+
+    // Return vertex of specified corner, or specified new vertex if the
+    // corner is new.
+    unsigned int insert(Corner corner, unsigned int vertex, bool & inserted)
+    {
+        if (2 * (size + 1) > keys.size()) {
+            grow();
+        }
+
+        const std::uint64_t key = static_cast<std::uint64_t>(corner.position) << 32 |
+                                  static_cast<std::uint32_t>(corner.normal + 1);
+        std::size_t slot = find(key);
+        if (keys[slot] == key) {
+            inserted = false;
+            return vertices[slot];
+        }
+
+        keys[slot] = key;
+        vertices[slot] = vertex;
+        size++;
+        inserted = true;
+        return vertex;
+    }
+private:
+    static std::uint64_t hash(std::uint64_t key)
+    {
+        // finalizer of MurmurHash3
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        key *= 0xc4ceb93fe53a85cdull;
+        key ^= key >> 33;
+        return key;
+    }
+
+    // return slot holding specified key or the empty slot where it belongs
+    std::size_t find(std::uint64_t key) const
+    {
+        std::size_t slot = hash(key) & mask;
+        while (keys[slot] != empty_key && keys[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void allocate(std::size_t capacity)
+    {
+        mask = capacity - 1;
+        keys.assign(capacity, empty_key);
+        vertices.resize(capacity);
+    }
+
+    void grow()
+    {
+        std::vector<std::uint64_t> old_keys;
+        std::vector<unsigned int> old_vertices;
+        old_keys.swap(keys);
+        old_vertices.swap(vertices);
+
+        allocate(2 * old_keys.size());
+        for (std::size_t i = 0; i < old_keys.size(); i++) {
+            if (old_keys[i] != empty_key) {
+                const std::size_t slot = find(old_keys[i]);
+                keys[slot] = old_keys[i];
+                vertices[slot] = old_vertices[i];
+            }
+        }
+    }
+
+    std::size_t size;
+    std::size_t mask;
+    std::vector<std::uint64_t> keys;
+    std::vector<unsigned int> vertices;
+};
+
+// run specified function with the index of every chunk, each on its own
+// thread except the first which runs on the calling thread
+template <typename Function>
+void for_each_chunk(unsigned int count, Function function)
+{
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < count; i++) {
+        threads.emplace_back(function, i);
+    }
+    function(0);
+    for (auto & thread : threads) {
+        thread.join();
+    }
+}
+
+}
+
+bool load_obj(std::string const & path, MeshData & mesh)
+{
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    return parse_obj(file.data(), file.data() + file.size(), mesh);
+}
+
+// the content is split into chunks of whole lines which are parsed in
+// parallel, then the chunks are stitched together in file order so the
+// result is the same as parsing it all at once
+bool parse_obj(char const * begin, char const * end, MeshData & mesh)
+{
+    const std::size_t size = end - begin;
+    const unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int count = std::max<std::size_t>(1, std::min<std::size_t>(threads, size / min_chunk_size));
+
+    std::vector<Chunk> chunks(count);
+    char const * chunk_begin = begin;
+    for (unsigned int i = 0; i < count; i++) {
+        char const * chunk_end = i + 1 == count ? end : begin + size * (i + 1) / count;
+        if (chunk_end < chunk_begin) {
+            chunk_end = chunk_begin;
+        }
+        if (chunk_end < end) {
+            chunk_end = line_end(chunk_end, end);
+        }
+        chunks[i].begin = chunk_begin;
+        chunks[i].end = chunk_end;
+        chunk_begin = chunk_end < end ? chunk_end + 1 : end;
+    }
+
+    for_each_chunk(count, [&chunks](unsigned int i) {
+        parse_chunk(chunks[i]);
+    });
+
+    std::vector<int> position_offsets(count);
+    std::vector<int> normal_offsets(count);
+    std::size_t position_count = 0;
+    std::size_t normal_count = 0;
+    std::size_t corner_count = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (!chunks[i].valid) {
+            return false;
+        }
+        position_offsets[i] = position_count;
+        normal_offsets[i] = normal_count;
+        position_count += chunks[i].positions.size();
+        normal_count += chunks[i].normals.size();
+        corner_count += chunks[i].corners.size();
+    }
+
+    std::vector<char> resolved(count);
+    for_each_chunk(count, [&](unsigned int i) {
+        resolved[i] = resolve_chunk(chunks[i], position_offsets[i], normal_offsets[i], position_count, normal_count);
+    });
+    for (auto chunk_resolved : resolved) {
+        if (!chunk_resolved) {
+            return false;
+        }
+    }
+
+    std::vector<glm::vec3> file_positions;
+    std::vector<glm::vec3> file_normals;
+    file_positions.reserve(position_count);
+    file_normals.reserve(normal_count);
+    for (auto & chunk : chunks) {
+        file_positions.insert(file_positions.end(), chunk.positions.begin(), chunk.positions.end());
+        file_normals.insert(file_normals.end(), chunk.normals.begin(), chunk.normals.end());
+        std::vector<glm::vec3>().swap(chunk.positions);
+        std::vector<glm::vec3>().swap(chunk.normals);
+    }
+
+    // area weighted face normals summed per position, only needed when some
+    // corner is without a normal
+    bool missing_normals = false;
+    for (auto const & chunk : chunks) {
+        for (auto const & corner : chunk.corners) {
+            missing_normals = missing_normals || corner.normal < 0;
+        }
+    }
+
+    std::vector<glm::vec3> smooth_normals;
+    if (missing_normals) {
+        smooth_normals.assign(position_count, glm::vec3(0.0f));
+        for (auto const & chunk : chunks) {
+            for (unsigned int i = 0; i < chunk.corners.size(); i += 3) {
+                Corner const * triangle = &chunk.corners[i];
+                glm::vec3 a = file_positions[triangle[0].position];
+                glm::vec3 b = file_positions[triangle[1].position];
+                glm::vec3 c = file_positions[triangle[2].position];
+                glm::vec3 face_normal = glm::cross(b - a, c - a);
+                for (unsigned int j = 0; j < 3; j++) {
+                    smooth_normals[triangle[j].position] += face_normal;
+                }
+            }
+        }
+    }
+
+    mesh.positions.clear();
+    mesh.normals.clear();
+    mesh.indices.clear();
+    mesh.positions.reserve(position_count);
+    mesh.normals.reserve(position_count);
+    mesh.indices.reserve(corner_count);
+
+    // most files share about one normal per position, the index grows if
+    // they do not
+    VertexIndex vertices(std::min(corner_count, position_count));
+    for (auto const & chunk : chunks) {
+        for (auto const & corner : chunk.corners) {
+            bool inserted;
+            const unsigned int vertex = vertices.insert(corner, mesh.positions.size(), inserted);
+            if (inserted) {
+                glm::vec3 normal = corner.normal < 0 ? smooth_normals[corner.position] : file_normals[corner.normal];
+                const float length = glm::length(normal);
+                mesh.positions.push_back(file_positions[corner.position]);
+                mesh.normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f));
+            }
+            mesh.indices.push_back(vertex);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef OBJLOADER_HPP_INCLUDED
+#define OBJLOADER_HPP_INCLUDED
+
+#include "meshdata.hpp"
+
+#include <string>
+
+// Load the geometry of the Wavefront OBJ file at specified path into
+// specified mesh, see parse_obj. Return false if the file could not be read
+// or is malformed.
+bool load_obj(std::string const & path, MeshData & mesh);
+// Parse the geometry of Wavefront OBJ content between specified pointers
+// into specified mesh. Only positions, normals and faces are read, polygons
+// are triangulated as fans and corners with the same position and normal
+// become a single vertex. Vertices without a normal get the area weighted
+// average of the faces around their position. Return false if the content
+// is malformed.
+bool parse_obj(char const * begin, char const * end, MeshData & mesh);
+
+#endif
@@ -0,0 +1,369 @@
+#include "pngwriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+const unsigned int bytes_per_pixel = 3;
+
+// deflate matches back at most a window and hashes three bytes to find them
+const unsigned int window_size = 32768;
+const unsigned int hash_size = 1 << 15;
+const unsigned int min_match = 3;
+const unsigned int max_match = 258;
+// number of earlier positions with the same hash tried for a match
+const unsigned int max_chain = 16;
+// the positions within longer matches are not hashed, long matches are mostly
+// runs of the background which find each other anyway
+const unsigned int max_insert = 32;
+
+const unsigned int length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const unsigned int length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const unsigned int distance_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const unsigned int distance_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// The responsibility of this class is to append bits to bytes, least
+// significant bit first as deflate requires.
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<unsigned char> & out)
+        : out(out),
+          buffer(0),
+          count(0)
+    {
+    }
+
+    void write(std::uint32_t bits, unsigned int length)
+    {
+        buffer |= bits << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back(buffer & 0xff);
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes are stored most significant bit first
+    void write_code(std::uint32_t code, unsigned int length)
+    {
+        std::uint32_t reversed = 0;
+        for (unsigned int i = 0; i < length; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        write(reversed, length);
+    }
+
+    void flush()
+    {
+        if (count > 0) {
+            out.push_back(buffer & 0xff);
+        }
+        buffer = 0;
+        count = 0;
+    }
+private:
+    std::vector<unsigned char> & out;
+    std::uint32_t buffer;
+    unsigned int count;
+};
+
+// write literal or length symbol with its fixed Huffman code
+void write_symbol(BitWriter & bits, unsigned int symbol)
+{
+    if (symbol < 144) {
+        bits.write_code(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        bits.write_code(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        bits.write_code(symbol - 256, 7);
+    } else {
+        bits.write_code(0xc0 + symbol - 280, 8);
+    }
+}
+
+void write_match(BitWriter & bits, unsigned int length, unsigned int distance)
+{
+    unsigned int l = 28;
+    while (length_base[l] > length) {
+        l--;
+    }
+    write_symbol(bits, 257 + l);
+    bits.write(length - length_base[l], length_extra[l]);
+
+    unsigned int d = 29;
+    while (distance_base[d] > distance) {
+        d--;
+    }
+    bits.write_code(d, 5);
+    bits.write(distance - distance_base[d], distance_extra[d]);
+}
+
+unsigned int hash(unsigned char const * p)
+{
+    return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (hash_size - 1);
+}
+
+// the sums are only reduced every 5552 bytes, the most that can be added
+// before they overflow
+std::uint32_t adler32(std::vector<unsigned char> const & data)
+{
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    for (std::size_t begin = 0; begin < data.size(); begin += 5552) {
+        const std::size_t end = std::min(begin + 5552, data.size());
+        for (std::size_t i = begin; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// append zlib stream of specified data as a single block of fixed Huffman
+// codes, with greedy matches found through hash chains
+void deflate(std::vector<unsigned char> const & data, std::vector<unsigned char> & out)
+{
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    BitWriter bits(out);
+    bits.write(1, 1);
+    bits.write(1, 2);
+
+    std::vector<int> head(hash_size, -1);
+    std::vector<int> previous(window_size, -1);
+    auto insert = [&](unsigned int position)
+    {
+        const unsigned int h = hash(&data[position]);
+        previous[position % window_size] = head[h];
+        head[h] = position;
+    };
+
+    const unsigned int size = data.size();
+    unsigned int position = 0;
+    while (position < size) {
+        unsigned int best_length = 0;
+        unsigned int best_distance = 0;
+
+        if (position + min_match <= size) {
+            const unsigned int limit = std::min(max_match, size - position);
+            int candidate = head[hash(&data[position])];
+            for (unsigned int chain = 0; chain < max_chain && candidate >= 0; chain++) {
+                const unsigned int distance = position - candidate;
+                if (distance > window_size) {
+                    break;
+                }
+                unsigned int length = 0;
+                while (length < limit && data[candidate + length] == data[position + length]) {
+                    length++;
+                }
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = distance;
+                    if (length == limit) {
+                        break;
+                    }
+                }
+                candidate = previous[candidate % window_size];
+            }
+            insert(position);
+        }
+
+        if (best_length >= min_match) {
+            write_match(bits, best_length, best_distance);
+            if (best_length <= max_insert) {
+                for (unsigned int i = position + 1; i < position + best_length && i + min_match <= size; i++) {
+                    insert(i);
+                }
+            }
+            position += best_length;
+        } else {
+            write_symbol(bits, data[position]);
+            position++;
+        }
+    }
+
+    write_symbol(bits, 256);
+    bits.flush();
+
+    const std::uint32_t checksum = adler32(data);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((checksum >> shift) & 0xff);
+    }
+}
+
+std::array<std::uint32_t, 256> const & crc_table()
+{
+    static const std::array<std::uint32_t, 256> table = []()
+    {
+        std::array<std::uint32_t, 256> table;
+        for (unsigned int i = 0; i < 256; i++) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }();
+    return table;
+}
+
+void write_u32(std::vector<unsigned char> & out, std::uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((value >> shift) & 0xff);
+    }
+}
+
+void write_chunk(std::vector<unsigned char> & png, char const * type, std::vector<unsigned char> const & data)
+{
+    write_u32(png, data.size());
+
+    const std::size_t begin = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+
+    auto const & table = crc_table();
+    std::uint32_t crc = 0xffffffffu;
+    for (std::size_t i = begin; i < png.size(); i++) {
+        crc = table[(crc ^ png[i]) & 0xff] ^ (crc >> 8);
+    }
+    write_u32(png, crc ^ 0xffffffffu);
+}
+
+unsigned char paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// append every row with the filter that leaves the smallest differences,
+// which is what compresses best for most images
+void filter_rows(
+    unsigned int width,
+    unsigned int height,
+    std::vector<unsigned char> const & rgb,
+    std::vector<unsigned char> & filtered)
+{
+    const unsigned int row_size = width * bytes_per_pixel;
+    const std::vector<unsigned char> zero_row(row_size, 0);
+    const unsigned char filter_types[4] = { 0, 1, 2, 4 };
+    std::array<std::vector<unsigned char>, 4> candidates;
+    for (auto & candidate : candidates) {
+        candidate.resize(row_size);
+    }
+
+    for (unsigned int y = 0; y < height; y++) {
+        unsigned char const * row = &rgb[y * row_size];
+        unsigned char const * above = y > 0 ? &rgb[(y - 1) * row_size] : zero_row.data();
+
+        unsigned int best = 0;
+        unsigned long best_cost = ~0ul;
+        for (unsigned int f = 0; f < 4; f++) {
+            unsigned long cost = 0;
+            for (unsigned int i = 0; i < row_size; i++) {
+                const int a = i >= bytes_per_pixel ? row[i - bytes_per_pixel] : 0;
+                const int b = above[i];
+                const int c = i >= bytes_per_pixel ? above[i - bytes_per_pixel] : 0;
+
+                int predicted = 0;
+                switch (filter_types[f]) {
+                case 1:
+                    predicted = a;
+                    break;
+                case 2:
+                    predicted = b;
+                    break;
+                case 4:
+                    predicted = paeth(a, b, c);
+                    break;
+                }
+
+                const unsigned char value = row[i] - predicted;
+                candidates[f][i] = value;
+                cost += value < 128 ? value : 256 - value;
+            }
+            if (cost < best_cost) {
+                best = f;
+                best_cost = cost;
+            }
+        }
+
+        filtered.push_back(filter_types[best]);
+        filtered.insert(filtered.end(), candidates[best].begin(), candidates[best].end());
+    }
+}
+
+}
+
+void encode_png(
+    unsigned int width,
+    unsigned int height,
+    std::vector<unsigned char> const & rgb,
+    std::vector<unsigned char> & png)
+{
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    png.assign(signature, signature + sizeof(signature));
+
+    // 8-bit truecolor without interlacing
+    std::vector<unsigned char> header;
+    write_u32(header, width);
+    write_u32(header, height);
+    header.push_back(8);
+    header.push_back(2);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    write_chunk(png, "IHDR", header);
+
+    std::vector<unsigned char> filtered;
+    filtered.reserve(height * (width * bytes_per_pixel + 1));
+    filter_rows(width, height, rgb, filtered);
+
+    std::vector<unsigned char> compressed;
+    deflate(filtered, compressed);
+    write_chunk(png, "IDAT", compressed);
+
+    write_chunk(png, "IEND", std::vector<unsigned char>());
+}
+
+bool write_png(
+    std::string const & path,
+    unsigned int width,
+    unsigned int height,
+    std::vector<unsigned char> const & rgb)
+{
+    std::vector<unsigned char> png;
+    encode_png(width, height, rgb, png);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<char const *>(png.data()), png.size());
+    return static_cast<bool>(out);
+}
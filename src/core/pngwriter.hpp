@@ -0,0 +1,24 @@
+#ifndef PNGWRITER_HPP_INCLUDED
+#define PNGWRITER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+// Replace specified bytes with a PNG image of specified size from specified
+// 8-bit RGB pixels, top row first. The pixels are compressed without any
+// library, every row is filtered and deflated with fixed Huffman codes.
+void encode_png(
+    unsigned int width,
+    unsigned int height,
+    std::vector<unsigned char> const & rgb,
+    std::vector<unsigned char> & png);
+// Write PNG image of specified size from specified 8-bit RGB pixels to the
+// file at specified path, see encode_png. Return false if the file could not
+// be written.
+bool write_png(
+    std::string const & path,
+    unsigned int width,
+    unsigned int height,
+    std::vector<unsigned char> const & rgb);
+
+#endif
@@ -0,0 +1,130 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+namespace {
+
+const std::uint64_t mask = profile_capacity - 1;
+
+// return small number of the calling thread, given out in order of the first
+// event of each thread
+unsigned int thread_number()
+{
+    static std::atomic<unsigned int> threads(0);
+    static thread_local unsigned int number = threads.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+}
+
+Profiler & Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+std::uint64_t Profiler::now()
+{
+    typedef std::chrono::steady_clock clock;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+}
+
+Profiler::Profiler()
+    : slots(new Slot[profile_capacity]),
+      head(0)
+{
+    for (unsigned int i = 0; i < profile_capacity; i++) {
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+// every writer claims its own event number so writers never wait on each
+// other, the slot is written as a seqlock so a reader can tell a torn event
+void Profiler::record(char const * name, std::uint64_t start, std::uint64_t end)
+{
+    const std::uint64_t number = head.fetch_add(1, std::memory_order_relaxed);
+    Slot & slot = slots[number & mask];
+
+    slot.sequence.store(2 * number + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.thread.store(thread_number(), std::memory_order_relaxed);
+    slot.sequence.store(2 * number + 2, std::memory_order_release);
+}
+
+void Profiler::collect(std::vector<ProfileEvent> & events) const
+{
+    events.clear();
+
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    const std::uint64_t begin = end > profile_capacity ? end - profile_capacity : 0;
+
+    for (std::uint64_t number = begin; number < end; number++) {
+        Slot const & slot = slots[number & mask];
+
+        const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        ProfileEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start = slot.start.load(std::memory_order_relaxed);
+        event.duration = slot.duration.load(std::memory_order_relaxed);
+        event.thread = slot.thread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+        if (before == 2 * number + 2 && after == before) {
+            events.push_back(event);
+        }
+    }
+}
+
+// every scope is a complete event, times are in microseconds relative to the
+// first event
+void Profiler::write_trace(std::ostream & out) const
+{
+    std::vector<ProfileEvent> events;
+    collect(events);
+
+    std::uint64_t origin = events.empty() ? 0 : events.front().start;
+    for (auto const & event : events) {
+        origin = std::min(origin, event.start);
+    }
+
+    out << "{\"traceEvents\": [";
+    for (unsigned int i = 0; i < events.size(); i++) {
+        auto const & event = events[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "  {\"name\": \"" << event.name << "\""
+            << ", \"ph\": \"X\""
+            << ", \"pid\": 1"
+            << ", \"tid\": " << event.thread
+            << std::fixed << std::setprecision(3)
+            << ", \"ts\": " << (event.start - origin) / 1000.0
+            << ", \"dur\": " << event.duration / 1000.0
+            << "}";
+    }
+    out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+ProfileScope::ProfileScope(char const * name)
+    : name(name),
+      start(Profiler::now())
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+    Profiler::instance().record(name, start, Profiler::now());
+}
+
+bool profiling_enabled()
+{
+#if defined(ARCBALL_PROFILE)
+    return true;
+#else
+    return false;
+#endif
+}
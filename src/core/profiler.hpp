@@ -0,0 +1,91 @@
+#ifndef PROFILER_HPP_INCLUDED
+#define PROFILER_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Timed scope of a single frame stage, times are in nanoseconds on a steady
+// clock and the thread is a small number given to each thread on its first
+// event.
+struct ProfileEvent {
+    char const * name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    unsigned int thread;
+};
+
+// Number of events a profiler holds, older events are overwritten.
+const unsigned int profile_capacity = 1 << 16;
+
+// The responsibility of this class is to collect timed scopes from any
+// thread into a lock-free ring buffer and to write them as Chrome trace
+// events. Recording an event never blocks or allocates.
+class Profiler {
+public:
+    // Return the profiler shared by every thread.
+    static Profiler & instance();
+    // Return current time in nanoseconds.
+    static std::uint64_t now();
+    // Construct empty profiler.
+    Profiler();
+    Profiler(Profiler const &) = delete;
+    Profiler & operator=(Profiler const &) = delete;
+    // Record scope with specified name, which must be a string literal, from
+    // specified start to end time.
+    void record(char const * name, std::uint64_t start, std::uint64_t end);
+    // Replace specified events with the events currently held, oldest first.
+    // Events that are being overwritten while collected are left out.
+    void collect(std::vector<ProfileEvent> & events) const;
+    // Write the events currently held as Chrome trace event JSON, which can
+    // be loaded in chrome://tracing or Perfetto.
+    void write_trace(std::ostream & out) const;
+private:
+    // the sequence is odd while the slot is written and 2 * (n + 1) once it
+    // holds event number n
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        std::atomic<char const *> name;
+        std::atomic<std::uint64_t> start;
+        std::atomic<std::uint64_t> duration;
+        std::atomic<unsigned int> thread;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<std::uint64_t> head;
+};
+
+// The responsibility of this class is to record the time from its
+// construction to its destruction to the shared profiler.
+class ProfileScope {
+public:
+    // Start timing scope with specified name, which must be a string
+    // literal.
+    explicit ProfileScope(char const * name);
+    // Stop timing and record scope.
+    ~ProfileScope();
+    ProfileScope(ProfileScope const &) = delete;
+    ProfileScope & operator=(ProfileScope const &) = delete;
+private:
+    char const * name;
+    std::uint64_t start;
+};
+
+// Return true if the profile scopes are compiled in.
+bool profiling_enabled();
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Time the rest of the enclosing scope under specified name. Scopes are
+// only compiled in when ARCBALL_PROFILE is defined, otherwise they are
+// nothing at all.
+#if defined(ARCBALL_PROFILE)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) do {} while (false)
+#endif
+
+#endif
@@ -0,0 +1,470 @@
+#include "softrasterizer.hpp"
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// number of vertices a worker transforms at a time
+const unsigned int vertex_chunk = 1024;
+
+const unsigned int none = std::numeric_limits<unsigned int>::max();
+
+// return color of a surface point in view space with specified normal, the
+// same as the Blinn-Phong fragment shader returns it except for specular
+// highlights below specified cutoff
+glm::vec3 blinn_phong(
+    glm::vec3 position,
+    glm::vec3 normal,
+    RasterMaterial const & material,
+    std::vector<RasterLight> const & lights,
+    float highlight_cutoff)
+{
+    const glm::vec3 n = glm::normalize(normal);
+    const glm::vec3 v = glm::normalize(-position);
+
+    glm::vec3 color(0.0f);
+    for (auto const & light : lights) {
+        const glm::vec3 to_light = light.position - position;
+        const float light_distance = glm::length(to_light);
+        const glm::vec3 s = to_light / light_distance;
+        const glm::vec3 h = glm::normalize(v + s);
+
+        const glm::vec3 ambient = light.ambient * material.ambient;
+        const glm::vec3 diffuse = light.diffuse * material.diffuse * std::max(glm::dot(s, n), 0.0f);
+        // highlights too faint to change an 8-bit color are not computed
+        const float cos_h = glm::dot(n, h);
+        const float highlight = cos_h > highlight_cutoff ? std::pow(cos_h, 4.0f * material.shininess) : 0.0f;
+        const glm::vec3 specular = glm::max(light.specular * material.specular * highlight, glm::vec3(0.0f));
+
+        const float attenuation = 1.0f / (light.constant + light.linear * light_distance + light.quadratic * light_distance * light_distance);
+
+        color += (ambient + diffuse + specular) * attenuation;
+        color += material.emission;
+    }
+
+    return color;
+}
+
+}
+
+SoftRasterizer::SoftRasterizer(unsigned int width, unsigned int height, unsigned int threads)
+    : width(width),
+      height(height),
+      tiles_x((width + raster_tile_size - 1) / raster_tile_size),
+      tiles_y((height + raster_tile_size - 1) / raster_tile_size),
+      stride(tiles_x * raster_tile_size),
+      color(stride * tiles_y * raster_tile_size),
+      depth(stride * tiles_y * raster_tile_size, 1.0f),
+      visible(stride * tiles_y * raster_tile_size, none),
+      visible_u(stride * tiles_y * raster_tile_size),
+      visible_v(stride * tiles_y * raster_tile_size),
+      mesh(nullptr),
+      pool(threads),
+      next_item(0)
+{
+    bins.resize(pool.size(), std::vector<std::vector<unsigned int>>(tiles_x * tiles_y));
+}
+
+void SoftRasterizer::clear(glm::vec3 color)
+{
+    std::fill(this->color.begin(), this->color.end(), color);
+    std::fill(depth.begin(), depth.end(), 1.0f);
+}
+
+// the mesh is drawn in three passes over all workers, the vertices are
+// transformed, the triangles are set up and binned into the tiles they
+// overlap and finally every tile is rasterized and shaded by a single worker
+void SoftRasterizer::draw_mesh(
+    MeshData const & mesh,
+    glm::mat4 const & model_view,
+    glm::mat4 const & projection,
+    RasterMaterial const & material,
+    std::vector<RasterLight> const & lights)
+{
+    PROFILE_SCOPE("SoftRasterizer::draw_mesh");
+
+    this->mesh = &mesh;
+    this->model_view = model_view;
+    this->projection = projection;
+    this->normal_matrix = glm::transpose(glm::inverse(glm::mat3(model_view)));
+    this->material = material;
+    this->lights = lights;
+    // below this cosine the highlight is less than 1/1024
+    highlight_cutoff = std::exp2(-10.0f / (4.0f * material.shininess));
+
+    vertices.resize(mesh.positions.size());
+    triangles.resize(mesh.indices.size() / 3);
+
+    next_item = 0;
+    pool.run([this](unsigned int) { transform_vertices(); });
+    pool.run([this](unsigned int worker) { bin_triangles(worker); });
+    next_item = 0;
+    pool.run([this](unsigned int) { raster_tiles(); });
+
+    this->mesh = nullptr;
+}
+
+// every line is stepped one pixel at a time along its longer axis, the last
+// pixel is left for the next line of the strip so no pixel is blended twice
+void SoftRasterizer::draw_lines(
+    std::vector<glm::vec3> const & positions,
+    glm::mat4 const & transform,
+    bool loop,
+    glm::vec3 color,
+    float opacity)
+{
+    PROFILE_SCOPE("SoftRasterizer::draw_lines");
+
+    if (positions.size() < 2) {
+        return;
+    }
+
+    const unsigned int count = loop ? positions.size() : positions.size() - 1;
+    for (unsigned int i = 0; i < count; i++) {
+        const glm::vec4 a = transform * glm::vec4(positions[i], 1.0f);
+        const glm::vec4 b = transform * glm::vec4(positions[(i + 1) % positions.size()], 1.0f);
+        if (a.w <= 0.0f || b.w <= 0.0f) {
+            continue;
+        }
+
+        const float x0 = (0.5f + 0.5f * a.x / a.w) * width;
+        const float y0 = (0.5f - 0.5f * a.y / a.w) * height;
+        const float x1 = (0.5f + 0.5f * b.x / b.w) * width;
+        const float y1 = (0.5f - 0.5f * b.y / b.w) * height;
+
+        // lines far outside the frame are left out rather than stepped
+        const float reach = 2.0f * (width + height);
+        const float steps = std::ceil(std::max(std::abs(x1 - x0), std::abs(y1 - y0)));
+        if (steps > reach) {
+            continue;
+        }
+
+        for (float step = 0.0f; step < steps; step++) {
+            const float t = step / steps;
+            blend(
+                static_cast<int>(std::floor(x0 + (x1 - x0) * t)),
+                static_cast<int>(std::floor(y0 + (y1 - y0) * t)),
+                color,
+                opacity);
+        }
+    }
+}
+
+void SoftRasterizer::read_pixels(std::vector<unsigned char> & rgb) const
+{
+    rgb.resize(width * height * 3);
+
+    auto to_byte = [](float value)
+    {
+        return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    };
+
+    for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+            const glm::vec3 pixel = color[y * stride + x];
+            unsigned char * out = &rgb[(y * width + x) * 3];
+            out[0] = to_byte(pixel.x);
+            out[1] = to_byte(pixel.y);
+            out[2] = to_byte(pixel.z);
+        }
+    }
+}
+
+unsigned int SoftRasterizer::get_width() const
+{
+    return width;
+}
+
+unsigned int SoftRasterizer::get_height() const
+{
+    return height;
+}
+
+unsigned int SoftRasterizer::get_threads() const
+{
+    return pool.size();
+}
+
+void SoftRasterizer::transform_vertices()
+{
+    const unsigned int count = vertices.size();
+
+    while (true) {
+        const unsigned int begin = next_item.fetch_add(vertex_chunk);
+        if (begin >= count) {
+            break;
+        }
+        const unsigned int end = std::min(begin + vertex_chunk, count);
+
+        for (unsigned int i = begin; i < end; i++) {
+            const glm::vec4 view = model_view * glm::vec4(mesh->positions[i], 1.0f);
+            const glm::vec4 clip = projection * view;
+
+            Vertex & vertex = vertices[i];
+            vertex.position = glm::vec3(view);
+            vertex.normal = normal_matrix * mesh->normals[i];
+
+            // a zero reciprocal marks a vertex in front of the near plane or
+            // behind the eye
+            if (clip.w <= 0.0f || clip.z < -clip.w) {
+                vertex.inverse_w = 0.0f;
+                continue;
+            }
+            vertex.inverse_w = 1.0f / clip.w;
+            vertex.x = (0.5f + 0.5f * clip.x * vertex.inverse_w) * width;
+            vertex.y = (0.5f - 0.5f * clip.y * vertex.inverse_w) * height;
+            vertex.z = clip.z * vertex.inverse_w;
+        }
+    }
+}
+
+// every worker sets up an equal share of the triangles in mesh order and bins
+// them into its own lists, so the tiles see the triangles in mesh order
+// without any locking
+void SoftRasterizer::bin_triangles(unsigned int worker)
+{
+    auto & worker_bins = bins[worker];
+    for (auto & bin : worker_bins) {
+        bin.clear();
+    }
+
+    const unsigned long count = triangles.size();
+    const unsigned int begin = count * worker / bins.size();
+    const unsigned int end = count * (worker + 1) / bins.size();
+
+    for (unsigned int i = begin; i < end; i++) {
+        Vertex const & v0 = vertices[mesh->indices[3 * i]];
+        Vertex const & v1 = vertices[mesh->indices[3 * i + 1]];
+        Vertex const & v2 = vertices[mesh->indices[3 * i + 2]];
+        if (v0.inverse_w == 0.0f || v1.inverse_w == 0.0f || v2.inverse_w == 0.0f) {
+            continue;
+        }
+
+        // the window y axis points down, so counter-clockwise front faces
+        // have a negative area
+        const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (!(area < 0.0f)) {
+            continue;
+        }
+
+        const float min_x = std::min(std::min(v0.x, v1.x), v2.x);
+        const float min_y = std::min(std::min(v0.y, v1.y), v2.y);
+        const float max_x = std::max(std::max(v0.x, v1.x), v2.x);
+        const float max_y = std::max(std::max(v0.y, v1.y), v2.y);
+        if (max_x < 0.0f || max_y < 0.0f || min_x >= width || min_y >= height) {
+            continue;
+        }
+
+        Triangle & triangle = triangles[i];
+        triangle.min_x = static_cast<unsigned int>(std::max(min_x, 0.0f));
+        triangle.min_y = static_cast<unsigned int>(std::max(min_y, 0.0f));
+        triangle.max_x = std::min(static_cast<unsigned int>(max_x), width - 1);
+        triangle.max_y = std::min(static_cast<unsigned int>(max_y), height - 1);
+
+        // the barycentric coordinate of a corner is the signed area of the
+        // triangle from the point to the opposite edge over the whole area
+        const float inverse_area = 1.0f / area;
+        const float ux = v0.x - v2.x;
+        const float uy = v0.y - v2.y;
+        triangle.a[0] = -uy * inverse_area;
+        triangle.b[0] = ux * inverse_area;
+        triangle.c[0] = (uy * v2.x - ux * v2.y) * inverse_area;
+        const float vx = v1.x - v0.x;
+        const float vy = v1.y - v0.y;
+        triangle.a[1] = -vy * inverse_area;
+        triangle.b[1] = vx * inverse_area;
+        triangle.c[1] = (vy * v0.x - vx * v0.y) * inverse_area;
+
+        // depth is affine in window space
+        const float dz1 = v1.z - v0.z;
+        const float dz2 = v2.z - v0.z;
+        triangle.a[2] = triangle.a[0] * dz1 + triangle.a[1] * dz2;
+        triangle.b[2] = triangle.b[0] * dz1 + triangle.b[1] * dz2;
+        triangle.c[2] = v0.z + triangle.c[0] * dz1 + triangle.c[1] * dz2;
+
+        for (unsigned int ty = triangle.min_y / raster_tile_size; ty <= triangle.max_y / raster_tile_size; ty++) {
+            for (unsigned int tx = triangle.min_x / raster_tile_size; tx <= triangle.max_x / raster_tile_size; tx++) {
+                worker_bins[ty * tiles_x + tx].push_back(i);
+            }
+        }
+    }
+}
+
+void SoftRasterizer::raster_tiles()
+{
+    const unsigned int count = tiles_x * tiles_y;
+
+    while (true) {
+        const unsigned int tile = next_item.fetch_add(1);
+        if (tile >= count) {
+            break;
+        }
+
+        clear_tile(tile);
+        bool covered = false;
+        for (auto const & worker_bins : bins) {
+            for (auto index : worker_bins[tile]) {
+                raster_triangle(tile, index);
+                covered = true;
+            }
+        }
+        if (covered) {
+            shade_tile(tile);
+        }
+    }
+}
+
+void SoftRasterizer::clear_tile(unsigned int tile)
+{
+    const unsigned int x0 = (tile % tiles_x) * raster_tile_size;
+    const unsigned int y0 = (tile / tiles_x) * raster_tile_size;
+
+    for (unsigned int y = y0; y < y0 + raster_tile_size; y++) {
+        std::fill_n(&visible[y * stride + x0], raster_tile_size, none);
+    }
+}
+
+// the part of the bounds of specified triangle within specified tile is
+// walked row by row, four pixels at a time from a multiple of four, every
+// covered pixel nearer than the nearest so far keeps the triangle and its
+// barycentric coordinates
+void SoftRasterizer::raster_triangle(unsigned int tile, unsigned int index)
+{
+    Triangle const & triangle = triangles[index];
+
+    const unsigned int tile_x = (tile % tiles_x) * raster_tile_size;
+    const unsigned int tile_y = (tile / tiles_x) * raster_tile_size;
+    const unsigned int x0 = std::max(triangle.min_x, tile_x) & ~3u;
+    const unsigned int y0 = std::max(triangle.min_y, tile_y);
+    const unsigned int x1 = std::min(triangle.max_x, tile_x + raster_tile_size - 1);
+    const unsigned int y1 = std::min(triangle.max_y, tile_y + raster_tile_size - 1);
+
+#if defined(__SSE2__)
+    const __m128 a_u = _mm_set1_ps(triangle.a[0]);
+    const __m128 a_v = _mm_set1_ps(triangle.a[1]);
+    const __m128 a_z = _mm_set1_ps(triangle.a[2]);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i triangle_index = _mm_set1_epi32(static_cast<int>(index));
+    const __m128 lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+    for (unsigned int y = y0; y <= y1; y++) {
+        const float py = y + 0.5f;
+        const __m128 row_u = _mm_set1_ps(triangle.b[0] * py + triangle.c[0]);
+        const __m128 row_v = _mm_set1_ps(triangle.b[1] * py + triangle.c[1]);
+        const __m128 row_z = _mm_set1_ps(triangle.b[2] * py + triangle.c[2]);
+
+        for (unsigned int x = x0; x <= x1; x += 4) {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+            const __m128 u = _mm_add_ps(_mm_mul_ps(a_u, px), row_u);
+            const __m128 v = _mm_add_ps(_mm_mul_ps(a_v, px), row_v);
+            const __m128 z = _mm_add_ps(_mm_mul_ps(a_z, px), row_z);
+            const __m128 w = _mm_sub_ps(_mm_sub_ps(one, u), v);
+
+            const unsigned int offset = y * stride + x;
+            const __m128 nearest = _mm_loadu_ps(&depth[offset]);
+            const __m128 inside = _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero)),
+                _mm_cmpge_ps(w, zero));
+            const __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, nearest));
+            if (_mm_movemask_ps(pass) == 0) {
+                continue;
+            }
+
+            auto select = [pass](__m128 a, __m128 b)
+            {
+                return _mm_or_ps(_mm_and_ps(pass, a), _mm_andnot_ps(pass, b));
+            };
+
+            _mm_storeu_ps(&depth[offset], select(z, nearest));
+            _mm_storeu_ps(&visible_u[offset], select(u, _mm_loadu_ps(&visible_u[offset])));
+            _mm_storeu_ps(&visible_v[offset], select(v, _mm_loadu_ps(&visible_v[offset])));
+
+            __m128i * ids = reinterpret_cast<__m128i *>(&visible[offset]);
+            const __m128 old_ids = _mm_castsi128_ps(_mm_loadu_si128(ids));
+            _mm_storeu_si128(ids, _mm_castps_si128(select(_mm_castsi128_ps(triangle_index), old_ids)));
+        }
+    }
+#else
+    for (unsigned int y = y0; y <= y1; y++) {
+        const float py = y + 0.5f;
+        const float row_u = triangle.b[0] * py + triangle.c[0];
+        const float row_v = triangle.b[1] * py + triangle.c[1];
+        const float row_z = triangle.b[2] * py + triangle.c[2];
+
+        for (unsigned int x = x0; x <= x1; x++) {
+            const float px = x + 0.5f;
+            const float u = triangle.a[0] * px + row_u;
+            const float v = triangle.a[1] * px + row_v;
+            const float z = triangle.a[2] * px + row_z;
+            const float w = 1.0f - u - v;
+
+            const unsigned int offset = y * stride + x;
+            if (u >= 0.0f && v >= 0.0f && w >= 0.0f && z < depth[offset]) {
+                depth[offset] = z;
+                visible_u[offset] = u;
+                visible_v[offset] = v;
+                visible[offset] = index;
+            }
+        }
+    }
+#endif
+}
+
+// the barycentric coordinates found in window space are corrected for
+// perspective before the view space position and normal are interpolated
+void SoftRasterizer::shade_tile(unsigned int tile)
+{
+    const unsigned int x0 = (tile % tiles_x) * raster_tile_size;
+    const unsigned int y0 = (tile / tiles_x) * raster_tile_size;
+    const unsigned int x1 = std::min(x0 + raster_tile_size, width);
+    const unsigned int y1 = std::min(y0 + raster_tile_size, height);
+
+    for (unsigned int y = y0; y < y1; y++) {
+        for (unsigned int x = x0; x < x1; x++) {
+            const unsigned int offset = y * stride + x;
+            const unsigned int index = visible[offset];
+            if (index == none) {
+                continue;
+            }
+
+            Vertex const & v0 = vertices[mesh->indices[3 * index]];
+            Vertex const & v1 = vertices[mesh->indices[3 * index + 1]];
+            Vertex const & v2 = vertices[mesh->indices[3 * index + 2]];
+
+            const float u = visible_u[offset];
+            const float v = visible_v[offset];
+            float w0 = (1.0f - u - v) * v0.inverse_w;
+            float w1 = u * v1.inverse_w;
+            float w2 = v * v2.inverse_w;
+            const float inverse_sum = 1.0f / (w0 + w1 + w2);
+            w0 *= inverse_sum;
+            w1 *= inverse_sum;
+            w2 *= inverse_sum;
+
+            const glm::vec3 position = v0.position * w0 + v1.position * w1 + v2.position * w2;
+            const glm::vec3 normal = v0.normal * w0 + v1.normal * w1 + v2.normal * w2;
+            color[offset] = blinn_phong(position, normal, material, lights, highlight_cutoff);
+        }
+    }
+}
+
+// blend specified color over the pixel at specified position, if it is
+// within the frame
+void SoftRasterizer::blend(int x, int y, glm::vec3 color, float opacity)
+{
+    if (x < 0 || y < 0 || x >= static_cast<int>(width) || y >= static_cast<int>(height)) {
+        return;
+    }
+
+    glm::vec3 & pixel = this->color[y * stride + x];
+    pixel = color * opacity + pixel * (1.0f - opacity);
+}
@@ -0,0 +1,140 @@
+#ifndef SOFTRASTERIZER_HPP_INCLUDED
+#define SOFTRASTERIZER_HPP_INCLUDED
+
+#include "meshdata.hpp"
+#include "workerpool.hpp"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+// Width and height of a screen tile in pixels.
+const unsigned int raster_tile_size = 64;
+
+// Surface of a mesh, the same as the material of the Blinn-Phong shader.
+struct RasterMaterial {
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    glm::vec3 emission;
+    float shininess;
+};
+
+// Point light of the Blinn-Phong shader, the position is in view space.
+struct RasterLight {
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// The responsibility of this class is to render lit meshes and helper lines
+// on the CPU, for machines without a GPU. Triangles are binned into screen
+// tiles which are rasterized by a pool of worker threads, with the edge
+// functions evaluated for four pixels at a time. Every pixel is shaded once
+// after all triangles of a tile are rasterized, the same way as the
+// Blinn-Phong shader shades it.
+class SoftRasterizer {
+public:
+    // Construct rasterizer with a black frame of specified size in pixels,
+    // rendering with specified number of threads or one per hardware thread
+    // if zero.
+    SoftRasterizer(unsigned int width, unsigned int height, unsigned int threads = 0);
+    SoftRasterizer(SoftRasterizer const &) = delete;
+    SoftRasterizer & operator=(SoftRasterizer const &) = delete;
+    // Fill frame with specified color and reset depth.
+    void clear(glm::vec3 color);
+    // Draw specified mesh with specified model view and projection matrix,
+    // lit by specified lights. Back faces and triangles crossing the near
+    // plane are not drawn.
+    void draw_mesh(
+        MeshData const & mesh,
+        glm::mat4 const & model_view,
+        glm::mat4 const & projection,
+        RasterMaterial const & material,
+        std::vector<RasterLight> const & lights);
+    // Draw line strip through specified positions transformed to clip space
+    // by specified matrix, closed into a loop if specified. The lines are
+    // blended over the frame with specified opacity and ignore depth.
+    void draw_lines(
+        std::vector<glm::vec3> const & positions,
+        glm::mat4 const & transform,
+        bool loop,
+        glm::vec3 color,
+        float opacity);
+    // Replace specified pixels with the frame as 8-bit RGB, top row first.
+    void read_pixels(std::vector<unsigned char> & rgb) const;
+    // Return width of the frame in pixels.
+    unsigned int get_width() const;
+    // Return height of the frame in pixels.
+    unsigned int get_height() const;
+    // Return number of threads rendering, including the calling thread.
+    unsigned int get_threads() const;
+private:
+    // vertex transformed by the vertex shader and the viewport
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec3 normal;
+        // window position in pixels, depth in [-1, 1] and reciprocal of w
+        float x;
+        float y;
+        float z;
+        float inverse_w;
+    };
+
+    // plane equations over the window of the barycentric coordinates of the
+    // second and third corner and of the depth, a * x + b * y + c
+    struct Triangle {
+        float a[3];
+        float b[3];
+        float c[3];
+        unsigned int min_x;
+        unsigned int min_y;
+        unsigned int max_x;
+        unsigned int max_y;
+    };
+
+    void transform_vertices();
+    void bin_triangles(unsigned int worker);
+    void raster_tiles();
+    void clear_tile(unsigned int tile);
+    void raster_triangle(unsigned int tile, unsigned int index);
+    void shade_tile(unsigned int tile);
+    void blend(int x, int y, glm::vec3 color, float opacity);
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int tiles_x;
+    unsigned int tiles_y;
+    // padded to whole tiles so four pixels can always be read and written
+    unsigned int stride;
+
+    std::vector<glm::vec3> color;
+    std::vector<float> depth;
+    // triangle and barycentric coordinates nearest the eye in every pixel
+    std::vector<unsigned int> visible;
+    std::vector<float> visible_u;
+    std::vector<float> visible_v;
+
+    // state of the mesh being drawn, shared with the workers
+    MeshData const * mesh;
+    glm::mat4 model_view;
+    glm::mat4 projection;
+    glm::mat3 normal_matrix;
+    RasterMaterial material;
+    float highlight_cutoff;
+    std::vector<RasterLight> lights;
+    std::vector<Vertex> vertices;
+    std::vector<Triangle> triangles;
+    // triangles overlapping each tile per worker, in mesh order
+    std::vector<std::vector<std::vector<unsigned int>>> bins;
+
+    WorkerPool pool;
+    std::atomic<unsigned int> next_item;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SPSCQUEUE_HPP_INCLUDED
+#define SPSCQUEUE_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+
+// The responsibility of this class is to pass values in order from one
+// producer thread to one consumer thread without locking. The capacity must
+// be a power of two.
+template <typename T, unsigned int Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+public:
+    // Construct empty queue.
+    SpscQueue();
+    // Append specified value. Return false if the queue is full.
+    bool push(T const & value);
+    // Remove oldest value into specified value. Return false if the queue is
+    // empty.
+    bool pop(T & value);
+private:
+    std::array<T, Capacity> values;
+    // positions only ever increase, the index is the position modulo the
+    // capacity
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
+};
+
+template <typename T, unsigned int Capacity>
+SpscQueue<T, Capacity>::SpscQueue()
+    : head(0),
+      tail(0)
+{
+}
+
+template <typename T, unsigned int Capacity>
+bool SpscQueue<T, Capacity>::push(T const & value)
+{
+    const unsigned int position = tail.load(std::memory_order_relaxed);
+    if (position - head.load(std::memory_order_acquire) == Capacity) {
+        return false;
+    }
+    values[position & (Capacity - 1)] = value;
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, unsigned int Capacity>
+bool SpscQueue<T, Capacity>::pop(T & value)
+{
+    const unsigned int position = head.load(std::memory_order_relaxed);
+    if (position == tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    value = values[position & (Capacity - 1)];
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "textparse.hpp"
+
+#include <climits>
+#include <cstdint>
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+void skip_space(char const * & p, char const * end)
+{
+    while (p < end && is_space(*p)) {
+        p++;
+    }
+}
+
+bool parse_int(char const * & p, char const * end, int & value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+    // the magnitude of a negative value may be one more than of a positive
+    const long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+    long long result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        if (result > limit) {
+            return false;
+        }
+        p++;
+    }
+    value = static_cast<int>(negative ? -result : result);
+    return true;
+}
+
+// the mantissa is accumulated as an integer and scaled once, which is exact
+// for the handful of decimals found in OBJ files
+bool parse_float(char const * & p, char const * end, float & value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    std::uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (mantissa < 100000000000000000ull) {
+            mantissa = mantissa * 10 + (*p - '0');
+        } else {
+            exponent++;
+        }
+        digits++;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (mantissa < 100000000000000000ull) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+            digits++;
+            p++;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        int power;
+        if (!parse_int(p, end, power)) {
+            return false;
+        }
+        // any larger power is zero or infinity as a float, but would take
+        // long to scale by
+        exponent += power < -400 ? -400 : (power > 400 ? 400 : power);
+    }
+
+    double result = static_cast<double>(mantissa);
+    double scale = 1.0;
+    for (int i = 0; i < (exponent < 0 ? -exponent : exponent); i++) {
+        scale *= 10.0;
+    }
+    result = exponent < 0 ? result / scale : result * scale;
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef TEXTPARSE_HPP_INCLUDED
+#define TEXTPARSE_HPP_INCLUDED
+
+// Parsers of text between a pointer and an end pointer, for content that is
+// not null terminated such as mapped files. Every parser advances the
+// pointer past what it has read.
+
+// Return true if specified character is a space within a line.
+bool is_space(char c);
+// Skip spaces within the line.
+void skip_space(char const * & p, char const * end);
+// Parse decimal integer with an optional sign. Return false if there is no
+// digit or the integer is out of the range of int.
+bool parse_int(char const * & p, char const * end, int & value);
+// Parse decimal number with an optional sign, fraction and exponent. Return
+// false if there is no digit.
+bool parse_float(char const * & p, char const * end, float & value);
+
+#endif
@@ -0,0 +1,588 @@
+#include "trajectorycodec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// A trajectory starts with a header:
+//
+//     magic      8 bytes  "ARCTRAJ" followed by the format version
+//     bits       1 byte   bits per component
+//     interval            uint32 orientations from one keyframe to the next
+//
+// followed by the orientations, and ends with the keyframe index:
+//
+//     keyframes           uint64 offset of every keyframe
+//     frames              uint64 number of orientations
+//     count               uint32 number of keyframes
+//     magic      4 bytes  "TIDX"
+//
+// An orientation is quantized to the largest of its components w, x, y, z,
+// made positive, and the other three scaled to integers. A keyframe is
+//
+//     largest    1 byte   0 w, 1 x, 2 y, 3 z
+//     values              3 varint zigzag
+//
+// and any other orientation the difference of the values to a prediction
+//
+//     code       1 byte   0 to 124 the three differences, each from -2 to 2,
+//                         as digits of a base 5 number offset by 2,
+//                         125 if the differences follow in 2 bytes,
+//                         126 if the differences follow as varints,
+//                         127 if largest and the values follow
+//     largest    1 byte   (optional)
+//     values              2 bytes, the three differences from -16 to 15
+//                         offset by 16 in 5 bits each, or 3 varint zigzag
+//                         (optional)
+//
+// the prediction continues the values linearly from the two orientations
+// before, or is the values before after a keyframe or change of the largest
+// component, so an
+// orientation turning at a steady rate takes a single byte. Varints are
+// little endian groups of 7 bits with the high bit set on all but the last,
+// every other value is little endian.
+
+namespace {
+
+const char magic[7] = { 'A', 'R', 'C', 'T', 'R', 'A', 'J' };
+const std::uint8_t version = 1;
+const unsigned int header_size = sizeof(magic) + 1 + 1 + 4;
+
+const char index_magic[4] = { 'T', 'I', 'D', 'X' };
+const unsigned int trailer_size = 8 + 4 + sizeof(index_magic);
+
+// the three smallest components of a unit quaternion are within this
+const float sqrt_half = 0.70710678f;
+
+// the components kept for each dropped component
+const unsigned int kept_components[4][3] = {
+    { 1, 2, 3 },
+    { 0, 2, 3 },
+    { 0, 1, 3 },
+    { 0, 1, 2 }
+};
+
+// codes of an orientation which is not a keyframe, below are differences
+// small enough to take a byte
+const unsigned int packed_codes = 125;
+const unsigned char SHORT_DIFFERENCES_FOLLOW = 125;
+const unsigned char DIFFERENCES_FOLLOW = 126;
+const unsigned char VALUES_FOLLOW = 127;
+
+// the trajectory writer writes when this many bytes are buffered
+const std::size_t flush_size = 1 << 16;
+
+std::uint32_t zigzag(std::int32_t value)
+{
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(-(value < 0));
+}
+
+std::int32_t unzigzag(std::uint32_t value)
+{
+    return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+}
+
+void write_varint(std::vector<char> & content, std::uint32_t value)
+{
+    while (value >= 0x80) {
+        content.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    content.push_back(static_cast<char>(value));
+}
+
+bool read_varint(char const * & p, char const * end, std::uint32_t & value)
+{
+    value = 0;
+    for (unsigned int shift = 0; shift < 32 && p < end; shift += 7) {
+        const std::uint32_t byte = static_cast<unsigned char>(*p++);
+        value |= (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void write_le(std::vector<char> & content, std::uint64_t value, unsigned int size)
+{
+    for (unsigned int i = 0; i < size; i++) {
+        content.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+std::uint64_t read_le(char const * p, unsigned int size)
+{
+    std::uint64_t value = 0;
+    for (unsigned int i = 0; i < size; i++) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+unsigned int clamp_bits(unsigned int bits)
+{
+    return std::min(std::max(bits, 8u), 24u);
+}
+
+std::int32_t component_limit(unsigned int bits)
+{
+    return (1 << (bits - 1)) - 1;
+}
+
+}
+
+// The three components are rounded by at most half a step h each, and the
+// largest component, at least one half, is off by at most 3h from the
+// others. The quaternions are then at most sqrt(12)h apart, and the rotation
+// angle is twice that. A little is added for the float arithmetic. This
+// holds while h is small, which is why at least 8 bits are used.
+float trajectory_error_bound(unsigned int bits)
+{
+    const float step = sqrt_half / component_limit(clamp_bits(bits));
+    return 2.0f * std::sqrt(12.0f) * 0.5f * step * 1.01f + 1e-6f;
+}
+
+TrajectoryEncoder::TrajectoryEncoder(unsigned int bits, unsigned int keyframe_interval)
+    : bits(clamp_bits(bits)),
+      keyframe_interval(std::max(keyframe_interval, 1u)),
+      limit(component_limit(this->bits)),
+      scale(limit / sqrt_half),
+      offset(0),
+      frames(0),
+      next_keyframe(0),
+      previous(),
+      velocity()
+{
+}
+
+void TrajectoryEncoder::begin(std::vector<char> & content)
+{
+    const std::size_t size = content.size();
+    content.insert(content.end(), magic, magic + sizeof(magic));
+    content.push_back(static_cast<char>(version));
+    content.push_back(static_cast<char>(bits));
+    write_le(content, keyframe_interval, 4);
+
+    offset = content.size() - size;
+    keyframes.clear();
+    frames = 0;
+    next_keyframe = 0;
+}
+
+void TrajectoryEncoder::append(glm::quat orientation, std::vector<char> & content)
+{
+    const std::size_t size = content.size();
+    const Quantized current = quantize(orientation);
+
+    if (frames == next_keyframe) {
+        keyframes.push_back(offset);
+        next_keyframe += keyframe_interval;
+        content.push_back(static_cast<char>(current.largest));
+        for (int i = 0; i < 3; i++) {
+            write_varint(content, zigzag(current.values[i]));
+        }
+        std::fill(velocity, velocity + 3, 0);
+    } else if (current.largest != previous.largest) {
+        content.push_back(static_cast<char>(VALUES_FOLLOW));
+        content.push_back(static_cast<char>(current.largest));
+        for (int i = 0; i < 3; i++) {
+            write_varint(content, zigzag(current.values[i]));
+        }
+        std::fill(velocity, velocity + 3, 0);
+    } else {
+        // written out for each component like the decoder
+        std::int32_t differences[3];
+        differences[0] = current.values[0] - previous.values[0] - velocity[0];
+        differences[1] = current.values[1] - previous.values[1] - velocity[1];
+        differences[2] = current.values[2] - previous.values[2] - velocity[2];
+        velocity[0] += differences[0];
+        velocity[1] += differences[1];
+        velocity[2] += differences[2];
+
+        const std::int32_t low = std::min(std::min(differences[0], differences[1]), differences[2]);
+        const std::int32_t high = std::max(std::max(differences[0], differences[1]), differences[2]);
+        const bool small = low >= -2 && high <= 2;
+        const bool short_differences = low >= -16 && high <= 15;
+        if (small) {
+            content.push_back(static_cast<char>((differences[0] + 2) * 25 + (differences[1] + 2) * 5 + differences[2] + 2));
+        } else if (short_differences) {
+            const unsigned int bits = (differences[0] + 16) | (differences[1] + 16) << 5 | (differences[2] + 16) << 10;
+            content.push_back(static_cast<char>(SHORT_DIFFERENCES_FOLLOW));
+            content.push_back(static_cast<char>(bits & 0xff));
+            content.push_back(static_cast<char>(bits >> 8));
+        } else {
+            content.push_back(static_cast<char>(DIFFERENCES_FOLLOW));
+            for (int i = 0; i < 3; i++) {
+                write_varint(content, zigzag(differences[i]));
+            }
+        }
+    }
+
+    previous = current;
+    frames++;
+    offset += content.size() - size;
+}
+
+void TrajectoryEncoder::end(std::vector<char> & content)
+{
+    const std::size_t size = content.size();
+    for (auto keyframe : keyframes) {
+        write_le(content, keyframe, 8);
+    }
+    write_le(content, frames, 8);
+    write_le(content, keyframes.size(), 4);
+    content.insert(content.end(), index_magic, index_magic + sizeof(index_magic));
+    offset += content.size() - size;
+}
+
+unsigned long TrajectoryEncoder::size() const
+{
+    return frames;
+}
+
+unsigned int TrajectoryEncoder::get_bits() const
+{
+    return bits;
+}
+
+// the dropped component stays the same while it is at least one half and
+// the others fit, so an orientation turning past two equal components does
+// not switch back and forth
+TrajectoryEncoder::Quantized TrajectoryEncoder::quantize(glm::quat orientation) const
+{
+    orientation = glm::normalize(orientation);
+    float components[4] = { orientation.w, orientation.x, orientation.y, orientation.z };
+
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; i++) {
+        if (std::abs(components[i]) > std::abs(components[largest])) {
+            largest = i;
+        }
+    }
+
+    if (frames > 0 && previous.largest != largest && std::abs(components[previous.largest]) >= 0.5f) {
+        unsigned int const * kept = kept_components[previous.largest];
+        const float others = std::max(std::max(std::abs(components[kept[0]]), std::abs(components[kept[1]])),
+                                      std::abs(components[kept[2]]));
+        if (others <= sqrt_half) {
+            largest = previous.largest;
+        }
+    }
+
+    const float sign = components[largest] < 0.0f ? -scale : scale;
+
+    Quantized quantized;
+    quantized.largest = largest;
+    for (unsigned int i = 0; i < 3; i++) {
+        const float value = std::floor(components[kept_components[largest][i]] * sign + 0.5f);
+        quantized.values[i] = std::min(std::max(static_cast<std::int32_t>(value), -limit), limit);
+    }
+    return quantized;
+}
+
+TrajectoryWriter::TrajectoryWriter()
+{
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    close();
+}
+
+bool TrajectoryWriter::open(std::string const & path, unsigned int bits, unsigned int keyframe_interval)
+{
+    close();
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    encoder = TrajectoryEncoder(bits, keyframe_interval);
+    buffer.clear();
+    encoder.begin(buffer);
+    flush();
+    return good();
+}
+
+void TrajectoryWriter::append(glm::quat orientation)
+{
+    if (!out.is_open()) {
+        return;
+    }
+
+    encoder.append(orientation, buffer);
+    if (buffer.size() >= flush_size) {
+        flush();
+    }
+}
+
+bool TrajectoryWriter::close()
+{
+    if (!out.is_open()) {
+        return true;
+    }
+
+    encoder.end(buffer);
+    flush();
+    const bool written = good();
+    out.close();
+    return written;
+}
+
+bool TrajectoryWriter::good() const
+{
+    return out.good();
+}
+
+void TrajectoryWriter::flush()
+{
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+}
+
+TrajectoryReader::TrajectoryReader()
+    : begin(nullptr),
+      end(nullptr),
+      position(nullptr),
+      bits(0),
+      keyframe_interval(1),
+      step(1.0f),
+      frames(0),
+      frame(0),
+      next_keyframe(0),
+      largest(0),
+      previous(),
+      velocity()
+{
+}
+
+bool TrajectoryReader::open(std::string const & path)
+{
+    if (!file.open(path)) {
+        return false;
+    }
+    return open(file.data(), file.data() + file.size());
+}
+
+bool TrajectoryReader::open(char const * begin, char const * end)
+{
+    frames = 0;
+    keyframes.clear();
+
+    const bool header = static_cast<std::size_t>(end - begin) >= header_size &&
+                        std::memcmp(begin, magic, sizeof(magic)) == 0 &&
+                        static_cast<std::uint8_t>(begin[sizeof(magic)]) == version;
+    if (!header) {
+        return false;
+    }
+
+    bits = static_cast<unsigned char>(begin[sizeof(magic) + 1]);
+    keyframe_interval = read_le(begin + sizeof(magic) + 2, 4);
+    if (bits != clamp_bits(bits) || keyframe_interval == 0) {
+        return false;
+    }
+    step = sqrt_half / component_limit(bits);
+
+    this->begin = begin;
+    this->end = end;
+    if (!read_index()) {
+        build_index();
+    }
+    return seek(0);
+}
+
+unsigned long TrajectoryReader::size() const
+{
+    return frames;
+}
+
+unsigned int TrajectoryReader::get_bits() const
+{
+    return bits;
+}
+
+bool TrajectoryReader::seek(unsigned long frame)
+{
+    if (frame > frames) {
+        return false;
+    }
+
+    const unsigned long keyframe = frame / keyframe_interval;
+    if (keyframe < keyframes.size()) {
+        position = begin + keyframes[keyframe];
+        this->frame = keyframe * keyframe_interval;
+        next_keyframe = this->frame;
+    } else {
+        // the end of a trajectory which ends on a keyframe boundary
+        position = end;
+        this->frame = frames;
+    }
+
+    // a damaged orientation does not advance the frame, so it ends the seek
+    glm::quat skipped;
+    while (this->frame < frame) {
+        if (!decode(skipped)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned long TrajectoryReader::read(glm::quat * orientations, unsigned long count)
+{
+    unsigned long i = 0;
+    while (i < count && decode(orientations[i])) {
+        i++;
+    }
+    return i;
+}
+
+bool TrajectoryReader::decode(glm::quat & orientation)
+{
+    if (frame >= frames) {
+        return false;
+    }
+
+    char const * p = position;
+    if (p == end) {
+        return false;
+    }
+
+    // either the values themselves or the differences to the prediction
+    std::int32_t values[3];
+    std::uint32_t coded[3];
+    bool absolute = frame == next_keyframe;
+    const unsigned int code = absolute ? VALUES_FOLLOW : static_cast<unsigned char>(*p++);
+
+    if (code < packed_codes) {
+        values[0] = static_cast<std::int32_t>(code / 25) - 2;
+        values[1] = static_cast<std::int32_t>(code / 5 % 5) - 2;
+        values[2] = static_cast<std::int32_t>(code % 5) - 2;
+    } else if (code == SHORT_DIFFERENCES_FOLLOW) {
+        if (end - p < 2) {
+            return false;
+        }
+        const unsigned int bits = static_cast<unsigned char>(p[0]) | static_cast<unsigned char>(p[1]) << 8;
+        p += 2;
+        values[0] = static_cast<std::int32_t>(bits & 31) - 16;
+        values[1] = static_cast<std::int32_t>((bits >> 5) & 31) - 16;
+        values[2] = static_cast<std::int32_t>((bits >> 10) & 31) - 16;
+    } else {
+        if (code == VALUES_FOLLOW) {
+            if (p == end) {
+                return false;
+            }
+            largest = static_cast<unsigned char>(*p++);
+            absolute = true;
+        }
+        if (code > VALUES_FOLLOW || largest > 3 ||
+            !read_varint(p, end, coded[0]) || !read_varint(p, end, coded[1]) || !read_varint(p, end, coded[2])) {
+            return false;
+        }
+        values[0] = unzigzag(coded[0]);
+        values[1] = unzigzag(coded[1]);
+        values[2] = unzigzag(coded[2]);
+    }
+
+    // written out for each component, loops over three are vectorized
+    // into something slower
+    if (absolute) {
+        previous[0] = values[0];
+        previous[1] = values[1];
+        previous[2] = values[2];
+        velocity[0] = velocity[1] = velocity[2] = 0;
+    } else {
+        velocity[0] += values[0];
+        velocity[1] += values[1];
+        velocity[2] += values[2];
+        previous[0] += velocity[0];
+        previous[1] += velocity[1];
+        previous[2] += velocity[2];
+    }
+    if (frame == next_keyframe) {
+        next_keyframe += keyframe_interval;
+    }
+
+    const float a = previous[0] * step;
+    const float b = previous[1] * step;
+    const float c = previous[2] * step;
+    const float dropped = std::sqrt(std::max(1.0f - (a * a + b * b + c * c), 0.0f));
+    switch (largest) {
+    case 0:
+        orientation = glm::quat(dropped, a, b, c);
+        break;
+    case 1:
+        orientation = glm::quat(a, dropped, b, c);
+        break;
+    case 2:
+        orientation = glm::quat(a, b, dropped, c);
+        break;
+    default:
+        orientation = glm::quat(a, b, c, dropped);
+        break;
+    }
+
+    position = p;
+    frame++;
+    return true;
+}
+
+bool TrajectoryReader::read_index()
+{
+    const std::size_t size = end - begin;
+    if (size < header_size + trailer_size ||
+        std::memcmp(end - sizeof(index_magic), index_magic, sizeof(index_magic)) != 0) {
+        return false;
+    }
+
+    char const * trailer = end - trailer_size;
+    const std::uint64_t count = read_le(trailer + 8, 4);
+    frames = read_le(trailer, 8);
+    if (count != (frames + keyframe_interval - 1) / keyframe_interval ||
+        count > (size - header_size - trailer_size) / 8) {
+        frames = 0;
+        return false;
+    }
+
+    char const * index = trailer - count * 8;
+    keyframes.resize(count);
+    for (std::uint64_t i = 0; i < count; i++) {
+        keyframes[i] = read_le(index + 8 * i, 8);
+        if (keyframes[i] < header_size || keyframes[i] >= static_cast<std::uint64_t>(index - begin)) {
+            frames = 0;
+            keyframes.clear();
+            return false;
+        }
+    }
+
+    end = index;
+    return true;
+}
+
+// decode every orientation up to the first incomplete one, a log cut off
+// while it was written keeps every orientation before
+void TrajectoryReader::build_index()
+{
+    frames = static_cast<unsigned long>(-1);
+    frame = 0;
+    next_keyframe = 0;
+    position = begin + header_size;
+
+    glm::quat orientation;
+    for (;;) {
+        if (frame % keyframe_interval == 0) {
+            keyframes.push_back(position - begin);
+        }
+        if (!decode(orientation)) {
+            break;
+        }
+    }
+
+    if (frame % keyframe_interval == 0) {
+        keyframes.pop_back();
+    }
+    frames = frame;
+}
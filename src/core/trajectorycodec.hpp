@@ -0,0 +1,144 @@
+#ifndef TRAJECTORYCODEC_HPP_INCLUDED
+#define TRAJECTORYCODEC_HPP_INCLUDED
+
+#include "mappedfile.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Return largest angle in radians between an orientation and the same
+// orientation encoded with specified number of bits per component.
+float trajectory_error_bound(unsigned int bits);
+
+// The responsibility of this class is to compress a stream of orientations.
+// Every orientation is quantized to its three smallest components and coded
+// as the difference to a linear prediction from the orientations before it,
+// an orientation turning at a steady rate takes a single byte. Every few
+// orientations a keyframe is coded on its own, the offsets of the keyframes
+// are written at the end as an index for seeking.
+class TrajectoryEncoder {
+public:
+    // Construct encoder with specified number of bits per component, between
+    // 8 and 24, and number of orientations from one keyframe to the next.
+    explicit TrajectoryEncoder(unsigned int bits = 16, unsigned int keyframe_interval = 256);
+    // Append header of a new trajectory to specified content.
+    void begin(std::vector<char> & content);
+    // Append specified orientation to specified content. The content may
+    // have been emptied since the last append, the encoder counts the bytes
+    // it has appended itself.
+    void append(glm::quat orientation, std::vector<char> & content);
+    // Append keyframe index to specified content, this ends the trajectory.
+    void end(std::vector<char> & content);
+    // Return number of orientations appended since the trajectory began.
+    unsigned long size() const;
+    // Return number of bits per component.
+    unsigned int get_bits() const;
+private:
+    struct Quantized {
+        unsigned int largest;
+        std::int32_t values[3];
+    };
+
+    Quantized quantize(glm::quat orientation) const;
+
+    unsigned int bits;
+    unsigned int keyframe_interval;
+    std::int32_t limit;
+    float scale;
+
+    std::uint64_t offset;
+    std::vector<std::uint64_t> keyframes;
+    unsigned long frames;
+    unsigned long next_keyframe;
+    Quantized previous;
+    // change of the values from the orientation before, zero after a
+    // keyframe or change of the dropped component
+    std::int32_t velocity[3];
+};
+
+// The responsibility of this class is to write orientations to a compressed
+// trajectory file as they are produced. The file is written every few
+// kilobytes, so a log that ends without close is still readable up to the
+// last write.
+class TrajectoryWriter {
+public:
+    // Construct writer without a file.
+    TrajectoryWriter();
+    // Close file.
+    ~TrajectoryWriter();
+    TrajectoryWriter(TrajectoryWriter const &) = delete;
+    TrajectoryWriter & operator=(TrajectoryWriter const &) = delete;
+    // Open file at specified path, see TrajectoryEncoder for the arguments.
+    // Return false if the file could not be created.
+    bool open(std::string const & path, unsigned int bits = 16, unsigned int keyframe_interval = 256);
+    // Append specified orientation.
+    void append(glm::quat orientation);
+    // Write keyframe index and close file. Return true if every orientation
+    // was written.
+    bool close();
+    // Return true if every orientation so far was written.
+    bool good() const;
+private:
+    void flush();
+
+    std::ofstream out;
+    TrajectoryEncoder encoder;
+    std::vector<char> buffer;
+};
+
+// The responsibility of this class is to decode a compressed trajectory from
+// any orientation on. Seeking decodes from the keyframe before, at most a
+// keyframe interval of orientations. A trajectory without index, from a log
+// which was never closed, is indexed by decoding it once when opened.
+class TrajectoryReader {
+public:
+    // Construct reader without a trajectory.
+    TrajectoryReader();
+    TrajectoryReader(TrajectoryReader const &) = delete;
+    TrajectoryReader & operator=(TrajectoryReader const &) = delete;
+    // Map trajectory file at specified path. Return false if it could not be
+    // read or is not a trajectory.
+    bool open(std::string const & path);
+    // Read trajectory from content between specified pointers, which must
+    // outlive the reader. Return false if it is not a trajectory.
+    bool open(char const * begin, char const * end);
+    // Return number of orientations.
+    unsigned long size() const;
+    // Return number of bits per component.
+    unsigned int get_bits() const;
+    // Set specified orientation to be read next. Return false if it is past
+    // the end or an orientation before it is damaged.
+    bool seek(unsigned long frame);
+    // Read up to specified number of orientations into specified array and
+    // return the number read, reading stops at the end or at a damaged
+    // orientation.
+    unsigned long read(glm::quat * orientations, unsigned long count);
+private:
+    bool decode(glm::quat & orientation);
+    bool read_index();
+    void build_index();
+
+    MappedFile file;
+    char const * begin;
+    char const * end;
+    char const * position;
+
+    unsigned int bits;
+    unsigned int keyframe_interval;
+    float step;
+
+    std::vector<std::uint64_t> keyframes;
+    unsigned long frames;
+    unsigned long frame;
+    unsigned long next_keyframe;
+    unsigned int largest;
+    std::int32_t previous[3];
+    std::int32_t velocity[3];
+};
+
+#endif
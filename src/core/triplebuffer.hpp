@@ -0,0 +1,75 @@
+#ifndef TRIPLEBUFFER_HPP_INCLUDED
+#define TRIPLEBUFFER_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+
+// The responsibility of this class is to hand the newest value from one
+// writer thread to one reader thread without locking. The writer fills the
+// back buffer and publishes it, the reader picks up the newest published
+// buffer. Neither side ever waits for the other, values published in
+// between reads are skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    // Construct triple buffer with every buffer set to specified value.
+    explicit TripleBuffer(T const & value = T());
+    // Return buffer the writer fills before publishing it.
+    T & back();
+    // Publish the back buffer, the writer gets a new back buffer.
+    void publish();
+    // Pick up the newest published buffer. Return true if there was one
+    // since the last call.
+    bool update();
+    // Return buffer picked up by the last update.
+    T const & front() const;
+private:
+    // the middle index carries a flag telling if it was published after the
+    // reader last picked it up
+    static const unsigned int FRESH = 4;
+    static const unsigned int INDEX = 3;
+
+    std::array<T, 3> buffers;
+    unsigned int back_index;
+    std::atomic<unsigned int> middle;
+    unsigned int front_index;
+};
+
+template <typename T>
+TripleBuffer<T>::TripleBuffer(T const & value)
+    : back_index(0),
+      middle(1),
+      front_index(2)
+{
+    buffers.fill(value);
+}
+
+template <typename T>
+T & TripleBuffer<T>::back()
+{
+    return buffers[back_index];
+}
+
+template <typename T>
+void TripleBuffer<T>::publish()
+{
+    back_index = middle.exchange(back_index | FRESH, std::memory_order_acq_rel) & INDEX;
+}
+
+template <typename T>
+bool TripleBuffer<T>::update()
+{
+    if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+        return false;
+    }
+    front_index = middle.exchange(front_index, std::memory_order_acq_rel) & INDEX;
+    return true;
+}
+
+template <typename T>
+T const & TripleBuffer<T>::front() const
+{
+    return buffers[front_index];
+}
+
+#endif
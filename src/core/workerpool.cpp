@@ -0,0 +1,80 @@
+#include "workerpool.hpp"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int workers)
+    : job(nullptr),
+      generation(0),
+      pending(0),
+      stopping(false)
+{
+    if (workers == 0) {
+        workers = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (unsigned int worker = 1; worker < workers; worker++) {
+        threads.emplace_back(&WorkerPool::work, this, worker);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+
+    for (auto & thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(std::function<void(unsigned int)> const & job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        pending = threads.size();
+        generation++;
+    }
+    job_ready.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this]() { return pending == 0; });
+    this->job = nullptr;
+}
+
+unsigned int WorkerPool::size() const
+{
+    return threads.size() + 1;
+}
+
+// every worker runs each job once, the generation tells a new job from the
+// one it has already run
+void WorkerPool::work(unsigned int worker)
+{
+    unsigned long done = 0;
+
+    while (true) {
+        std::function<void(unsigned int)> const * current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [&]() { return stopping || generation != done; });
+            if (stopping) {
+                return;
+            }
+            done = generation;
+            current = job;
+        }
+
+        (*current)(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            job_done.notify_one();
+        }
+    }
+}
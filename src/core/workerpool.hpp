@@ -0,0 +1,42 @@
+#ifndef WORKERPOOL_HPP_INCLUDED
+#define WORKERPOOL_HPP_INCLUDED
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The responsibility of this class is to run a job on a fixed set of worker
+// threads and the calling thread at once, and to wait until every one of
+// them has finished it. The threads are started once and sleep between
+// jobs, so running a job costs a wake-up rather than a thread start.
+class WorkerPool {
+public:
+    // Start pool with specified number of workers including the calling
+    // thread, or one per hardware thread if zero.
+    explicit WorkerPool(unsigned int workers = 0);
+    // Stop worker threads.
+    ~WorkerPool();
+    WorkerPool(WorkerPool const &) = delete;
+    WorkerPool & operator=(WorkerPool const &) = delete;
+    // Run specified job once on every worker and return when all are done.
+    // The job is called with the worker number, the calling thread is worker
+    // zero.
+    void run(std::function<void(unsigned int)> const & job);
+    // Return number of workers including the calling thread.
+    unsigned int size() const;
+private:
+    void work(unsigned int worker);
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    std::function<void(unsigned int)> const * job;
+    unsigned long generation;
+    unsigned int pending;
+    bool stopping;
+};
+
+#endif
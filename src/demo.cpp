@@ -1,12 +1,82 @@
 #include "demo.hpp"
 
-Demo::Demo(std::shared_ptr<gst::Logger> logger, std::shared_ptr<gst::Window> window)
+#include "meshcache.hpp"
+#include "profiler.hpp"
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const float fov = 45.0f;
+const float z_near = 0.1f;
+const float z_far = 1000.0f;
+
+// return the same perspective projection matrix as the scene eye
+glm::mat4 perspective(gst::Resolution size)
+{
+    const float f = 1.0f / std::tan(fov * 3.14159265f / 360.0f);
+    const float aspect = static_cast<float>(size.get_width()) / size.get_height();
+
+    glm::mat4 matrix(0.0f);
+    matrix[0][0] = f / aspect;
+    matrix[1][1] = f;
+    matrix[2][2] = (z_far + z_near) / (z_near - z_far);
+    matrix[2][3] = -1.0f;
+    matrix[3][2] = 2.0f * z_far * z_near / (z_near - z_far);
+    return matrix;
+}
+
+// return view matrix of specified eye
+glm::mat4 view_matrix(gst::Spatial const & eye)
+{
+    glm::mat4 rotation = glm::mat4_cast(glm::conjugate(eye.orientation));
+    glm::mat4 translation(1.0f);
+    translation[3] = glm::vec4(-eye.position, 1.0f);
+    return rotation * translation;
+}
+
+// return mesh with geometry mapped from a compiled mesh
+gst::Mesh create_mesh(MeshCache const & cache)
+{
+    MeshData data;
+    cache.copy_to(data);
+
+    auto vertex_array = std::make_shared<gst::VertexArrayImpl>();
+    auto mesh = gst::Mesh(vertex_array);
+    mesh.set_positions(data.positions);
+    mesh.set_normals(data.normals);
+    mesh.set_indices(data.indices);
+    return mesh;
+}
+
+}
+
+Demo::Demo(
+    std::shared_ptr<gst::Logger> logger,
+    std::shared_ptr<gst::Window> window,
+    std::string const & record_path,
+    std::shared_ptr<TrajectoryWriter> trajectory,
+    bool threaded,
+    bool inertia,
+    std::shared_ptr<OrientationTrack const> playback,
+    unsigned int view_count,
+    bool instanced)
     : logger(logger),
       window(window),
+      record_path(record_path),
+      trajectory(trajectory),
+      threaded(threaded),
+      playback(playback),
+      view_count(view_count),
+      instanced(instanced),
       renderer(gst::Renderer::create(logger)),
       render_size(window->get_size()),
       programs(logger),
-      show_helpers(true)
+      arcball_inertia(inertia ? std::make_shared<ArcballInertia>() : nullptr),
+      arcball_playback(playback ? std::make_shared<ArcballPlayback>() : nullptr),
+      show_helpers(true),
+      helpers_current(false)
 {
 }
 
@@ -16,23 +86,49 @@ bool Demo::create()
     renderer.set_viewport(render_size);
 
     create_scene();
-    create_arcball();
+    if (!create_arcball()) {
+        return false;
+    }
     create_lights();
+    if (view_count > 1) {
+        create_views();
+    }
 
     return true;
 }
 
-void Demo::update(float, float)
+void Demo::update(float delta, float)
 {
-    update_input();
+    PROFILE_SCOPE("Demo::update");
+
+    update_input(delta);
 
     renderer.clear(true, true);
-    renderer.render(scene);
+    if (!views.empty()) {
+        update_views();
+        return;
+    }
+
+    {
+        PROFILE_SCOPE("Renderer::render scene");
+        renderer.render(scene);
+    }
+
+    // the helpers only need to follow the arcball when it has changed, which
+    // may also have happened while they were hidden
+    if (arcball.changed()) {
+        helpers_current = false;
+    }
 
     if (show_helpers) {
-        arcball_helper.update(arcball);
-        auto helpers = arcball_helper.get_helpers();
+        if (!helpers_current) {
+            arcball_helper.update(arcball);
+            helpers_current = true;
+        }
+        auto & helpers = arcball_helper.get_helpers();
+        PROFILE_SCOPE("Renderer::render helpers");
         renderer.render(helpers);
+        arcball_helper.draw_instances();
     }
 }
 
@@ -42,13 +138,14 @@ void Demo::destroy()
 
 void Demo::create_scene()
 {
-    scene = gst::Scene::create_perspective({ 45.0f, render_size, 0.1f, 1000.0f });
+    scene = gst::Scene::create_perspective({ fov, render_size, z_near, z_far });
+    projection = perspective(render_size);
     scene.get_eye().rotate_x(-30.0f);
     scene.get_eye().rotate_y(20.0f);
     scene.get_eye().translate_z(4.2f);
 }
 
-void Demo::create_arcball()
+bool Demo::create_arcball()
 {
     auto blinn_phong_program = programs.create(BLINNPHONG_VS, BLINNPHONG_FS);
     auto shaded_pass = std::make_shared<gst::ShadedPass>(blinn_phong_program);
@@ -62,20 +159,61 @@ void Demo::create_arcball()
     material.get_uniform("emission") = glm::vec3(0.0f);
     material.get_uniform("shininess") = 21.0f;
 
-    gst::MeshFactory mesh_factory(logger);
+    // the compiled mesh is kept next to the model and loaded without parsing
+    // as long as the model is unchanged, the model is parsed by gust only if
+    // it can not be read
+    std::vector<gst::Mesh> meshes;
+    MeshCache mesh_cache;
+    if (mesh_cache.open(SUZANNE_OBJ, SUZANNE_MESH)) {
+        meshes.push_back(create_mesh(mesh_cache));
+    } else {
+        gst::MeshFactory mesh_factory(logger);
+        meshes = mesh_factory.create_from_file(SUZANNE_OBJ);
+    }
+
     auto suzanne = std::make_shared<gst::GroupNode>();
-    for (auto mesh : mesh_factory.create_from_file(SUZANNE_OBJ)) {
+    for (auto mesh : meshes) {
         auto model = gst::Model(mesh, material, shaded_pass);
         auto model_node = std::make_shared<gst::ModelNode>(model);
         suzanne->add(model_node);
     }
     scene.add(suzanne);
+    model = suzanne;
 
     arcball = Arcball(suzanne);
     arcball.set_allow_constraints(true);
+    // the recording starts from the arcball as it is built, so it replays
+    // from the same orientation and constraint setting
+    if (!record_path.empty()) {
+        recorder = std::make_shared<ArcballRecorder>();
+        ArcballCore const & core = arcball.get_core();
+        if (!recorder->open(record_path, core.get_orientation().now, core.get_allow_constraints())) {
+            std::cerr << "unable to record to " << record_path << std::endl;
+            return false;
+        }
+        arcball.set_recorder(recorder);
+    }
+    arcball.set_trajectory(trajectory);
+    arcball.set_threaded(threaded);
+    arcball.set_inertia(arcball_inertia, 0);
+    arcball.set_playback(arcball_playback, 0);
+    if (arcball_playback) {
+        arcball_playback->play(0, playback);
+    }
+
+    // the helpers are drawn as nodes if the arc shaders are not supported
+    if (instanced) {
+        arc_renderer = std::make_shared<ArcInstanceRenderer>();
+        if (!arc_renderer->create(ARC_VS, ARC_FS)) {
+            arc_renderer = nullptr;
+        }
+    }
 
     arcball_helper = ArcballHelper::create(programs);
     arcball_helper.set_show_result(false);
+    arcball_helper.set_arc_renderer(arc_renderer);
+
+    return true;
 }
 
 void Demo::create_lights()
@@ -101,14 +239,139 @@ void Demo::create_lights()
     scene.add(light_node1);
 }
 
-void Demo::update_input()
+// the views are laid out on a square grid, leaving cells at the end empty,
+// each looking at the model from
+// another side at the same distance as the single view
+void Demo::create_views()
+{
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(view_count))));
+    const int width = render_size.get_width() / columns;
+    const int height = render_size.get_height() / columns;
+
+    auto & eye = scene.get_eye();
+    const auto orientation = eye.orientation;
+    const auto position = eye.position;
+
+    for (unsigned int i = 0; i < view_count; i++) {
+        ArcballView view;
+        view.viewport.x = (i % columns) * width;
+        view.viewport.y = (i / columns) * height;
+        view.viewport.width = width;
+        view.viewport.height = height;
+
+        eye.orientation = glm::quat();
+        eye.position = glm::vec3(0.0f);
+        eye.rotate_x(-30.0f);
+        eye.rotate_y(20.0f + i * 360.0f / view_count);
+        eye.translate_z(4.2f);
+        view.camera.orientation = eye.orientation;
+
+        // the cells keep the aspect of the window so the projection of the
+        // scene eye is shared by every view
+        BallProjector projector;
+        projector.set_eye(view_matrix(eye), projection);
+        view.center = projector.project(model->position);
+
+        auto helper = ArcballHelper::create(programs);
+        helper.set_show_result(false);
+        helper.set_arc_renderer(arc_renderer);
+
+        views.push_back(view);
+        view_orientations.push_back(eye.orientation);
+        view_positions.push_back(eye.position);
+        view_viewports.push_back(gst::Viewport(
+            view.viewport.x,
+            render_size.get_height() - view.viewport.y - height,
+            width,
+            height));
+        view_projectors.push_back(projector);
+        view_helpers.push_back(helper);
+    }
+
+    eye.orientation = orientation;
+    eye.position = position;
+
+    workers.reset(new WorkerPool());
+}
+
+// every view renders the scene through its own eye, the helpers of the views
+// are generated on the workers and uploaded here since that needs the context
+void Demo::update_views()
+{
+    PROFILE_SCOPE("Demo::update_views");
+
+    if (show_helpers) {
+        PROFILE_SCOPE("ArcballHelper::generate views");
+        const unsigned int worker_count = workers->size();
+        workers->run([this, worker_count](unsigned int worker)
+        {
+            for (unsigned int i = worker; i < views.size(); i += worker_count) {
+                view_helpers[i].generate(arcball.get_core(i));
+            }
+        });
+    }
+
+    auto & eye = scene.get_eye();
+    for (unsigned int i = 0; i < views.size(); i++) {
+        eye.orientation = view_orientations[i];
+        eye.position = view_positions[i];
+        {
+            PROFILE_SCOPE("Scene::update");
+            scene.update();
+        }
+
+        renderer.set_viewport(view_viewports[i]);
+        {
+            PROFILE_SCOPE("Renderer::render scene");
+            renderer.render(scene);
+        }
+
+        if (show_helpers) {
+            view_helpers[i].upload();
+            PROFILE_SCOPE("Renderer::render helpers");
+            renderer.render(view_helpers[i].get_helpers());
+            view_helpers[i].draw_instances();
+        }
+    }
+    renderer.set_viewport(render_size);
+}
+
+void Demo::update_input(float delta)
 {
+    PROFILE_SCOPE("Demo::update_input");
+
     auto input = window->get_input();
 
     if (input.pressed(gst::Key::F1)) {
         show_helpers = !show_helpers;
     }
 
-    arcball.update(input, scene.get_eye(), render_size);
-    scene.update();
+    if (arcball_inertia) {
+        arcball_inertia->advance(delta);
+    }
+    if (arcball_playback) {
+        arcball_playback->advance(delta);
+    }
+
+    // the arcball is dragged through the view under the cursor and the
+    // scene is updated through the eye of every view when rendered
+    if (!views.empty()) {
+        for (unsigned int i = 0; i < views.size(); i++) {
+            views[i].center = view_projectors[i].project(model->position);
+        }
+        arcball.update(input, views);
+        return;
+    }
+
+    // the ball is centered where the model is seen, the view projection is
+    // only recomputed when the eye has moved
+    auto & eye = scene.get_eye();
+    projector.set_eye(view_matrix(eye), projection);
+    arcball.set_center(projector.project(model->position));
+
+    arcball.update(input, eye, render_size);
+    if (arcball.changed()) {
+        PROFILE_SCOPE("Scene::update");
+        scene.update();
+    }
 }
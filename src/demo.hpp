@@ -4,34 +4,80 @@
 #include "arcball.hpp"
 #include "arcballhelper.hpp"
 #include "assets.hpp"
+#include "ballprojector.hpp"
+#include "workerpool.hpp"
 
 #include "gust.hpp"
 
 class Demo : public gst::World {
 public:
-    Demo(std::shared_ptr<gst::Logger> logger, std::shared_ptr<gst::Window> window);
+    // Construct demo, every arcball update is recorded to a log at specified
+    // path unless it is empty, and every changed orientation is written to
+    // specified trajectory unless it is null. The arcball is solved on its
+    // own input thread if threaded is true, and the model keeps spinning when
+    // released if inertia is true. The model plays specified track from the
+    // start unless it is null.
+    // The window is split into a grid of specified number of views, each
+    // looking at the model from another side. The helpers are drawn as arc
+    // instances if instanced is true.
+    Demo(
+        std::shared_ptr<gst::Logger> logger,
+        std::shared_ptr<gst::Window> window,
+        std::string const & record_path = "",
+        std::shared_ptr<TrajectoryWriter> trajectory = nullptr,
+        bool threaded = false,
+        bool inertia = false,
+        std::shared_ptr<OrientationTrack const> playback = nullptr,
+        unsigned int view_count = 1,
+        bool instanced = false);
     bool create() final;
     void update(float delta, float elapsed) final;
     void destroy() final;
 private:
     void create_scene();
-    void create_arcball();
+    bool create_arcball();
     void create_lights();
-    void update_input();
+    void create_views();
+    void update_input(float delta);
+    void update_views();
 
     std::shared_ptr<gst::Logger> logger;
     std::shared_ptr<gst::Window> window;
+    std::string record_path;
+    std::shared_ptr<ArcballRecorder> recorder;
+    std::shared_ptr<TrajectoryWriter> trajectory;
+    bool threaded;
+    std::shared_ptr<OrientationTrack const> playback;
+    unsigned int view_count;
+    bool instanced;
 
     gst::Renderer renderer;
     gst::Scene scene;
+    glm::mat4 projection;
 
     gst::Resolution render_size;
     gst::ProgramPool programs;
 
+    std::shared_ptr<gst::GroupNode> model;
+    BallProjector projector;
     Arcball arcball;
+    std::shared_ptr<ArcballInertia> arcball_inertia;
+    std::shared_ptr<ArcballPlayback> arcball_playback;
     ArcballHelper arcball_helper;
+    std::shared_ptr<ArcInstanceRenderer> arc_renderer;
 
     bool show_helpers;
+    bool helpers_current;
+
+    // views of the model when there are several, the eye of each view and
+    // its viewport for rendering, which counts from the bottom of the window
+    std::vector<ArcballView> views;
+    std::vector<glm::quat> view_orientations;
+    std::vector<glm::vec3> view_positions;
+    std::vector<gst::Viewport> view_viewports;
+    std::vector<BallProjector> view_projectors;
+    std::vector<ArcballHelper> view_helpers;
+    std::unique_ptr<WorkerPool> workers;
 };
 
 #endif
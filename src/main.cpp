@@ -1,11 +1,83 @@
 #include "demo.hpp"
+#include "profiler.hpp"
 #include "highresolutionclock.hpp"
 #include "stdoutlogger.hpp"
 #include "windowimpl.hpp"
 #include "worldrunner.hpp"
 
-int main()
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Run demo, every arcball update is recorded to a log for arcball_replay when
+// started with --record <path> and every orientation of the arcball to a
+// compressed trajectory when started with --trajectory <path>, the arcball
+// is solved on its own input thread when started with --threaded, and the
+// model keeps spinning when released when started with --inertia. The frame
+// stages are written as a Chrome trace to specified path on exit when
+// started with --trace <path>, which requires a build with profiling. The
+// model plays a trajectory back when started with --playback <path>, one
+// orientation per frame of a 60 Hz display since the trajectory only holds
+// the changed orientations, until clicked. The window is split into
+// specified number of views of the model when started with --views <count>,
+// and the helpers are drawn as arc instances when started with --instanced.
+int main(int argc, char * argv[])
 {
+    std::string record_path;
+    std::shared_ptr<TrajectoryWriter> trajectory;
+    std::shared_ptr<OrientationTrack> playback;
+    bool threaded = false;
+    bool inertia = false;
+    unsigned int view_count = 1;
+    bool instanced = false;
+    char const * trace_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            // opened by the demo once the arcball is built
+            record_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--trajectory") == 0 && i + 1 < argc) {
+            trajectory = std::make_shared<TrajectoryWriter>();
+            if (!trajectory->open(argv[++i])) {
+                std::cerr << "unable to write trajectory to " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--playback") == 0 && i + 1 < argc) {
+            TrajectoryReader reader;
+            if (!reader.open(argv[++i])) {
+                std::cerr << "unable to read trajectory from " << argv[i] << std::endl;
+                return 1;
+            }
+            playback = std::make_shared<OrientationTrack>();
+            glm::quat orientation;
+            for (unsigned long frame = 0; reader.read(&orientation, 1) == 1; frame++) {
+                playback->add(frame / 60.0f, orientation);
+            }
+        } else if (std::strcmp(argv[i], "--threaded") == 0) {
+            threaded = true;
+        } else if (std::strcmp(argv[i], "--inertia") == 0) {
+            inertia = true;
+        } else if (std::strcmp(argv[i], "--views") == 0 && i + 1 < argc) {
+            const int count = std::atoi(argv[++i]);
+            if (count < 1 || count > 16) {
+                std::cerr << "number of views must be between 1 and 16" << std::endl;
+                return 1;
+            }
+            view_count = count;
+        } else if (std::strcmp(argv[i], "--instanced") == 0) {
+            instanced = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+            if (!profiling_enabled()) {
+                std::cerr << "profiling is not built in, build with profile=1" << std::endl;
+            }
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--record <path>] [--trajectory <path>] [--playback <path>] [--threaded] [--inertia] [--views <count>] [--instanced] [--trace <path>]" << std::endl;
+            return 1;
+        }
+    }
+
     auto logger = std::make_shared<gst::StdoutLogger>();
     auto window = std::make_shared<gst::WindowImpl>(
         logger,
@@ -26,8 +98,19 @@ int main()
     if (window->open()) {
         auto runner = gst::WorldRunner();
         auto clock = gst::HighResolutionClock();
-        auto demo = Demo(logger, window);
-        return runner.control(demo, clock, *window);
+        auto demo = Demo(logger, window, record_path, trajectory, threaded, inertia, playback, view_count, instanced);
+        const int status = runner.control(demo, clock, *window);
+
+        if (trace_path) {
+            std::ofstream trace(trace_path);
+            if (!trace) {
+                std::cerr << "unable to write trace to " << trace_path << std::endl;
+                return 1;
+            }
+            Profiler::instance().write_trace(trace);
+        }
+
+        return status;
     } else {
         return 1;
     }
@@ -0,0 +1,101 @@
+#include "arcballcore.hpp"
+#include "arcballrecord.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// return FNV-1a hash of the bit patterns of specified orientation, equal
+// checksums mean bit identical orientations
+std::uint64_t checksum(glm::quat orientation)
+{
+    const float values[4] = { orientation.w, orientation.x, orientation.y, orientation.z };
+    unsigned char bytes[sizeof(values)];
+    std::memcpy(bytes, values, sizeof(values));
+
+    std::uint64_t hash = 14695981039346656037ull;
+    for (auto byte : bytes) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// drive a fresh arcball through every sample of specified recording and
+// return its final orientation
+glm::quat replay(ArcballRecording const & recording)
+{
+    ArcballCore core(recording.orientation);
+    core.set_allow_constraints(recording.allow_constraints);
+
+    for (auto const & sample : recording.samples) {
+        if (sample.set_orientation) {
+            core.set_orientation(sample.orientation);
+        } else {
+            core.set_center(sample.center);
+            core.update(sample.input, sample.camera, sample.viewport);
+        }
+    }
+
+    return core.get_orientation().now;
+}
+
+}
+
+// Replay the recording given as the first argument as fast as possible, the
+// number of passes over the recording may be given as the second argument.
+// Report throughput and a checksum of the final orientation.
+int main(int argc, char * argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <recording> [passes]" << std::endl;
+        return 1;
+    }
+
+    ArcballRecording recording;
+    if (!load_recording(argv[1], recording)) {
+        std::cerr << "unable to read recording " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const long passes = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 100;
+    if (passes < 1) {
+        std::cerr << "passes must be at least 1" << std::endl;
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock clock;
+
+    glm::quat orientation;
+    const auto begin = clock::now();
+    for (long i = 0; i < passes; i++) {
+        orientation = replay(recording);
+    }
+    const auto end = clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    const double updates = static_cast<double>(recording.samples.size()) * passes;
+    const float duration = recording.samples.empty() ? 0.0f : recording.samples.back().time;
+
+    std::cout << "samples:     " << recording.samples.size() << std::endl;
+    std::cout << "duration:    " << duration << " s" << std::endl;
+    std::cout << "passes:      " << passes << std::endl;
+    std::cout << "ns/update:   " << (updates > 0.0 ? seconds * 1e9 / updates : 0.0) << std::endl;
+    std::cout << "updates/s:   " << (seconds > 0.0 ? updates / seconds : 0.0) << std::endl;
+    std::cout << std::setprecision(9);
+    std::cout << "orientation: "
+              << orientation.w << " "
+              << orientation.x << " "
+              << orientation.y << " "
+              << orientation.z << std::endl;
+    std::cout << "checksum:    "
+              << std::hex << std::setw(16) << std::setfill('0')
+              << checksum(orientation) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "dragsolver.hpp"
+#include "dragstream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// number of times every solve is timed, the fastest is reported
+const int passes = 3;
+
+// return rotation of specified angle in degrees around specified axis
+glm::quat rotation(float degrees, glm::vec3 axis)
+{
+    const float half = degrees * 3.14159265f / 360.0f;
+    return glm::quat(std::cos(half), axis * std::sin(half));
+}
+
+// return synthetic script of an inspection session, short drags in every
+// direction seen from an orbiting camera, mostly free and along camera or
+// world axes with an occasional body axis drag
+std::vector<DragSegment> generate_segments(unsigned long count)
+{
+    std::vector<DragSegment> segments(count);
+    for (unsigned long i = 0; i < count; i++) {
+        DragSegment & segment = segments[i];
+        segment.from = glm::vec2(0.6f * std::sin(i * 0.37f), 0.6f * std::cos(i * 0.23f));
+        segment.to = segment.from + glm::vec2(0.1f * std::cos(i * 0.71f), 0.1f * std::sin(i * 0.53f));
+        segment.axis_set = static_cast<AxisSet>(i % 3 == 2 ? 3 : i % 3);
+        if (i % 10000 == 5000) {
+            segment.axis_set = AxisSet::BODY;
+        }
+        segment.camera = rotation((i / 1000) % 360, glm::vec3(0.0f, 1.0f, 0.0f)) *
+                         rotation(-30.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+    return segments;
+}
+
+// return angle in radians of the rotation between two orientations, from the
+// distance of the quaternions which unlike acos of their dot product resolves
+// the smallest differences
+float angle_between(glm::quat a, glm::quat b)
+{
+    if (glm::dot(a, b) < 0.0f) {
+        b = -b;
+    }
+    const glm::quat d(a.w - b.w, a.x - b.x, a.y - b.y, a.z - b.z);
+    return 4.0f * std::asin(std::min(std::sqrt(glm::dot(d, d)) * 0.5f, 1.0f));
+}
+
+template <typename Solve>
+double fastest(Solve solve)
+{
+    typedef std::chrono::steady_clock clock;
+
+    double best = 0.0;
+    for (int i = 0; i < passes; i++) {
+        const auto begin = clock::now();
+        solve();
+        const double seconds = std::chrono::duration<double>(clock::now() - begin).count();
+        best = i == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+void usage(char const * program)
+{
+    std::cerr << "usage: " << program << " [--threads <count>] [--radius <radius>] <segments> [<orientations>]" << std::endl
+              << "       " << program << " --generate <count> <segments>" << std::endl;
+}
+
+}
+
+// Solve every drag segment of the stream given as the first argument, CSV or
+// binary or "-" for standard input, chained from the identity orientation,
+// and write the orientation after every segment to the file given as the
+// second argument. The load, the solve in order on a single core and the
+// parallel solve are timed, throughput per core and scaling efficiency are
+// reported with the largest difference between the two. A synthetic stream of
+// specified number of segments is written with --generate.
+int main(int argc, char * argv[])
+{
+    unsigned int threads = 0;
+    float radius = 0.75f;
+
+    int i = 1;
+    for (; i < argc && std::strncmp(argv[i], "--", 2) == 0; i++) {
+        if (std::strcmp(argv[i], "--generate") == 0 && i + 2 < argc) {
+            const unsigned long count = std::strtoul(argv[i + 1], nullptr, 10);
+            if (!save_drag_segments(argv[i + 2], generate_segments(count))) {
+                std::cerr << "unable to write segments to " << argv[i + 2] << std::endl;
+                return 1;
+            }
+            return 0;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--radius") == 0 && i + 1 < argc) {
+            radius = std::strtof(argv[++i], nullptr);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (i == argc || argc - i > 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock clock;
+
+    std::vector<DragSegment> segments;
+    const auto load_begin = clock::now();
+    if (!load_drag_segments(argv[i], segments)) {
+        std::cerr << "unable to read segments from " << argv[i] << std::endl;
+        return 1;
+    }
+    const double load_seconds = std::chrono::duration<double>(clock::now() - load_begin).count();
+
+    // timings of an empty stream mean nothing
+    if (segments.empty()) {
+        if (i + 1 < argc && !save_orientations(argv[i + 1], std::vector<glm::quat>())) {
+            std::cerr << "unable to write orientations to " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        std::cout << "segments:          0, nothing to solve" << std::endl;
+        return 0;
+    }
+
+    std::vector<glm::quat> in_order(segments.size());
+    const double sequential_seconds = fastest([&]() {
+        solve_drags(segments.data(), segments.size(), glm::quat(), radius, in_order.data());
+    });
+
+    DragSolver solver(radius, threads);
+    std::vector<glm::quat> orientations;
+    const double parallel_seconds = fastest([&]() {
+        solver.solve(segments, glm::quat(), orientations);
+    });
+
+    float max_difference = 0.0f;
+    for (unsigned int j = 0; j < segments.size(); j++) {
+        max_difference = std::max(max_difference, angle_between(in_order[j], orientations[j]));
+    }
+
+    if (i + 1 < argc && !save_orientations(argv[i + 1], orientations)) {
+        std::cerr << "unable to write orientations to " << argv[i + 1] << std::endl;
+        return 1;
+    }
+
+    const unsigned long body = std::count_if(segments.begin(), segments.end(), [](DragSegment const & segment) {
+        return segment.axis_set == AxisSet::BODY;
+    });
+    const double count = segments.size();
+    const double speedup = sequential_seconds / parallel_seconds;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "segments:          " << segments.size() << " (" << body << " body axis drags)" << std::endl
+              << "threads:           " << solver.get_threads() << std::endl
+              << "load:              " << load_seconds * 1000.0 << " ms, "
+              << count / load_seconds / 1e6 << " M segments/s" << std::endl
+              << "in order:          " << sequential_seconds * 1000.0 << " ms, "
+              << count / sequential_seconds / 1e6 << " M segments/s" << std::endl
+              << "parallel:          " << parallel_seconds * 1000.0 << " ms, "
+              << count / parallel_seconds / 1e6 << " M segments/s" << std::endl
+              << "per core:          " << count / parallel_seconds / solver.get_threads() / 1e6 << " M segments/s" << std::endl
+              << "speedup:           " << speedup << std::endl
+              << "efficiency:        " << speedup / solver.get_threads() << std::endl
+              << std::scientific << std::setprecision(2)
+              << "max difference:    " << max_difference << " rad" << std::endl;
+
+    return 0;
+}
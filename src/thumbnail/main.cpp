@@ -0,0 +1,258 @@
+#include "arcballcore.hpp"
+#include "arcballgeometry.hpp"
+#include "ballprojector.hpp"
+#include "objloader.hpp"
+#include "pngwriter.hpp"
+#include "softrasterizer.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// the same eye, lights and material as the demo scene
+const float fov = 45.0f;
+const float z_near = 0.1f;
+const float z_far = 1000.0f;
+
+glm::mat4 perspective(unsigned int width, unsigned int height)
+{
+    const float f = 1.0f / std::tan(fov * 3.14159265f / 360.0f);
+    const float aspect = static_cast<float>(width) / height;
+
+    glm::mat4 matrix(0.0f);
+    matrix[0][0] = f / aspect;
+    matrix[1][1] = f;
+    matrix[2][2] = (z_far + z_near) / (z_near - z_far);
+    matrix[2][3] = -1.0f;
+    matrix[3][2] = 2.0f * z_far * z_near / (z_near - z_far);
+    return matrix;
+}
+
+glm::quat rotation(float degrees, glm::vec3 axis)
+{
+    return glm::angleAxis(degrees * 3.14159265f / 180.0f, axis);
+}
+
+ArcballCamera create_eye()
+{
+    ArcballCamera eye;
+    eye.orientation = rotation(-30.0f, glm::vec3(1.0f, 0.0f, 0.0f)) * rotation(20.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+    return eye;
+}
+
+glm::mat4 view_matrix(ArcballCamera const & eye)
+{
+    const glm::vec3 position = eye.orientation * glm::vec3(0.0f, 0.0f, 4.2f);
+
+    glm::mat4 rotation = glm::mat4_cast(glm::conjugate(eye.orientation));
+    glm::mat4 translation(1.0f);
+    translation[3] = glm::vec4(-position, 1.0f);
+    return rotation * translation;
+}
+
+RasterMaterial create_material()
+{
+    RasterMaterial material;
+    material.ambient = glm::vec3(1.2f);
+    material.diffuse = glm::vec3(0.8f);
+    material.specular = glm::vec3(1.0f);
+    material.emission = glm::vec3(0.0f);
+    material.shininess = 21.0f;
+    return material;
+}
+
+std::vector<RasterLight> create_lights(glm::mat4 const & view)
+{
+    auto create_light = [&view](glm::vec3 position, glm::vec3 diffuse)
+    {
+        RasterLight light;
+        light.position = glm::vec3(view * glm::vec4(position, 1.0f));
+        light.ambient = glm::vec3(0.0f);
+        light.diffuse = diffuse;
+        light.specular = glm::vec3(1.0f);
+        light.constant = 1.0f;
+        light.linear = 0.5f;
+        light.quadratic = 0.03f;
+        return light;
+    };
+
+    return {
+        create_light(glm::vec3(1.8f, 1.2f, 1.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+        create_light(glm::vec3(-2.0f, 1.2f, 2.0f), glm::vec3(1.0f, 0.0f, 0.0f))
+    };
+}
+
+glm::vec3 axis_index_color(unsigned int index)
+{
+    switch (index) {
+    case 0:
+        return glm::vec3(1.0f, 0.0f, 0.0f);
+    case 1:
+        return glm::vec3(0.0f, 1.0f, 0.0f);
+    default:
+        return glm::vec3(0.0f, 0.2f, 0.7f);
+    }
+}
+
+// draw the rim and constraint axes the way the arcball helper shows them
+// while hovering, the helpers are in window coordinates around the center
+void draw_helpers(SoftRasterizer & rasterizer, ArcballCore const & core)
+{
+    glm::mat4 transform(1.0f);
+    transform[3] = glm::vec4(core.get_center(), 0.0f, 1.0f);
+
+    std::vector<glm::vec3> positions;
+    auto const & constraint = core.get_constraint();
+    bool rim_overridden = false;
+
+    if (constraint.current != AxisSet::NONE) {
+        for (unsigned int i = 0; i < constraint.available.size(); i++) {
+            const auto axis = constraint.available[i];
+            const float opacity = constraint.nearest == i ? 1.0f : 0.4f;
+
+            positions.clear();
+            if (axis.z == 1.0f) {
+                fill_circle(core.get_radius(), positions);
+                rasterizer.draw_lines(positions, transform, true, axis_index_color(i), opacity);
+                rim_overridden = true;
+            } else {
+                fill_half_arc(core.get_radius(), positions, axis);
+                rasterizer.draw_lines(positions, transform, false, axis_index_color(i), opacity);
+            }
+        }
+    }
+
+    if (!rim_overridden) {
+        positions.clear();
+        fill_circle(core.get_radius(), positions);
+        rasterizer.draw_lines(positions, transform, true, glm::vec3(0.3f), 0.4f);
+    }
+}
+
+bool parse_size(char const * text, unsigned int & width, unsigned int & height)
+{
+    char * end;
+    width = std::strtoul(text, &end, 10);
+    if (*end != 'x') {
+        return false;
+    }
+    height = std::strtoul(end + 1, &end, 10);
+    return *end == '\0' && width > 0 && height > 0;
+}
+
+bool parse_axes(char const * text, ArcballInput & input)
+{
+    input.shift = std::strcmp(text, "camera") == 0 || std::strcmp(text, "world") == 0;
+    input.ctrl = std::strcmp(text, "body") == 0 || std::strcmp(text, "world") == 0;
+    return input.shift || input.ctrl || std::strcmp(text, "none") == 0;
+}
+
+void usage(char const * program)
+{
+    std::cerr << "usage: " << program
+              << " [--size <width>x<height>] [--orientation <w> <x> <y> <z>]"
+              << " [--axes none|camera|body|world] [--threads <count>]"
+              << " <model.obj> <image.png> [<model.obj> <image.png> ...]" << std::endl;
+}
+
+}
+
+// Render every model given as pairs of OBJ and PNG paths the way the demo
+// shows it, without a GPU, and report the render time of each frame. The
+// frame size, model orientation, number of threads and the constraint axes
+// shown by the helpers may be given as options.
+int main(int argc, char * argv[])
+{
+    unsigned int width = 800;
+    unsigned int height = 600;
+    unsigned int threads = 0;
+    glm::quat orientation;
+    ArcballInput input = ArcballInput();
+
+    int i = 1;
+    for (; i < argc && std::strncmp(argv[i], "--", 2) == 0; i++) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (!parse_size(argv[++i], width, height)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--orientation") == 0 && i + 4 < argc) {
+            orientation.w = std::strtof(argv[++i], nullptr);
+            orientation.x = std::strtof(argv[++i], nullptr);
+            orientation.y = std::strtof(argv[++i], nullptr);
+            orientation.z = std::strtof(argv[++i], nullptr);
+            orientation = glm::normalize(orientation);
+        } else if (std::strcmp(argv[i], "--axes") == 0 && i + 1 < argc) {
+            if (!parse_axes(argv[++i], input)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (i == argc || (argc - i) % 2 != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const ArcballCamera eye = create_eye();
+    const glm::mat4 view = view_matrix(eye);
+    const glm::mat4 projection = perspective(width, height);
+    const glm::mat4 model_view = view * glm::mat4_cast(orientation);
+    const RasterMaterial material = create_material();
+    const std::vector<RasterLight> lights = create_lights(view);
+
+    // hover the center of the ball so the constraint axes are shown
+    BallProjector projector;
+    projector.set_eye(view, projection);
+    ArcballCore core(orientation);
+    core.set_allow_constraints(true);
+    core.set_center(projector.project(glm::vec3(0.0f)));
+    input.position = glm::ivec2(width / 2, height / 2);
+    core.update(input, eye, ArcballViewport{ 0, 0, static_cast<int>(width), static_cast<int>(height) });
+
+    SoftRasterizer rasterizer(width, height, threads);
+    std::cout << "threads: " << rasterizer.get_threads() << std::endl;
+
+    MeshData mesh;
+    std::vector<unsigned char> rgb;
+
+    typedef std::chrono::steady_clock clock;
+
+    for (; i < argc; i += 2) {
+        if (!load_obj(argv[i], mesh)) {
+            std::cerr << "unable to read model " << argv[i] << std::endl;
+            return 1;
+        }
+
+        const auto begin = clock::now();
+        rasterizer.clear(glm::vec3(0.0f));
+        rasterizer.draw_mesh(mesh, model_view, projection, material, lights);
+        draw_helpers(rasterizer, core);
+        rasterizer.read_pixels(rgb);
+        const auto end = clock::now();
+
+        if (!write_png(argv[i + 1], width, height, rgb)) {
+            std::cerr << "unable to write image " << argv[i + 1] << std::endl;
+            return 1;
+        }
+
+        std::cout << argv[i + 1] << ": "
+                  << mesh.indices.size() / 3 << " triangles in "
+                  << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(end - begin).count() << " ms"
+                  << std::endl;
+    }
+
+    return 0;
+}